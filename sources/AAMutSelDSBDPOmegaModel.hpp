@@ -67,7 +67,6 @@
 
 class AAMutSelDSBDPOmegaModel : public ProbModel {
     const Tree *tree;
-    FileSequenceAlignment *data;
     const TaxonSet *taxonset;
     const CodonSequenceAlignment *codondata;
 
@@ -167,10 +166,6 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
     // distributions: one at 1 and another one with mean > 1
     int omegaprior;
 
-    Chrono aachrono;
-    Chrono basechrono;
-    Chrono totchrono;
-
     double acca1, acca2, acca3, acca4;
     double tota1, tota2, tota3, tota4;
     double accb1, accb2, accb3, accb4;
@@ -202,8 +197,7 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
         omegamode = inomegamode;
         omegaprior = inomegaprior;
 
-        data = new FileSequenceAlignment(datafile);
-        codondata = new CodonSequenceAlignment(data, true);
+        codondata = new CodonSequenceAlignment(datafile, true);
 
         Nsite = codondata->GetNsite();  // # columns
         Ntaxa = codondata->GetNtaxa();
@@ -604,7 +598,7 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
         ResampleSub(1.0);
     }
 
-    void PostPred(string name) override {
+    void PostPredSimu(SequenceAlignment &simu) override {
         if (blmode == 0) {
             blhypermean->SetAllBranches(1.0 / lambda);
         }
@@ -613,9 +607,20 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
         UpdateBaseOccupancies();
         UpdateOccupancies();
         UpdateMatrices();
-        phyloprocess->PostPredSample(name);
+        phyloprocess->PostPredSample(&simu);
+    }
+
+    //! \brief post pred function (simulates and writes alignment into file)
+    void PostPred(string name) override {
+        SequenceAlignment simu(*codondata);
+        PostPredSimu(simu);
+        ofstream os(name.c_str());
+        simu.ToStream(os);
     }
 
+    //! return the codon alignment
+    const CodonSequenceAlignment *GetCodonData() const override { return codondata; }
+
     //-------------------
     // Priors and likelihood
     //-------------------
@@ -874,8 +879,8 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
 
     //! complete series of MCMC moves on all parameters (repeated nrep times)
     void MoveParameters(int nrep) {
+        PERF_TIMER(ParameterMove);
         for (int rep = 0; rep < nrep; rep++) {
-            totchrono.Start();
             if (blmode < 2) {
                 MoveBranchLengths();
             }
@@ -891,22 +896,17 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
                 MoveOmega();
             }
 
-            aachrono.Start();
             MoveAAMixture(3);
-            aachrono.Stop();
 
-            basechrono.Start();
             if (basemode < 2) {
                 MoveBase(3);
             }
-            basechrono.Stop();
-
-            totchrono.Stop();
         }
     }
 
     //! MH move on base mixture
     void MoveBase(int nrep) {
+        PERF_TIMER(BaseMixtureMove);
         if (baseNcat > 1) {
             ResampleBaseAlloc();
         }
@@ -916,6 +916,7 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
     //! Gibbs resample branch lengths (based on sufficient statistics and current
     //! value of lambda)
     void ResampleBranchLengths() {
+        PERF_TIMER(BranchLengthMove);
         CollectLengthSuffStat();
         branchlength->GibbsResample(*lengthpathsuffstatarray);
     }
@@ -931,6 +932,7 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
     //! MH move on branch lengths hyperparameters (here, scaling move on lambda,
     //! based on suffstats for branch lengths)
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &AAMutSelDSBDPOmegaModel::LambdaHyperLogProb,
@@ -942,6 +944,7 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
 
     //! MH move on omega
     void MoveOmega() {
+        PERF_TIMER(OmegaMove);
         omegapathsuffstat.Clear();
         omegapathsuffstat.AddSuffStat(*componentcodonmatrixarray, *componentpathsuffstatarray);
         if (omegaprior == 0) {
@@ -1069,6 +1072,7 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
 
     //! MH move on nucleotide rate parameters
     void MoveNucRates() {
+        PERF_TIMER(NucRatesMove);
         ProfileMove(nucrelrate, 0.1, 1, 3, &AAMutSelDSBDPOmegaModel::NucRatesLogProb,
                     &AAMutSelDSBDPOmegaModel::UpdateMatrices, this);
         ProfileMove(nucrelrate, 0.03, 3, 3, &AAMutSelDSBDPOmegaModel::NucRatesLogProb,
@@ -1084,6 +1088,7 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
 
     //! MCMC module for the mixture amino-acid fitness profiles
     void MoveAAMixture(int nrep) {
+        PERF_TIMER(FitnessMove);
         for (int rep = 0; rep < nrep; rep++) {
             MoveAAProfiles();
             ResampleEmptyComponents();
@@ -1248,6 +1253,7 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
 
     //! Gibbs resample mixture allocations
     void ResampleAlloc() {
+        PERF_TIMER(AllocMove);
         vector<double> postprob(Ncat, 0);
         for (int i = 0; i < Nsite; i++) {
             GetAllocPostProb(i, postprob);
@@ -1299,6 +1305,7 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
 
     //! MH move on kappa, concentration parameter of the mixture
     void MoveKappa() {
+        PERF_TIMER(HyperMove);
         ScalingMove(kappa, 1.0, 10, &AAMutSelDSBDPOmegaModel::StickBreakingHyperLogProb,
                     &AAMutSelDSBDPOmegaModel::NoUpdate, this);
         ScalingMove(kappa, 0.3, 10, &AAMutSelDSBDPOmegaModel::StickBreakingHyperLogProb,
@@ -1308,6 +1315,7 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
 
     //! MCMC module for the base mixture
     void MoveBaseMixture(int nrep) {
+        PERF_TIMER(BaseMixtureMove);
         for (int rep = 0; rep < nrep; rep++) {
             MoveBaseComponents(10);
             ResampleBaseEmptyComponents();
@@ -1405,6 +1413,7 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
 
     //! Gibbs resample base mixture allocations
     void ResampleBaseAlloc() {
+        PERF_TIMER(AllocMove);
         vector<double> postprob(baseNcat, 0);
         for (int i = 0; i < Ncat; i++) {
             GetBaseAllocPostProb(i, postprob);
@@ -1464,6 +1473,7 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
 
     //! MH move on basekappa, concentration parameter of the base mixture
     void MoveBaseKappa() {
+        PERF_TIMER(HyperMove);
         ScalingMove(basekappa, 1.0, 10, &AAMutSelDSBDPOmegaModel::BaseStickBreakingHyperLogProb,
                     &AAMutSelDSBDPOmegaModel::NoUpdate, this);
         ScalingMove(basekappa, 0.3, 10, &AAMutSelDSBDPOmegaModel::BaseStickBreakingHyperLogProb,
@@ -1584,13 +1594,6 @@ class AAMutSelDSBDPOmegaModel : public ProbModel {
         os << Random::GetEntropy(nucrelrate) << '\n';
     }
 
-    void Monitor(ostream &os) const override {
-        os << totchrono.GetTime() << '\t' << aachrono.GetTime() << '\t' << basechrono.GetTime()
-           << '\n';
-        os << "prop time in aa moves  : " << aachrono.GetTime() / totchrono.GetTime() << '\n';
-        os << "prop time in base moves: " << basechrono.GetTime() / totchrono.GetTime() << '\n';
-    }
-
     void FromStream(istream &is) override {
         if (blmode < 2) {
             is >> lambda;
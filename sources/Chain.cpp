@@ -2,6 +2,7 @@
 #include <fstream>
 #include <iostream>
 #include "Chrono.hpp"
+#include "PerfCounters.hpp"
 #include "ProbModel.hpp"
 using namespace std;
 
@@ -26,6 +27,7 @@ void Chain::MakeFiles(int force) {
     if (saveall) {
         ofstream chain_os((name + ".chain").c_str());
         model->ToStreamHeader(chain_os);
+        ofstream index_os((name + ".chainindex").c_str());
     }
     ofstream mon_os((name + ".monitor").c_str());
     ofstream trace_os((name + ".trace").c_str());
@@ -38,16 +40,26 @@ void Chain::Monitor() {
     ofstream mon_os((name + ".monitor").c_str());
     ofstream mon_det_os((name + ".details").c_str());
     model->Monitor(mon_os);
+#ifdef PERFCOUNT
+    PerfCounters::ToStream(mon_os);
+#endif
 }
 
 void Chain::SavePoint() {
     if (saveall) {
         ofstream chain_os((name + ".chain").c_str(), ios_base::app);
+        chain_os.seekp(0, ios_base::end);
+        AppendChainIndex(chain_os.tellp());
         model->ToStream(chain_os);
     }
     size++;
 }
 
+void Chain::AppendChainIndex(streamoff offset) {
+    ofstream index_os((name + ".chainindex").c_str(), ios_base::app);
+    index_os << offset << '\n';
+}
+
 void Chain::Reset(int force) {
     size = 0;
     MakeFiles(force);
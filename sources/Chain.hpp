@@ -1,6 +1,7 @@
 #ifndef CHAIN_H
 #define CHAIN_H
 
+#include <iostream>
 #include <string>
 #include "ProbModel.hpp"
 
@@ -17,6 +18,8 @@
  * configuration)
  * - <chainname>.chain   : list of all saved points since the beginning of the
  * MCMC (burnin included)
+ * - <chainname>.chainindex : byte offset of each saved point in the .chain
+ * file (one per line), allowing Sample to seek directly to any given point
  * - <chainname>.trace   : trace file, each row corresponding to one point of
  * the points saved during the MCMC
  * - <chainname>.monitor : monitoring the success rate, time spent in each move,
@@ -66,6 +69,10 @@ class Chain {
     //! save one point in the .chain file (called after each cycle)
     virtual void SavePoint();
 
+    //! append the byte offset of the point about to be saved to the .chainindex
+    //! file
+    void AppendChainIndex(std::streamoff offset);
+
     //! write current trace and monitoring statistics in the .trace and .monitor
     //! files (called after each cycle)
     virtual void Monitor();
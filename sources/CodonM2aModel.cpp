@@ -6,7 +6,6 @@
 CodonM2aModel::CodonM2aModel(const CodonSequenceAlignment* incodondata, const Tree* intree, double inpi) {
     blmode = 0;
     nucmode = 0;
-    data = 0;
     codondata = incodondata;
     pi = inpi;
 
@@ -22,13 +21,7 @@ CodonM2aModel::CodonM2aModel(const CodonSequenceAlignment* incodondata, const Tr
 CodonM2aModel::CodonM2aModel(string datapath, string datafile, string treefile, double inpi) {
     blmode = 0;
     nucmode = 0;
-    data = new FileSequenceAlignment(datapath + datafile);
-    if (data->GetNsite() % 3) {
-        cerr << "error : not a correctly formatted codon-alignment: " << datafile << '\n';
-        cerr << "path  : " << datapath << '\n';
-        exit(1);
-    }
-    codondata = new CodonSequenceAlignment(data, true);
+    codondata = new CodonSequenceAlignment(datapath + datafile, true);
     pi = inpi;
 
     Nsite = codondata->GetNsite();  // # columns
@@ -103,14 +96,21 @@ void CodonM2aModel::Update() {
     ResampleSub(1.0);
 }
 
-void CodonM2aModel::PostPred(string name) {
+void CodonM2aModel::PostPredSimu(SequenceAlignment &simu) {
     if (blmode == 0) {
         blhypermean->SetAllBranches(1.0 / lambda);
     }
     componentomegaarray->SetParameters(purom, dposom + 1, purw, posw);
     UpdateMatrices();
     sitealloc->SampleAlloc();
-    phyloprocess->PostPredSample(name + ".ali");
+    phyloprocess->PostPredSample(&simu);
+}
+
+void CodonM2aModel::PostPred(string name) {
+    SequenceAlignment simu(*codondata);
+    PostPredSimu(simu);
+    ofstream aos((name + ".ali").c_str());
+    simu.ToStream(aos);
     ofstream os((name + ".truesiteom").c_str());
     TraceSiteOmega(os);
     ofstream pos((name + ".trueparam").c_str());
@@ -237,15 +237,12 @@ double CodonM2aModel::GetIntegratedLogLikelihood() const {
     int ncat = 3;
 
     double total = 0;
-    double logp[ncat];
+    vector<double> logp(ncat, 0);
     const vector<double> &w = componentomegaarray->GetWeights();
     double max = 0;
     for (int i = 0; i < GetNsite(); i++) {
-        // int bkalloc = sitealloc->GetVal(i);
-
+        phyloprocess->MixtureSiteLogLikelihood(i, *componentcodonmatrixarray, logp);
         for (int k = 0; k < ncat; k++) {
-            (*sitealloc)[i] = k;
-            logp[k] = phyloprocess->SiteLogLikelihood(i);
             if ((!k) || (max < logp[k])) {
                 max = logp[k];
             }
@@ -262,8 +259,6 @@ double CodonM2aModel::GetIntegratedLogLikelihood() const {
         for (int k = 0; k < ncat; k++) {
             sitepostprobarray[i][k] /= p;
         }
-
-        // (*sitealloc)[i] = bkalloc;
     }
 
     sitealloc->GibbsResample(sitepostprobarray);
@@ -415,6 +410,7 @@ double CodonM2aModel::Move() {
 }
 
 void CodonM2aModel::MoveParameters(int nrep) {
+    PERF_TIMER(ParameterMove);
     for (int rep = 0; rep < nrep; rep++) {
         if (!FixedBranchLengths()) {
             MoveBranchLengths();
@@ -448,6 +444,7 @@ void CodonM2aModel::MoveBranchLengths() {
 }
 
 void CodonM2aModel::ResampleBranchLengths() {
+    PERF_TIMER(BranchLengthMove);
     CollectLengthSuffStat();
     branchlength->GibbsResample(*lengthpathsuffstatarray);
 }
@@ -458,6 +455,7 @@ void CodonM2aModel::CollectLengthSuffStat() {
 }
 
 void CodonM2aModel::MoveLambda() {
+    PERF_TIMER(HyperMove);
     hyperlengthsuffstat.Clear();
     hyperlengthsuffstat.AddSuffStat(*branchlength);
     ScalingMove(lambda, 1.0, 10, &CodonM2aModel::LambdaHyperLogProb, &CodonM2aModel::NoUpdate,
@@ -482,6 +480,7 @@ void CodonM2aModel::CollectComponentPathSuffStat() {
 }
 
 void CodonM2aModel::MoveOmega() {
+    PERF_TIMER(OmegaMove);
 
     CollectOmegaPathSuffStat();
 
@@ -512,6 +511,7 @@ void CodonM2aModel::CollectOmegaPathSuffStat() {
 }
 
 void CodonM2aModel::ResampleAlloc() {
+    PERF_TIMER(AllocMove);
     OmegaPathSuffStatLogProb();
     sitealloc->GibbsResample(sitepostprobarray);
 }
@@ -552,6 +552,7 @@ void CodonM2aModel::CollectNucPathSuffStat() {
 }
 
 void CodonM2aModel::MoveNucRates() {
+    PERF_TIMER(NucRatesMove);
     CollectComponentPathSuffStat();
     CollectNucPathSuffStat();
 
@@ -179,8 +179,15 @@ class CodonM2aModel : public ProbModel {
 
     //! \brief post pred function (does the update of all fields before doing the
     //! simulation)
+    void PostPredSimu(SequenceAlignment &simu) override;
+
+    //! \brief post pred function (simulates and writes alignment, true site
+    //! omegas and true parameters into files)
     void PostPred(string name) override;
 
+    //! return the codon alignment
+    const CodonSequenceAlignment *GetCodonData() const override { return codondata; }
+
     //! \brief tell the nucleotide matrix that its parameters have changed and
     //! that it should be updated
     //!
@@ -451,7 +458,6 @@ class CodonM2aModel : public ProbModel {
 
   private:
     const Tree *tree;
-    SequenceAlignment *data;
     const TaxonSet *taxonset;
     const CodonSequenceAlignment *codondata;
 
@@ -7,9 +7,22 @@ using namespace std;
 
 CodonSequenceAlignment::CodonSequenceAlignment(SequenceAlignment *from, bool force_stops,
                                                GeneticCodeType type) {
-    try {
-        DNAsource = from;
+    Translate(from, force_stops, type);
+}
+
+CodonSequenceAlignment::CodonSequenceAlignment(const string &filename, bool force_stops,
+                                               GeneticCodeType type) {
+    FileSequenceAlignment from(filename);
+    if (from.GetNsite() % 3) {
+        cerr << "error : not a correctly formatted codon-alignment: " << filename << '\n';
+        exit(1);
+    }
+    Translate(&from, force_stops, type);
+}
 
+void CodonSequenceAlignment::Translate(const SequenceAlignment *from, bool force_stops,
+                                       GeneticCodeType type) {
+    try {
         if (from->GetNsite() % 3 != 0) {
             cerr << "not multiple of three\n";
             exit(1);
@@ -19,22 +32,25 @@ CodonSequenceAlignment::CodonSequenceAlignment(SequenceAlignment *from, bool for
         auto tempstatespace = new CodonStateSpace(type);
         statespace = tempstatespace;
 
-        taxset = DNAsource->GetTaxonSet();
-        owntaxset = false;
+        // own a copy of the taxon set, so that the nucleotide source
+        // can be released once the codon alignment has been built
+        taxset = new TaxonSet(*from->GetTaxonSet());
+        owntaxset = true;
 
         // make my own arrays
         // make translation
-        Data.assign(Ntaxa, std::vector<int>(Nsite, 0));
+        Allocate();
         for (int i = 0; i < Ntaxa; i++) {
             for (int j = 0; j < Nsite; j++) {
                 try {
-                    Data[i][j] = GetCodonStateSpace()->GetCodonFromDNA(
-                        DNAsource->GetState(i, 3 * j), DNAsource->GetState(i, 3 * j + 1),
-                        DNAsource->GetState(i, 3 * j + 2));
-                    if (Data[i][j] == -1) {
-                        if ((DNAsource->GetState(i, 3 * j) != -1) &&
-                            (DNAsource->GetState(i, 3 * j + 1) != -1) &&
-                            (DNAsource->GetState(i, 3 * j + 2) != -1)) {
+                    SetState(i, j,
+                             GetCodonStateSpace()->GetCodonFromDNA(
+                                 from->GetState(i, 3 * j), from->GetState(i, 3 * j + 1),
+                                 from->GetState(i, 3 * j + 2)));
+                    if (GetState(i, j) == -1) {
+                        if ((from->GetState(i, 3 * j) != -1) &&
+                            (from->GetState(i, 3 * j + 1) != -1) &&
+                            (from->GetState(i, 3 * j + 2) != -1)) {
                             // cerr << "in CodonSequenceAlignment: taxon " <<
                             // taxset->GetTaxon(i) <<
                             // " and codon " << j+1 << " (site " << 3*j+1 << ") :";
@@ -51,7 +67,7 @@ CodonSequenceAlignment::CodonSequenceAlignment(SequenceAlignment *from, bool for
                     // cerr << "taxon : " << taxset->GetTaxon(i) << '\n';
                     if (force_stops) {
                         // Data[i][j] = -2;
-                        Data[i][j] = -1;
+                        SetState(i, j, -1);
                     } else {
                         throw;
                     }
@@ -147,6 +163,7 @@ double CodonSequenceAlignment::GetMeanAADiversity() const   {
 double CodonSequenceAlignment::GetMeanDiff() const   {
 
     double meandiff = 0;
+    int npair = 0;
     for (int j=0; j<Ntaxa; j++) {
         for (int k=j+1; k<Ntaxa; k++)   {
             double tot = 0;
@@ -159,10 +176,15 @@ double CodonSequenceAlignment::GetMeanDiff() const   {
                     }
                 }
             }
-            meandiff += diff/tot;
+            // pairs with no site in common (e.g. taxa absent from the
+            // alignment) are not counted
+            if (tot) {
+                meandiff += diff/tot;
+                npair++;
+            }
         }
     }
-    meandiff /= Ntaxa * (Ntaxa-1) / 2;
+    meandiff /= npair;
     return meandiff;
 }
 
@@ -170,6 +192,7 @@ double CodonSequenceAlignment::GetMeanEmpiricaldNdS() const {
 
     double meandiff = 0;
     double meanndiff = 0;
+    int npair = 0;
     for (int j=0; j<Ntaxa; j++) {
         for (int k=j+1; k<Ntaxa; k++)   {
             double tot = 0;
@@ -186,12 +209,15 @@ double CodonSequenceAlignment::GetMeanEmpiricaldNdS() const {
                     }
                 }
             }
-            meandiff += diff/tot;
-            meanndiff += ndiff/tot;
+            if (tot) {
+                meandiff += diff/tot;
+                meanndiff += ndiff/tot;
+                npair++;
+            }
         }
     }
-    meandiff /= Ntaxa * (Ntaxa-1) / 2;
-    meanndiff /= Ntaxa * (Ntaxa-1) / 2;
+    meandiff /= npair;
+    meanndiff /= npair;
     return meanndiff/meandiff/2.5;
 }
 
@@ -18,10 +18,20 @@ class CodonSequenceAlignment : public SequenceAlignment {
     //! If force_stops is false, returns an error message when encountering stop
     //! codons -- otherwise, replace stop codons by missing entries. If any codon
     //! has any missing entry in the three nucleotide positions, then the whole
-    //! codon is considered missing.
+    //! codon is considered missing. The codon alignment keeps its own copy of
+    //! the taxon set and does not refer to the nucleotide alignment afterwards,
+    //! which can therefore be deleted once the codon alignment is built.
     CodonSequenceAlignment(SequenceAlignment *from, bool force_stops = false,
                            GeneticCodeType type = Universal);
 
+    //! \brief Constructor: reads the nucleotide sequence alignment from a file
+    //!
+    //! Same as above; the nucleotide alignment is released as soon as the codon
+    //! alignment is built. Exits with an error message if the number of
+    //! nucleotide sites is not a multiple of three.
+    CodonSequenceAlignment(const std::string &filename, bool force_stops = false,
+                           GeneticCodeType type = Universal);
+
     ~CodonSequenceAlignment() /*override*/ = default;
 
     //! return the codon state space
@@ -35,8 +45,8 @@ class CodonSequenceAlignment : public SequenceAlignment {
     double GetMeanEmpiricaldNdS() const;
 
   private:
+    void Translate(const SequenceAlignment *from, bool force_stops, GeneticCodeType type);
     void ToStream(std::ostream &os, int pos);
-    SequenceAlignment *DNAsource;
 };
 
 #endif
@@ -113,29 +113,14 @@ class NucPathSuffStat : public SuffStat {
         // void AddSuffStat(const MGOmegaCodonSubMatrixBranchArray& codonmatrixtree,
         // const MGOmegaCodonSubMatrix& rootcodonmatrix, const
         // PathSuffStatNodeArray& codonpathsuffstatnodearray)    {
-        RecursiveAddSuffStat(codonmatrixtree.GetTree().GetRoot(), codonmatrixtree, rootcodonmatrix,
-                             codonpathsuffstatnodearray);
-    }
-
-    void RecursiveAddSuffStat(const Link *from,
-                              const BranchSelector<MGOmegaCodonSubMatrix> &codonmatrixtree,
-                              const MGOmegaCodonSubMatrix &rootcodonmatrix,
-                              const PathSuffStatNodeArray &codonpathsuffstatnodearray) {
-        // void RecursiveAddSuffStat(const Link* from, const
-        // MGOmegaCodonSubMatrixBranchArray& codonmatrixtree, const
-        // MGOmegaCodonSubMatrix& rootcodonmatrix, const PathSuffStatNodeArray&
-        // codonpathsuffstatnodearray)    {
-
-        if (from->isRoot()) {
-            AddSuffStat(rootcodonmatrix,
-                        codonpathsuffstatnodearray.GetVal(from->GetNode()->GetIndex()));
-        } else {
-            AddSuffStat(codonmatrixtree.GetVal(from->GetBranch()->GetIndex()),
-                        codonpathsuffstatnodearray.GetVal(from->GetNode()->GetIndex()));
-        }
-        for (const Link *link = from->Next(); link != from; link = link->Next()) {
-            RecursiveAddSuffStat(link->Out(), codonmatrixtree, rootcodonmatrix,
-                                 codonpathsuffstatnodearray);
+        const Tree &tree = codonmatrixtree.GetTree();
+        for (int node : tree.GetPreorder()) {
+            int branch = tree.GetNodeBranch(node);
+            if (branch == -1) {
+                AddSuffStat(rootcodonmatrix, codonpathsuffstatnodearray.GetVal(node));
+            } else {
+                AddSuffStat(codonmatrixtree.GetVal(branch), codonpathsuffstatnodearray.GetVal(node));
+            }
         }
     }
 
@@ -147,9 +132,9 @@ class NucPathSuffStat : public SuffStat {
         double total = 0;
         // root part
         int nroot = 0;
-        auto rootstat = mat.GetStationary();
+        const EVector &rootstat = mat.GetStationary();
         for (int i = 0; i < Nnuc; i++) {
-            total += rootcount[i] * log(rootstat[i]);
+            total += rootcount[i] * mat.LogStationary(i);
             nroot += rootcount[i];
         }
         total -= nroot / 3 * log(cod.GetNormStat(rootstat));
@@ -158,7 +143,7 @@ class NucPathSuffStat : public SuffStat {
         for (int i = 0; i < Nnuc; i++) {
             for (int j = 0; j < Nnuc; j++) {
                 if (i != j) {
-                    total += paircount[i][j] * log(mat(i, j));
+                    total += paircount[i][j] * mat.LogRate(i, j);
                     total -= pairbeta[i][j] * mat(i, j);
                 }
             }
@@ -372,21 +357,14 @@ class OmegaPathSuffStatArray : public SimpleArray<OmegaPathSuffStat>,
     void AddSuffStat(const Selector<MGOmegaCodonSubMatrix> &codonsubmatrixarray,
                      const NodeSelector<PathSuffStat> &pathsuffstatnodearray,
                      const BranchAllocationSystem &alloc) {
-        RecursiveAddSuffStat(alloc.GetTree().GetRoot(), codonsubmatrixarray, pathsuffstatnodearray,
-                             alloc);
-    }
-
-    void RecursiveAddSuffStat(const Link *from,
-                              const Selector<MGOmegaCodonSubMatrix> &codonsubmatrixarray,
-                              const NodeSelector<PathSuffStat> &pathsuffstatnodearray,
-                              const BranchAllocationSystem &alloc) {
-        if (!from->isRoot()) {
-            int i = alloc.GetBranchAlloc(from->GetBranch()->GetIndex());
-            (*this)[i].AddSuffStat(codonsubmatrixarray.GetVal(i),
-                                   pathsuffstatnodearray.GetVal(from->GetNode()->GetIndex()));
-        }
-        for (const Link *link = from->Next(); link != from; link = link->Next()) {
-            RecursiveAddSuffStat(link->Out(), codonsubmatrixarray, pathsuffstatnodearray, alloc);
+        const Tree &tree = alloc.GetTree();
+        for (int node : tree.GetPreorder()) {
+            int branch = tree.GetNodeBranch(node);
+            if (branch != -1) {
+                int i = alloc.GetBranchAlloc(branch);
+                (*this)[i].AddSuffStat(codonsubmatrixarray.GetVal(i),
+                                       pathsuffstatnodearray.GetVal(node));
+            }
         }
     }
 
@@ -496,22 +474,12 @@ class OmegaPathSuffStatBranchArray : public SimpleBranchArray<OmegaPathSuffStat>
     void AddSuffStat(const BranchSelector<MGOmegaCodonSubMatrix> &codonsubmatrixarray,
                      const MGOmegaCodonSubMatrix &rootcodonsubmatrix,
                      const NodeSelector<PathSuffStat> &pathsuffstatarray) {
-        RecursiveAddSuffStat(GetTree().GetRoot(), codonsubmatrixarray, rootcodonsubmatrix,
-                             pathsuffstatarray);
-    }
-
-    void RecursiveAddSuffStat(const Link *from,
-                              const BranchSelector<MGOmegaCodonSubMatrix> &codonsubmatrixarray,
-                              const MGOmegaCodonSubMatrix &rootcodonsubmatrix,
-                              const NodeSelector<PathSuffStat> &pathsuffstatarray) {
-        if (!from->isRoot()) {
-            (*this)[from->GetBranch()->GetIndex()].AddSuffStat(
-                codonsubmatrixarray.GetVal(from->GetBranch()->GetIndex()),
-                pathsuffstatarray.GetVal(from->GetNode()->GetIndex()));
-        }
-        for (const Link *link = from->Next(); link != from; link = link->Next()) {
-            RecursiveAddSuffStat(link->Out(), codonsubmatrixarray, rootcodonsubmatrix,
-                                 pathsuffstatarray);
+        for (int node : GetTree().GetPreorder()) {
+            int branch = GetTree().GetNodeBranch(node);
+            if (branch != -1) {
+                (*this)[branch].AddSuffStat(codonsubmatrixarray.GetVal(branch),
+                                            pathsuffstatarray.GetVal(node));
+            }
         }
     }
 
@@ -57,7 +57,6 @@ class BranchMixtureSelector : public BranchSelector<T> {
 class ConditionOmegaModel : public ProbModel {
     // tree and data
     Tree *tree;
-    FileSequenceAlignment *data;
     const TaxonSet *taxonset;
     CodonSequenceAlignment *codondata;
 
@@ -147,8 +146,7 @@ class ConditionOmegaModel : public ProbModel {
         blmode = 0;
         nucmode = 0;
 
-        data = new FileSequenceAlignment(datafile);
-        codondata = new CodonSequenceAlignment(data, true);
+        codondata = new CodonSequenceAlignment(datafile, true);
 
         Nsite = codondata->GetNsite();  // # columns
         Ntaxa = codondata->GetNtaxa();
@@ -365,7 +363,7 @@ class ConditionOmegaModel : public ProbModel {
 
     //! \brief post pred function (does the update of all fields before doing the
     //! simulation)
-    void PostPred(string name) override {
+    void PostPredSimu(SequenceAlignment &simu) override {
         if (blmode == 0) {
             blhypermean->SetAllBranches(1.0 / lambda);
         }
@@ -376,9 +374,20 @@ class ConditionOmegaModel : public ProbModel {
         meanomegaarray->SetMulVal(genew);
         condomegaarray->SetInvShape(omegainvshape);
         TouchMatrices();
-        phyloprocess->PostPredSample(name);
+        phyloprocess->PostPredSample(&simu);
     }
 
+    //! \brief post pred function (simulates and writes alignment into file)
+    void PostPred(string name) override {
+        SequenceAlignment simu(*codondata);
+        PostPredSimu(simu);
+        ofstream os(name.c_str());
+        simu.ToStream(os);
+    }
+
+    //! return the codon alignment
+    const CodonSequenceAlignment *GetCodonData() const override { return codondata; }
+
     double GetMeanDeviation() const {
         double total = 0;
         for (int cond=0; cond<Ncond; cond++)    {
@@ -553,6 +562,7 @@ class ConditionOmegaModel : public ProbModel {
 
     //! complete series of MCMC moves on all parameters (repeated nrep times)
     void MoveParameters(int nrep) {
+        PERF_TIMER(ParameterMove);
         for (int rep = 0; rep < nrep; rep++) {
             if (!FixedBranchLengths()) {
                 MoveBranchLengths();
@@ -582,6 +592,7 @@ class ConditionOmegaModel : public ProbModel {
     //! Gibbs resample branch lengths (based on sufficient statistics and current
     //! value of lambda)
     void ResampleBranchLengths() {
+        PERF_TIMER(BranchLengthMove);
         CollectLengthSuffStat();
         branchlength->GibbsResample(*lengthpathsuffstatarray);
     }
@@ -589,6 +600,7 @@ class ConditionOmegaModel : public ProbModel {
     //! MH move on branch lengths hyperparameters (here, scaling move on lambda,
     //! based on suffstats for branch lengths)
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &ConditionOmegaModel::LambdaHyperLogProb, &ConditionOmegaModel::NoUpdate,
@@ -603,6 +615,7 @@ class ConditionOmegaModel : public ProbModel {
     //! MH moves on nucleotide rate parameters (nucrelrate and nucstat: using
     //! ProfileMove)
     void MoveNucRates() {
+        PERF_TIMER(NucRatesMove);
         CollectNucPathSuffStat();
 
         ProfileMove(nucrelrate, 0.1, 1, 3, &ConditionOmegaModel::NucRatesLogProb,
@@ -636,6 +649,7 @@ class ConditionOmegaModel : public ProbModel {
     //! Gibbs resample omega (based on sufficient statistics of current
     //! substitution mapping)
     void ResampleOmega() {
+        PERF_TIMER(OmegaMove);
         condomegaarray->GibbsResample(*omegapathsuffstatarray);
         codonmatrixarray->UpdateCodonMatrices();
     }
@@ -114,7 +114,6 @@ class DiffSelDoublySparseModel : public ProbModel {
     // -----
 
     Tree *tree;
-    FileSequenceAlignment *data;
     const TaxonSet *taxonset;
     CodonSequenceAlignment *codondata;
 
@@ -285,11 +284,8 @@ class DiffSelDoublySparseModel : public ProbModel {
     //! read files (and read out the distribution of conditions across branches,
     //! based on the tree read from treefile)
     void ReadFiles(string datafile, string treefile) {
-        // nucleotide sequence alignment
-        data = new FileSequenceAlignment(datafile);
-
-        // translated into codon sequence alignment
-        codondata = new CodonSequenceAlignment(data, true);
+        // nucleotide sequence alignment, translated into codon sequence alignment
+        codondata = new CodonSequenceAlignment(datafile, true);
 
         Nsite = codondata->GetNsite();  // # columns
         Ntaxa = codondata->GetNtaxa();
@@ -585,16 +581,27 @@ class DiffSelDoublySparseModel : public ProbModel {
         ResampleSub(1.0);
     }
 
-    void PostPred(string name) override {
+    void PostPredSimu(SequenceAlignment &simu) override {
         if (blmode == 0) {
             blhypermean->SetAllBranches(1.0 / lambda);
         }
         UpdateMask();
         fitness->SetShape(fitnessshape);
         UpdateAll();
-        phyloprocess->PostPredSample(name);
+        phyloprocess->PostPredSample(&simu);
+    }
+
+    //! \brief post pred function (simulates and writes alignment into file)
+    void PostPred(string name) override {
+        SequenceAlignment simu(*codondata);
+        PostPredSimu(simu);
+        ofstream os(name.c_str());
+        simu.ToStream(os);
     }
 
+    //! return the codon alignment
+    const CodonSequenceAlignment *GetCodonData() const override { return codondata; }
+
     //! update mask array
     void UpdateMask() { sitemaskarray->SetPi(maskprob); }
 
@@ -839,22 +846,15 @@ class DiffSelDoublySparseModel : public ProbModel {
 
     //! \brief complete MCMC move schedule
     double Move() override {
-        Chrono chrono1;
-        Chrono chrono2;
         gammanullcount = 0;
-        chrono1.Start();
         ResampleSub(1.0);
-        chrono1.Stop();
-        
-        chrono2.Start();
         MoveParameters(3, 9);
-        chrono2.Stop();
-        cerr << chrono1.GetTime() << '\t' << chrono2.GetTime() << '\n';
         return 1.0;
     }
 
     //! complete series of MCMC moves on all parameters (repeated nrep times)
     void MoveParameters(int nrep0, int nrep) {
+        PERF_TIMER(ParameterMove);
         for (int rep0 = 0; rep0 < nrep0; rep0++) {
             if (blmode < 2) {
                 MoveBranchLengths();
@@ -904,6 +904,7 @@ class DiffSelDoublySparseModel : public ProbModel {
     //! Gibbs resampling of branch lengths (based on sufficient statistics and
     //! current value of lambda)
     void ResampleBranchLengths() {
+        PERF_TIMER(BranchLengthMove);
         CollectLengthSuffStat();
         branchlength->GibbsResample(*lengthpathsuffstatarray);
     }
@@ -919,6 +920,7 @@ class DiffSelDoublySparseModel : public ProbModel {
     //! MH move on branch lengths hyperparameters (here, scaling move on lambda,
     //! based on suffstats for branch lengths)
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &DiffSelDoublySparseModel::BranchLengthsHyperLogProb,
@@ -931,6 +933,7 @@ class DiffSelDoublySparseModel : public ProbModel {
     //! MH moves on nucleotide rate parameters (nucrelrate and nucstat: using
     //! ProfileMove)
     void MoveNucRates(int nrep) {
+        PERF_TIMER(NucRatesMove);
         CorruptMatrices();
 
         ProfileMove(nucrelrate, 0.1, 1, nrep, &DiffSelDoublySparseModel::NucRatesLogProb,
@@ -1032,6 +1035,7 @@ class DiffSelDoublySparseModel : public ProbModel {
 
     //! MH move schedule on baseline gamma fitness parameters (for condition k=0)
     void MoveBaselineFitness(int nrep) {
+        PERF_TIMER(FitnessMove);
         // if masks are not activated (all entries equal to 1), move a random subset
         // of entries over the 20 amino-acids (2d parameter of call)
         if (maskmode == 3) {
@@ -1084,6 +1088,7 @@ class DiffSelDoublySparseModel : public ProbModel {
     //! elementary MH move on baseline fitness parameters (for condition k=0):
     //! version used when masks are activated
     double MoveBaselineFitness(double tuning, int nrep) {
+        PERF_TIMER(FitnessMove);
         double nacc = 0;
         double ntot = 0;
         vector<double> bk(Naa, 0);
@@ -1121,6 +1126,7 @@ class DiffSelDoublySparseModel : public ProbModel {
     //! MH move schedule on gamma fitness parameters (fitness shifts) for
     //! non-baseline conditions
     void MoveFitnessShifts(int nrep) {
+        PERF_TIMER(FitnessMove);
         for (int k = 1; k < Ncond; k++) {
             MoveFitnessShifts(k, 1, nrep);
             // MoveFitnessShifts(k, 0.3, nrep);
@@ -1129,6 +1135,7 @@ class DiffSelDoublySparseModel : public ProbModel {
 
     //! elementary MH move on fitness shifts for non-baseline conditions
     double MoveFitnessShifts(int k, double tuning, int nrep) {
+        PERF_TIMER(FitnessMove);
         double nacc = 0;
         double ntot = 0;
         vector<double> bk(Naa, 0);
@@ -1193,6 +1200,7 @@ class DiffSelDoublySparseModel : public ProbModel {
 
     //! MH moves on hyperparameters of distribution of fitness factors
     void MoveFitnessHyperParameters(int nrep) {
+        PERF_TIMER(HyperMove);
         // collect suff stats across all active fitness parameters
         hyperfitnesssuffstat.Clear();
         hyperfitnesssuffstat.AddSuffStat(*fitness, *sitemaskarray, *toggle);
@@ -1219,6 +1227,7 @@ class DiffSelDoublySparseModel : public ProbModel {
 
     //! Move schedule for Gibbs resampling of shifting probabilities
     void ResampleShiftProb() {
+        PERF_TIMER(HyperMove);
         if (! shiftprobinvconc) {
             cerr << "error: in resample shift prob\n";
             exit(1);
@@ -1230,6 +1239,7 @@ class DiffSelDoublySparseModel : public ProbModel {
 
     //! Gibbs resampling of shifting probability under condition k
     void ResampleShiftProb(int k) {
+        PERF_TIMER(HyperMove);
         // pre-calculate parameters of the Beta distribution for non-zero case
         double alpha = shiftprobhypermean[k - 1] / shiftprobhyperinvconc[k - 1];
         double beta = (1 - shiftprobhypermean[k - 1]) / shiftprobhyperinvconc[k - 1];
@@ -1405,6 +1415,7 @@ class DiffSelDoublySparseModel : public ProbModel {
 
     //! MH move schedule on mask hyperparameter (maskprob)
     void MoveMaskHyperParameters(int nrep) {
+        PERF_TIMER(HyperMove);
         /*
         SlidingMove(maskprob, 1.0, nrep, 0.05, 0.975, &DiffSelDoublySparseModel::MaskLogProb,
                     &DiffSelDoublySparseModel::UpdateMask, this);
@@ -1415,6 +1426,7 @@ class DiffSelDoublySparseModel : public ProbModel {
 
     //! MH move schedule on background fitness (maskepsilon)
     void MoveMaskEpsilon(int nrep) {
+        PERF_TIMER(HyperMove);
         SlidingMove(maskepsilon, 1.0, nrep, 0, 1.0, &DiffSelDoublySparseModel::MaskEpsilonLogProb,
                     &DiffSelDoublySparseModel::UpdateAll, this);
         SlidingMove(maskepsilon, 0.1, nrep, 0, 1.0, &DiffSelDoublySparseModel::MaskEpsilonLogProb,
@@ -1427,6 +1439,7 @@ class DiffSelDoublySparseModel : public ProbModel {
 
     //! MH move on fitness masks across sites
     double MoveMasks(int nrep) {
+        PERF_TIMER(FitnessMove);
         double nacc = 0;
         double ntot = 0;
 
@@ -1545,6 +1558,7 @@ class DiffSelDoublySparseModel : public ProbModel {
 
     //! MH move schedule on toggles
     void MoveShiftToggles(int nrep) {
+        PERF_TIMER(FitnessMove);
         for (int k = 1; k < Ncond; k++) {
             MoveShiftToggles(k, nrep);
         }
@@ -1582,6 +1596,7 @@ class DiffSelDoublySparseModel : public ProbModel {
 
     //! elementary MH move on toggles
     double MoveShiftToggles(int k, int nrep) {
+        PERF_TIMER(FitnessMove);
         // to achieve better MCMC mixing, shiftprob[k-1] is integrated out during
         // this MH move on toggles (and Gibbs-resampled upon leaving this MH update)
         // nshift: number of amino-acids that are active in baseline and undergoing
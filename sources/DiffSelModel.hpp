@@ -94,7 +94,6 @@ class DiffSelModel : public ProbModel {
     // -----
 
     Tree *tree;
-    FileSequenceAlignment *data;
     const TaxonSet *taxonset;
     CodonSequenceAlignment *codondata;
 
@@ -231,11 +230,8 @@ class DiffSelModel : public ProbModel {
     //! read files (and read out the distribution of conditions across branches,
     //! based on the tree read from treefile)
     void ReadFiles(string datafile, string treefile) {
-        // nucleotide sequence alignment
-        data = new FileSequenceAlignment(datafile);
-
-        // translated into codon sequence alignment
-        codondata = new CodonSequenceAlignment(data, true);
+        // nucleotide sequence alignment, translated into codon sequence alignment
+        codondata = new CodonSequenceAlignment(datafile, true);
 
         Nsite = codondata->GetNsite();  // # columns
         Ntaxa = codondata->GetNtaxa();
@@ -638,6 +634,7 @@ class DiffSelModel : public ProbModel {
 
     //! complete series of MCMC moves on all parameters (repeated nrep times)
     void MoveParameters(int nrep0, int nrep) {
+        PERF_TIMER(ParameterMove);
         for (int rep0 = 0; rep0 < nrep0; rep0++) {
             if (blmode < 2) {
                 MoveBranchLengths();
@@ -677,6 +674,7 @@ class DiffSelModel : public ProbModel {
     //! Gibbs resample branch lengths (based on sufficient statistics and current
     //! value of lambda)
     void ResampleBranchLengths() {
+        PERF_TIMER(BranchLengthMove);
         CollectLengthSuffStat();
         branchlength->GibbsResample(*lengthpathsuffstatarray);
     }
@@ -684,6 +682,7 @@ class DiffSelModel : public ProbModel {
     //! MH move on branch lengths hyperparameters (here, scaling move on lambda,
     //! based on suffstats for branch lengths)
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &DiffSelModel::BranchLengthsHyperLogProb,
@@ -696,6 +695,7 @@ class DiffSelModel : public ProbModel {
     //! MH moves on nucleotide rate parameters (nucrelrate and nucstat: using
     //! ProfileMove)
     void MoveNucRates() {
+        PERF_TIMER(NucRatesMove);
         CorruptMatrices();
 
         ProfileMove(nucrelrate, 0.1, 1, 10, &DiffSelModel::NucRatesLogProb,
@@ -718,6 +718,7 @@ class DiffSelModel : public ProbModel {
 
     //! MH moves on baseline fitness profiles (G)
     double MoveBaseline(double tuning, int n, int nrep) {
+        PERF_TIMER(FitnessMove);
         double nacc = 0;
         double ntot = 0;
         vector<double> bk(Naa, 0);
@@ -749,6 +750,7 @@ class DiffSelModel : public ProbModel {
 
     //! MH moves on differential fitness effects (D)
     void MoveDelta() {
+        PERF_TIMER(FitnessMove);
         for (int k = 0; k < Ncond - 1; k++) {
             // for (int k = 1; k < Ncond; k++) {
             MoveDelta(k, 5, 1, 10);
@@ -760,6 +762,7 @@ class DiffSelModel : public ProbModel {
 
     //! MH moves on differential fitness effects (D)
     double MoveDelta(int k, double tuning, int n, int nrep) {
+        PERF_TIMER(FitnessMove);
         double nacc = 0;
         double ntot = 0;
         vector<double> bk(Naa, 0);
@@ -786,12 +789,14 @@ class DiffSelModel : public ProbModel {
 
     //! MH moves on variance parameters of differential fitness effects
     void MoveVarSel() {
+        PERF_TIMER(HyperMove);
         MoveVarSel(1.0, 10);
         MoveVarSel(0.3, 10);
     }
 
     //! MH moves on variance parameters of differential fitness effects
     double MoveVarSel(double tuning, int nrep) {
+        PERF_TIMER(HyperMove);
         double nacc = 0;
         double ntot = 0;
         for (int rep = 0; rep < nrep; rep++) {
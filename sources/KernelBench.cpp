@@ -0,0 +1,286 @@
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "AAMutSelDSBDPOmegaModel.hpp"
+#include "Chrono.hpp"
+#include "CodonSequenceAlignment.hpp"
+#include "CodonSubMatrix.hpp"
+#include "GTRSubMatrix.hpp"
+#include "MPIBuffer.hpp"
+#include "PoissonSuffStat.hpp"
+#include "Random.hpp"
+#include "SingleOmegaModel.hpp"
+
+/**
+ * \brief Benchmark of the computational kernels, on the reference datasets
+ *
+ * Times the core operations in isolation:
+ * - diagonalization of GTR (4 states), MG and AAMutSel codon matrices (61
+ * states), including the computation of the generator;
+ * - BackwardPropagate (one branch, MG matrix);
+ * - alignment parsing (nucleotide file and conversion into codons);
+ * - for a SingleOmegaModel: pruning over all sites (GetLogLikelihood, after
+ * touching the matrices, hence with one diagonalization), ResampleSub, path
+ * and branch length suff stat collection, and log prob of the path suff stat;
+ * - for an AAMutSelDSBDPOmegaModel (100 components): GetAllocPostProb, over
+ * all sites;
+ * - packing and unpacking the branch length suff stats into an MPIBuffer;
+ * - chain I/O (ToStream and FromStream of both models).
+ *
+ * Datasets are the fixtures of the data directory: samhd1 (67 taxa, 543
+ * codons), c3c4 (179 taxa, C4Amaranthaceaeshort.ali) and small_multigene (for
+ * alignment parsing only); those that cannot be found are skipped. Each
+ * kernel is called once for warm-up, then repeatedly, doubling the number of
+ * calls, until at least mintime ms have elapsed. The report is in JSON, one
+ * record per kernel and dataset (number of calls, total time in ms, time per
+ * call in microseconds), so that the reports of successive versions can be
+ * compared directly.
+ *
+ * usage: kernelbench [-d <datadir>] [-t <mintime>] [-o <output>]
+ * (by default, datadir is the current directory, mintime is 200 ms, and the
+ * report is written on the standard output; progress is written on the
+ * standard error)
+ */
+
+struct BenchRecord {
+    string kernel;
+    string dataset;
+    long ncall;
+    double time;
+};
+
+static vector<BenchRecord> records;
+static double mintime = 200;
+
+template <class F>
+static void Bench(string kernel, string dataset, F f) {
+    f();
+    Chrono chrono;
+    long ncall = 0;
+    long batch = 1;
+    while (chrono.GetTime() < mintime) {
+        chrono.Start();
+        for (long i = 0; i < batch; i++) {
+            f();
+        }
+        chrono.Stop();
+        ncall += batch;
+        batch *= 2;
+    }
+    records.push_back(BenchRecord{kernel, dataset, ncall, chrono.GetTime()});
+    cerr << kernel << " (" << dataset << "): " << 1000 * chrono.GetTime() / ncall << " us\n";
+}
+
+static void ToJSON(ostream &os) {
+    os << "{\n";
+    os << "  \"program\": \"kernelbench\",\n";
+    os << "  \"mintime_ms\": " << mintime << ",\n";
+    os << "  \"results\": [\n";
+    for (size_t k = 0; k < records.size(); k++) {
+        const BenchRecord &r = records[k];
+        os << "    {\"kernel\": \"" << r.kernel << "\", \"dataset\": \"" << r.dataset
+           << "\", \"ncall\": " << r.ncall << ", \"time_ms\": " << r.time
+           << ", \"us_per_call\": " << 1000 * r.time / r.ncall << "}";
+        os << ((k + 1 < records.size()) ? ",\n" : "\n");
+    }
+    os << "  ]\n";
+    os << "}\n";
+}
+
+static bool Exists(string filename) { return static_cast<bool>(ifstream(filename.c_str())); }
+
+// diagonalization (after corruption of the matrix) and propagation along a
+// branch
+static void BenchMatrices() {
+    CodonStateSpace statespace(Universal);
+    vector<double> rr(Nrr);
+    for (int k = 0; k < Nrr; k++) {
+        rr[k] = Random::sGamma(1.0);
+    }
+    vector<double> stat(Nnuc);
+    for (int k = 0; k < Nnuc; k++) {
+        stat[k] = Random::sGamma(5.0);
+    }
+    vector<double> aa(Naa);
+    for (int k = 0; k < Naa; k++) {
+        aa[k] = Random::sGamma(1.0);
+    }
+    GTRSubMatrix nucmatrix(Nnuc, rr, stat, true);
+    MGOmegaCodonSubMatrix mgmatrix(&statespace, &nucmatrix, 0.3);
+    AAMutSelOmegaCodonSubMatrix aamutselmatrix(&statespace, &nucmatrix, aa, 0.3, 1.0);
+
+    vector<double> p(Nnuc + 1);
+    Bench("diagonalize GTR", "synthetic", [&]() {
+        nucmatrix.CorruptMatrix();
+        nucmatrix.GetFiniteTimeTransitionProb(0, p.data(), 0.1);
+    });
+
+    int N = statespace.GetNstate();
+    p.resize(N + 1);
+    Bench("diagonalize MG", "synthetic", [&]() {
+        nucmatrix.CorruptMatrix();
+        mgmatrix.CorruptMatrix();
+        mgmatrix.GetFiniteTimeTransitionProb(0, p.data(), 0.1);
+    });
+    Bench("diagonalize AAMutSel", "synthetic", [&]() {
+        nucmatrix.CorruptMatrix();
+        aamutselmatrix.CorruptMatrix();
+        aamutselmatrix.GetFiniteTimeTransitionProb(0, p.data(), 0.1);
+    });
+
+    vector<double> up(N + 1), down(N + 1);
+    for (int k = 0; k < N; k++) {
+        up[k] = Random::Uniform();
+    }
+    up[N] = 0;
+    Bench("backward propagate MG", "synthetic",
+          [&]() { mgmatrix.BackwardPropagate(up.data(), down.data(), 0.1); });
+}
+
+static void BenchParsing(string dataset, const vector<string> &files) {
+    Bench("parse alignment", dataset, [&]() {
+        for (const string &file : files) {
+            FileSequenceAlignment data(file);
+            CodonSequenceAlignment codondata(&data, true);
+        }
+    });
+}
+
+static void BenchModels(string dataset, string datafile, string treefile) {
+    SingleOmegaModel model(datafile, treefile);
+    model.Allocate();
+    model.Update();
+
+    Bench("pruning", dataset, [&]() {
+        model.TouchMatrices();
+        model.GetLogLikelihood();
+    });
+    Bench("resample sub", dataset, [&]() { model.ResampleSub(1.0); });
+    Bench("path suffstat", dataset, [&]() { model.CollectPathSuffStat(); });
+    Bench("suffstat log prob", dataset, [&]() { model.PathSuffStatLogProb(); });
+    Bench("length suffstat", dataset, [&]() { model.CollectLengthSuffStat(); });
+
+    const PoissonSuffStatBranchArray &lengthsuffstat = *model.GetLengthPathSuffStatArray();
+    PoissonSuffStatBranchArray lengthsuffstatcopy(lengthsuffstat.GetTree());
+    int size = lengthsuffstat.GetMPISize();
+    Bench("mpibuffer pack and unpack", dataset, [&]() {
+        MPIBuffer buffer(size);
+        buffer << lengthsuffstat;
+        MPIBuffer received(size);
+        copy(buffer.GetBuffer(), buffer.GetBuffer() + size, received.GetBuffer());
+        received >> lengthsuffstatcopy;
+    });
+
+    ostringstream os;
+    model.ToStream(os);
+    string point = os.str();
+    Bench("chain output globom", dataset, [&]() {
+        ostringstream os;
+        model.ToStream(os);
+    });
+    Bench("chain input globom", dataset, [&]() {
+        istringstream is(point);
+        model.FromStream(is);
+    });
+
+    AAMutSelDSBDPOmegaModel mixmodel(datafile, treefile, 3, 0, 100, 1);
+    mixmodel.Allocate();
+    mixmodel.Update();
+    mixmodel.CollectSitePathSuffStat();
+    int nsite = model.GetCodonData()->GetNsite();
+    vector<double> postprob(100);
+    Bench("alloc post prob", dataset, [&]() {
+        for (int i = 0; i < nsite; i++) {
+            mixmodel.GetAllocPostProb(i, postprob);
+        }
+    });
+
+    ostringstream mixos;
+    mixmodel.ToStream(mixos);
+    string mixpoint = mixos.str();
+    Bench("chain output aamutselddp", dataset, [&]() {
+        ostringstream os;
+        mixmodel.ToStream(os);
+    });
+    Bench("chain input aamutselddp", dataset, [&]() {
+        istringstream is(mixpoint);
+        mixmodel.FromStream(is);
+    });
+}
+
+int main(int argc, char *argv[]) {
+    string datadir = ".";
+    string outname = "";
+    try {
+        int i = 1;
+        while (i < argc) {
+            string s = argv[i];
+            if ((s == "-d") && (i + 1 < argc)) {
+                i++;
+                datadir = argv[i];
+            } else if ((s == "-t") && (i + 1 < argc)) {
+                i++;
+                mintime = atof(argv[i]);
+            } else if ((s == "-o") && (i + 1 < argc)) {
+                i++;
+                outname = argv[i];
+            } else {
+                throw(0);
+            }
+            i++;
+        }
+        if (mintime <= 0) {
+            throw(0);
+        }
+    } catch (...) {
+        cerr << "usage: kernelbench [-d <datadir>] [-t <mintime>] [-o <output>]\n";
+        exit(1);
+    }
+    datadir += "/";
+
+    BenchMatrices();
+
+    string samhd1ali = datadir + "samhd1/samhd1.ali";
+    string samhd1tree = datadir + "samhd1/samhd1.tree";
+    string c3c4ali = datadir + "c3c4/C4Amaranthaceaeshort.ali";
+    string c3c4tree = datadir + "c3c4/C4Amaranthaceae.tree";
+    string multigenedir = datadir + "small_multigene/";
+
+    if (Exists(samhd1ali) && Exists(samhd1tree)) {
+        BenchParsing("samhd1", {samhd1ali});
+        BenchModels("samhd1", samhd1ali, samhd1tree);
+    } else {
+        cerr << "warning: samhd1 not found in " << datadir << ", skipped\n";
+    }
+
+    if (Exists(c3c4ali) && Exists(c3c4tree)) {
+        BenchParsing("c3c4", {c3c4ali});
+        BenchModels("c3c4", c3c4ali, c3c4tree);
+    } else {
+        cerr << "warning: c3c4 not found in " << datadir << ", skipped\n";
+    }
+
+    ifstream listis((multigenedir + "small.list").c_str());
+    if (listis) {
+        int ngene;
+        listis >> ngene;
+        vector<string> files(ngene);
+        for (int gene = 0; gene < ngene; gene++) {
+            listis >> files[gene];
+            files[gene] = multigenedir + files[gene];
+        }
+        BenchParsing("small_multigene", files);
+    } else {
+        cerr << "warning: small_multigene not found in " << datadir << ", skipped\n";
+    }
+
+    if (outname == "") {
+        ToJSON(cout);
+    } else {
+        ofstream os(outname.c_str());
+        ToJSON(os);
+        cerr << "report in " << outname << '\n';
+    }
+}
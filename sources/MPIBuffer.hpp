@@ -16,7 +16,7 @@ class MPIBuffer {
     const double *GetBuffer() const { return buffer; }
     double *GetBuffer() { return buffer; }
 
-    unsigned int GetSize() { return size; }
+    unsigned int GetSize() const { return size; }
 
     template <class T>
     void Put(const T &t) {
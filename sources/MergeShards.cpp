@@ -0,0 +1,146 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+/**
+ * \brief Conversion of a sharded gene- or site-specific trace into text
+ *
+ * Multi-gene chains run with -shard write their gene- and site-specific
+ * output (e.g. <chainname>.posw, <chainname>.siteom) as one binary file per
+ * process, <file>.<segment>.shard<proc>, together with an index,
+ * <file>.shardindex (see MultiGeneProbModel::MasterMakeShardedTrace). This
+ * program reads them and writes the text file that the chain would otherwise
+ * have written, one line per point:
+ * - gene-specific traces: one value per gene, in the order of the gene list;
+ * - site-specific traces: for each process, for each of its genes, the gene
+ * name followed by one value per site.
+ *
+ * usage: mergeshards <file> [<output>] (by default, output is <file>)
+ */
+
+static string ShardName(string filename, int segment, int proc) {
+    ostringstream s;
+    s << filename << '.' << segment << ".shard" << proc;
+    return s.str();
+}
+
+int main(int argc, char *argv[]) {
+    if ((argc < 2) || (argc > 3)) {
+        cerr << "usage: mergeshards <file> [<output>]\n";
+        exit(1);
+    }
+    string filename = argv[1];
+    string outname = (argc == 3) ? argv[2] : filename;
+
+    string indexname = filename + ".shardindex";
+    ifstream is(indexname.c_str());
+    if (!is) {
+        cerr << "error: cannot open " << indexname << '\n';
+        exit(1);
+    }
+    string header, level;
+    is >> header >> level;
+    if ((header != "SHARDEDTRACE") || ((level != "gene") && (level != "site"))) {
+        cerr << "error: " << indexname << " is not the index of a sharded trace\n";
+        exit(1);
+    }
+    bool sitelevel = (level == "site");
+
+    ofstream os(outname.c_str());
+    int totnpoint = 0;
+    string tag;
+    while (is >> tag) {
+        int segment, nprocs, ngene;
+        is >> segment >> nprocs >> ngene;
+        if (tag != "segment") {
+            cerr << "error when reading " << indexname << '\n';
+            exit(1);
+        }
+        vector<string> genename(ngene);
+        vector<int> geneproc(ngene), geneoffset(ngene), genecount(ngene);
+        vector<int> recordsize(nprocs, 0);
+        for (int gene = 0; gene < ngene; gene++) {
+            is >> genename[gene] >> geneproc[gene] >> geneoffset[gene] >> genecount[gene];
+            if ((geneproc[gene] <= 0) || (geneproc[gene] >= nprocs)) {
+                cerr << "error when reading " << indexname << ": process " << geneproc[gene]
+                     << " for gene " << genename[gene] << '\n';
+                exit(1);
+            }
+            if (recordsize[geneproc[gene]] < geneoffset[gene] + genecount[gene]) {
+                recordsize[geneproc[gene]] = geneoffset[gene] + genecount[gene];
+            }
+        }
+
+        // number of complete records: the same in all shards, unless the run
+        // was interrupted while points were being written
+        vector<ifstream *> shard(nprocs, (ifstream *)0);
+        int npoint = -1;
+        for (int proc = 1; proc < nprocs; proc++) {
+            if (!recordsize[proc]) {
+                continue;
+            }
+            string shardname = ShardName(filename, segment, proc);
+            shard[proc] = new ifstream(shardname.c_str(), ios_base::in | ios_base::binary);
+            if (!*shard[proc]) {
+                cerr << "error: cannot open " << shardname << '\n';
+                exit(1);
+            }
+            shard[proc]->seekg(0, ios_base::end);
+            int n = shard[proc]->tellg() / (recordsize[proc] * sizeof(double));
+            shard[proc]->seekg(0, ios_base::beg);
+            if ((npoint != -1) && (n != npoint)) {
+                cerr << "warning: segment " << segment
+                     << ": shards have different numbers of points (" << n << " and " << npoint
+                     << "), keeping the smallest\n";
+            }
+            if ((npoint == -1) || (n < npoint)) {
+                npoint = n;
+            }
+        }
+        if (npoint == -1) {
+            npoint = 0;
+        }
+
+        vector<vector<double>> record(nprocs);
+        for (int proc = 1; proc < nprocs; proc++) {
+            record[proc].resize(recordsize[proc]);
+        }
+        for (int point = 0; point < npoint; point++) {
+            for (int proc = 1; proc < nprocs; proc++) {
+                if (shard[proc]) {
+                    shard[proc]->read(reinterpret_cast<char *>(record[proc].data()),
+                                      recordsize[proc] * sizeof(double));
+                }
+            }
+            if (sitelevel) {
+                for (int proc = 1; proc < nprocs; proc++) {
+                    for (int gene = 0; gene < ngene; gene++) {
+                        if (geneproc[gene] == proc) {
+                            os << genename[gene] << '\t';
+                            const double *val = record[proc].data() + geneoffset[gene];
+                            for (int k = 0; k < genecount[gene]; k++) {
+                                os << val[k] << '\t';
+                            }
+                        }
+                    }
+                }
+            } else {
+                for (int gene = 0; gene < ngene; gene++) {
+                    os << record[geneproc[gene]][geneoffset[gene]] << '\t';
+                }
+            }
+            os << '\n';
+        }
+        for (int proc = 1; proc < nprocs; proc++) {
+            delete shard[proc];
+        }
+        cerr << "segment " << segment << ": " << npoint << " points, " << ngene << " genes, "
+             << nprocs - 1 << " shards\n";
+        totnpoint += npoint;
+    }
+    cerr << totnpoint << " points written into " << outname << '\n';
+}
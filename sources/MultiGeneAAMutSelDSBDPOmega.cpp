@@ -89,12 +89,7 @@ class MultiGeneAAMutSelDSBDPOmegaChain : public MultiGeneChain {
         is >> Ncat >> baseNcat;
         is >> blmode >> nucmode >> basemode >> omegamode >> omegaprior >> modalprior;
         is >> pihypermean >> pihyperinvconc;
-        int tmp;
-        is >> tmp;
-        if (tmp) {
-            cerr << "-- Error when reading model\n";
-            exit(1);
-        }
+        int geneformat = MultiGeneMPIModule::ReadParamTrailer(is, {});
         is >> every >> until >> size;
 
         if (modeltype == "MULTIGENEAAMUTSELDSBDPOMEGA") {
@@ -107,7 +102,9 @@ class MultiGeneAAMutSelDSBDPOmegaChain : public MultiGeneChain {
             exit(1);
         }
 
+        GetModel()->SetGeneFormat(geneformat);
         GetModel()->Allocate();
+        GetModel()->SetGeneShardFile(name + ".param", false);
         model->FromStream(is);
         GetModel()->Update();
 
@@ -118,6 +115,7 @@ class MultiGeneAAMutSelDSBDPOmegaChain : public MultiGeneChain {
     }
 
     void Save() override {
+        GetModel()->SetGeneShardFile(name + ".param", false);
         if (!myid) {
             ofstream param_os((name + ".param").c_str());
             param_os << GetModelType() << '\n';
@@ -127,7 +125,7 @@ class MultiGeneAAMutSelDSBDPOmegaChain : public MultiGeneChain {
             param_os << blmode << '\t' << nucmode << '\t' << basemode << '\t' << omegamode << '\t'
                      << omegaprior << '\t' << modalprior << '\n';
             param_os << pihypermean << '\t' << pihyperinvconc << '\n';
-            param_os << 0 << '\n';
+            GetModel()->WriteParamTrailer(param_os, {});
             param_os << every << '\t' << until << '\t' << size << '\n';
             GetModel()->MasterToStream(param_os);
         } else {
@@ -185,15 +183,16 @@ int main(int argc, char *argv[]) {
     int nprocs = 0;
 
     MPI_Init(&argc, &argv);
-    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
-    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+    MultiChainSplit(argc, argv);
+    MPI_Comm_rank(ChainComm, &myid);
+    MPI_Comm_size(ChainComm, &nprocs);
 
     string name = "";
     MultiGeneAAMutSelDSBDPOmegaChain *chain = 0;
 
     // starting a chain from existing files
     if (argc == 2 && argv[1][0] != '-') {
-        name = argv[1];
+        name = MultiChainName(argv[1]);
         chain = new MultiGeneAAMutSelDSBDPOmegaChain(name, myid, nprocs);
     }
 
@@ -234,6 +233,9 @@ int main(int argc, char *argv[]) {
                 } else if ((s == "-t") || (s == "-T")) {
                     i++;
                     treefile = argv[i];
+                } else if (s == "-subsettaxa") {
+                    cerr << "error: -subsettaxa is only available in multigeneglobom\n";
+                    exit(1);
                 } else if (s == "-f") {
                     force = 1;
                 } else if (s == "-g") {
@@ -311,7 +313,7 @@ int main(int argc, char *argv[]) {
                     if (i != (argc - 1)) {
                         throw(0);
                     }
-                    name = argv[i];
+                    name = MultiChainName(argv[i]);
                 }
                 i++;
             }
@@ -321,6 +323,8 @@ int main(int argc, char *argv[]) {
         } catch (...) {
             cerr << "multigeneaamutselddp -d <list> -t <tree> -ncat <ncat> "
                     "<chainname> \n";
+            cerr << "\t-nchain <k>: run k independent chains (<chainname>_0 to <chainname>_<k-1>) "
+                    "in one job, each over np/k processes with its own copy of the data\n";
             cerr << '\n';
             exit(1);
         }
@@ -95,12 +95,6 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
 
     int blmode, nucmode, basemode, omegamode, omegaprior, modalprior;
 
-    Chrono totchrono;
-    Chrono paramchrono;
-    Chrono basechrono;
-    Chrono blchrono;
-    Chrono aachrono;
-
     int burnin;
 
   public:
@@ -298,24 +292,27 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
                         cerr << "error: alignment not allocated\n";
                         exit(1);
                     }
-                    geneprocess[gene] = new AAMutSelDSBDPOmegaModel(
-                        alivector[gene], tree, omegamode, omegaprior, Ncat, baseNcat);
-                }
-            }
-            else    {
-                for (int gene = 0; gene < GetLocalNgene(); gene++) {
-                    geneprocess[gene] = new AAMutSelDSBDPOmegaModel(
-                        GetLocalGeneName(gene), treefile, omegamode, omegaprior, Ncat, baseNcat);
                 }
             }
 
-            for (int gene = 0; gene < GetLocalNgene(); gene++) {
-                geneprocess[gene]->SetBLMode(blmode);
-                geneprocess[gene]->SetNucMode(nucmode);
-                geneprocess[gene]->SetBaseMode(basemode);
-                geneprocess[gene]->Allocate();
-            }
+            SlaveConstructGenes(
+                geneprocess,
+                [&](int gene) {
+                    if (alivector.size()) {
+                        return new AAMutSelDSBDPOmegaModel(alivector[gene], tree, omegamode,
+                                                           omegaprior, Ncat, baseNcat);
+                    }
+                    return new AAMutSelDSBDPOmegaModel(GetLocalGeneName(gene), treefile, omegamode,
+                                                       omegaprior, Ncat, baseNcat);
+                },
+                [&](int gene) {
+                    geneprocess[gene]->SetBLMode(blmode);
+                    geneprocess[gene]->SetNucMode(nucmode);
+                    geneprocess[gene]->SetBaseMode(basemode);
+                    geneprocess[gene]->Allocate();
+                });
         }
+        ReportStartupTime();
     }
 
     void FastUpdate() {
@@ -443,11 +440,7 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
         // SlaveSendLogProbs();
     }
 
-    void GenePostPred(string name) {
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            geneprocess[gene]->PostPred(name + GetLocalGeneName(gene));
-        }
-    }
+    ProbModel *GetLocalGeneModel(int gene) override { return geneprocess[gene]; }
 
     void TracePredictedDNDS(ostream& os) const   {
         for (int gene = 0; gene < Ngene; gene++) {
@@ -590,18 +583,6 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
         os.flush();
     }
 
-    void Monitor(ostream &os) const override {
-        os << totchrono.GetTime() << '\t' << paramchrono.GetTime() << '\t' << basechrono.GetTime()
-           << '\t' << blchrono.GetTime() << '\t' << aachrono.GetTime() << '\n';
-        os << "prop time in param moves: " << paramchrono.GetTime() / totchrono.GetTime() << '\n';
-        os << "sub prop time in base moves : " << basechrono.GetTime() / paramchrono.GetTime()
-           << '\n';
-        os << "sub prop time in bl moves   : " << blchrono.GetTime() / paramchrono.GetTime()
-           << '\n';
-        os << "sub prop time in aa moves   : " << aachrono.GetTime() / paramchrono.GetTime()
-           << '\n';
-    }
-
     void MasterFromStream(istream &is) override {
         if (blmode == 2) {
             is >> lambda;
@@ -639,34 +620,11 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
             baseweight->FromStreamSB(is);
         }
 
-        for (int proc = 1; proc < GetNprocs(); proc++) {
-            int size;
-            is >> size;
-            MPI_Send(&size, 1, MPI_INT, proc, TAG1, MPI_COMM_WORLD);
-            MPIBuffer buffer(size);
-            buffer.FromStream(is);
-            MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD);
-        }
+        MasterGeneStatesFromStream(is);
     }
 
     void SlaveFromStream() override {
-        int checksize = 0;
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            checksize += geneprocess[gene]->GetMPISize();
-        }
-        MPI_Status stat;
-        int size;
-        MPI_Recv(&size, 1, MPI_INT, 0, TAG1, MPI_COMM_WORLD, &stat);
-        if (size != checksize) {
-            cerr << "error in SlaveFromStream: non matching buffer size\n";
-            exit(1);
-        }
-        MPIBuffer buffer(size);
-        MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD, &stat);
-
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            buffer >> *geneprocess[gene];
-        }
+        SlaveGeneStatesFromStream(geneprocess);
     }
 
     void MasterToStream(ostream &os) const override {
@@ -706,31 +664,11 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
             baseweight->ToStreamSB(os);
         }
 
-        for (int proc = 1; proc < GetNprocs(); proc++) {
-            MPI_Status stat;
-            int size;
-            MPI_Recv(&size, 1, MPI_INT, proc, TAG1, MPI_COMM_WORLD, &stat);
-            MPIBuffer buffer(size);
-            MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD,
-                     &stat);
-            os << size << '\t';
-            buffer.ToStream(os);
-        }
-
-        os << '\n';
+        MasterGeneStatesToStream(os);
     }
 
     void SlaveToStream() const override {
-        int size = 0;
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            size += geneprocess[gene]->GetMPISize();
-        }
-        MPIBuffer buffer(size);
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            buffer << *geneprocess[gene];
-        }
-        MPI_Send(&size, 1, MPI_INT, 0, TAG1, MPI_COMM_WORLD);
-        MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD);
+        SlaveGeneStatesToStream(geneprocess);
     }
 
     void PrintBaseMixtureLogo(ostream &os) const {
@@ -959,66 +897,121 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
     // Moves
     //-------------------
 
+    //! \brief whether the last round of the base mixture and the omega, branch
+    //! length and nuc rate (hyper)parameters are exchanged with the slaves at
+    //! each rep (in a single round trip, see MasterMove and SlaveMove)
+    bool HasGlobalExchange() const {
+        return (basemode >= 2) || ((burnin > 10) && (omegamode != 3)) || (blmode != 0) ||
+               ((blmode != 2) && (nucmode == 1));
+    }
+
+    // all messages exchanged within one rep are packed together whenever the
+    // updates they carry do not depend on each other: the first 4 rounds of the
+    // base mixture are sent back and forth one by one; the last round is
+    // combined with omega, branch lengths and nuc rates (these do not depend on
+    // the base mixture), except for nuc rates with global branch lengths
+    // (blmode == 2), as gene nuc rates are then moved given the branch lengths
+    // just resampled by the master
     void MasterMove() override {
-        totchrono.Start();
         int nrep = 30;
 
         for (int rep = 0; rep < nrep; rep++) {
-            paramchrono.Start();
-            aachrono.Start();
-
-            aachrono.Stop();
-
             if (basemode >= 2) {
-                basechrono.Start();
-                for (int r = 0; r < 5; r++) {
+                for (int r = 0; r < 4; r++) {
+                    BeginUnpack();
                     MasterReceiveBaseSuffStat();
+                    EndUnpack();
                     movechrono.Start();
                     MoveBaseMixture(1);
                     movechrono.Stop();
+                    BeginPack();
                     MasterSendBaseMixture();
+                    EndPack();
                 }
-                basechrono.Stop();
+            }
+
+            if (HasGlobalExchange()) {
+                BeginUnpack();
+                if (basemode >= 2) {
+                    MasterReceiveBaseSuffStat();
+                }
+                if ((burnin > 10) && (omegamode != 3)) {
+                    MasterReceiveOmega();
+                }
+                if (blmode == 2) {
+                    MasterReceiveBranchLengthsSuffStat();
+                } else if (blmode == 1) {
+                    MasterReceiveBranchLengthsHyperSuffStat();
+                }
+                if ((blmode != 2) && (nucmode == 1)) {
+                    MasterReceiveNucRatesHyperSuffStat();
+                }
+                EndUnpack();
+            }
+
+            if (basemode >= 2) {
+                movechrono.Start();
+                MoveBaseMixture(1);
+                movechrono.Stop();
             }
 
             if ((burnin > 10) && (omegamode != 3)) {
-                MasterReceiveOmega();
                 movechrono.Start();
                 MoveOmegaHyperParameters();
                 movechrono.Stop();
-                MasterSendOmegaHyperParameters();
             }
 
-            blchrono.Start();
-
             // global branch lengths, or gene branch lengths hyperparameters
             if (blmode == 2) {
-                MasterReceiveBranchLengthsSuffStat();
                 movechrono.Start();
                 ResampleBranchLengths();
                 MoveLambda();
                 movechrono.Stop();
-                MasterSendGlobalBranchLengths();
             } else if (blmode == 1) {
-                MasterReceiveBranchLengthsHyperSuffStat();
                 movechrono.Start();
                 MoveBranchLengthsHyperParameters();
                 movechrono.Stop();
-                MasterSendBranchLengthsHyperParameters();
             }
-            blchrono.Stop();
 
-            if (nucmode == 1) {
+            if ((blmode != 2) && (nucmode == 1)) {
+                movechrono.Start();
+                MoveNucRatesHyperParameters();
+                movechrono.Stop();
+            }
+
+            if (HasGlobalExchange()) {
+                BeginPack();
+                if (basemode >= 2) {
+                    MasterSendBaseMixture();
+                }
+                if ((burnin > 10) && (omegamode != 3)) {
+                    MasterSendOmegaHyperParameters();
+                }
+                if (blmode == 2) {
+                    MasterSendGlobalBranchLengths();
+                } else if (blmode == 1) {
+                    MasterSendBranchLengthsHyperParameters();
+                }
+                if ((blmode != 2) && (nucmode == 1)) {
+                    MasterSendNucRatesHyperParameters();
+                }
+                EndPack();
+            }
+
+            if ((blmode == 2) && (nucmode == 1)) {
+                BeginUnpack();
                 MasterReceiveNucRatesHyperSuffStat();
+                EndUnpack();
                 movechrono.Start();
                 MoveNucRatesHyperParameters();
                 movechrono.Stop();
+                BeginPack();
                 MasterSendNucRatesHyperParameters();
+                EndPack();
             }
-
-            paramchrono.Stop();
         }
 
+        BeginUnpack();
         if (blmode != 2) {
             MasterReceiveGeneBranchLengths();
         }
@@ -1026,8 +1019,7 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
         MasterReceiveOmega();
         MasterReceiveLogProbs();
         MasterReceivePredictedDNDS();
-        
-        totchrono.Stop();
+        EndUnpack();
 
         burnin++;
     }
@@ -1042,20 +1034,33 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
 
         int nrep = 30;
 
+        movechrono.Start();
+        GeneCollectPathSuffStat();
+        movechrono.Stop();
+
         for (int rep = 0; rep < nrep; rep++) {
+            // whether path suff stats for next rep have already been collected
+            bool pathss = (rep == nrep - 1);
+
             movechrono.Start();
-            GeneCollectPathSuffStat();
             MoveGeneAA();
             movechrono.Stop();
 
             if (basemode >= 2) {
-                for (int r = 0; r < 5; r++) {
+                for (int r = 0; r < 4; r++) {
                     movechrono.Start();
                     MoveGeneBase();
                     movechrono.Stop();
+                    BeginPack();
                     SlaveSendBaseSuffStat();
+                    EndPack();
+                    BeginUnpack();
                     SlaveReceiveBaseMixture();
+                    EndUnpack();
                 }
+                movechrono.Start();
+                MoveGeneBase();
+                movechrono.Stop();
             } else {
                 movechrono.Start();
                 for (int r = 0; r < 5; r++) {
@@ -1068,33 +1073,87 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
                 movechrono.Start();
                 MoveGeneOmegas();
                 movechrono.Stop();
-                SlaveSendOmega();
-                SlaveReceiveOmegaHyperParameters();
             }
 
-            // global branch lengths, or gene branch lengths hyperparameters
-            if (blmode == 2) {
-                SlaveSendBranchLengthsSuffStat();
-                SlaveReceiveGlobalBranchLengths();
-            } else {
+            // gene branch lengths and nuc rates
+            if (blmode != 2) {
                 MoveGeneBranchLengths();
-                if (blmode == 1) {
+                MoveGeneNucRates();
+            }
+
+            if (HasGlobalExchange()) {
+                BeginPack();
+                if (basemode >= 2) {
+                    SlaveSendBaseSuffStat();
+                }
+                if ((burnin > 10) && (omegamode != 3)) {
+                    SlaveSendOmega();
+                }
+                if (blmode == 2) {
+                    SlaveSendBranchLengthsSuffStat();
+                } else if (blmode == 1) {
                     SlaveSendBranchLengthsHyperSuffStat();
+                }
+                if ((blmode != 2) && (nucmode == 1)) {
+                    SlaveSendNucRatesHyperSuffStat();
+                }
+                EndPack();
+
+                // path suff stats depend only on the substitution mapping and on
+                // the branch lengths, which are not modified by the reply unless
+                // global: collect those for the next rep while the master moves
+                if ((blmode != 2) && (!pathss)) {
+                    movechrono.Start();
+                    GeneCollectPathSuffStat();
+                    movechrono.Stop();
+                    pathss = true;
+                }
+
+                BeginUnpack();
+                if (basemode >= 2) {
+                    SlaveReceiveBaseMixture();
+                }
+                if ((burnin > 10) && (omegamode != 3)) {
+                    SlaveReceiveOmegaHyperParameters();
+                }
+                if (blmode == 2) {
+                    SlaveReceiveGlobalBranchLengths();
+                } else if (blmode == 1) {
                     SlaveReceiveBranchLengthsHyperParameters();
                 }
+                if ((blmode != 2) && (nucmode == 1)) {
+                    SlaveReceiveNucRatesHyperParameters();
+                }
+                EndUnpack();
             }
 
-            // global nucrates, or gene nucrates hyperparameters
-            MoveGeneNucRates();
-            if (nucmode == 1) {
-                SlaveSendNucRatesHyperSuffStat();
-                SlaveReceiveNucRatesHyperParameters();
+            // gene nuc rates given global branch lengths
+            if (blmode == 2) {
+                MoveGeneNucRates();
+                if (nucmode == 1) {
+                    BeginPack();
+                    SlaveSendNucRatesHyperSuffStat();
+                    EndPack();
+                    if (!pathss) {
+                        movechrono.Start();
+                        GeneCollectPathSuffStat();
+                        movechrono.Stop();
+                        pathss = true;
+                    }
+                    BeginUnpack();
+                    SlaveReceiveNucRatesHyperParameters();
+                    EndUnpack();
+                }
             }
 
-            movechrono.Start();
-            movechrono.Stop();
+            if (!pathss) {
+                movechrono.Start();
+                GeneCollectPathSuffStat();
+                movechrono.Stop();
+            }
         }
 
+        BeginPack();
         if (blmode != 2) {
             SlaveSendGeneBranchLengths();
         }
@@ -1102,6 +1161,7 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
         SlaveSendOmega();
         SlaveSendLogProbs();
         SlaveSendPredictedDNDS();
+        EndPack();
 
         burnin++;
     }
@@ -1158,6 +1218,7 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveBaseMixture(int nrep) {
+        PERF_TIMER(BaseMixtureMove);
         for (int rep = 0; rep < nrep; rep++) {
             MoveBaseComponents(10);
             if (baseNcat > 1) {
@@ -1248,6 +1309,7 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
     void ResampleBaseWeights() { baseweight->GibbsResample(*baseoccupancy); }
 
     void MoveBaseKappa() {
+        PERF_TIMER(HyperMove);
         ScalingMove(basekappa, 1.0, 10,
                     &MultiGeneAAMutSelDSBDPOmegaModel::BaseStickBreakingHyperLogProb,
                     &MultiGeneAAMutSelDSBDPOmegaModel::NoUpdate, this);
@@ -1258,9 +1320,13 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
         baseweight->GibbsResample(*baseoccupancy);
     }
 
-    void ResampleBranchLengths() { branchlength->GibbsResample(*lengthpathsuffstatarray); }
+    void ResampleBranchLengths() {
+        PERF_TIMER(BranchLengthMove);
+        branchlength->GibbsResample(*lengthpathsuffstatarray);
+    }
 
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &MultiGeneAAMutSelDSBDPOmegaModel::LambdaHyperLogProb,
@@ -1271,6 +1337,7 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveBranchLengthsHyperParameters() {
+        PERF_TIMER(HyperMove);
         for (int j = 0; j < Nbranch; j++) {
             BranchLengthsHyperScalingMove(1.0, 10);
             BranchLengthsHyperScalingMove(0.3, 10);
@@ -1317,6 +1384,7 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveNucRatesHyperParameters() {
+        PERF_TIMER(HyperMove);
         ProfileMove(nucrelratehypercenter, 1.0, 1, 10,
                     &MultiGeneAAMutSelDSBDPOmegaModel::NucRatesHyperLogProb,
                     &MultiGeneAAMutSelDSBDPOmegaModel::NoUpdate, this);
@@ -1360,6 +1428,7 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveOmegaHyperParameters() {
+        PERF_TIMER(HyperMove);
         if (omegaprior == 0) {
             omegahypersuffstat.Clear();
             omegahypersuffstat.AddSuffStat(*omegaarray);
@@ -1425,6 +1494,7 @@ class MultiGeneAAMutSelDSBDPOmegaModel : public MultiGeneProbModel {
     }
 
     void ResampleDPosOmPi() {
+        PERF_TIMER(HyperMove);
         int n0 = dposomhypersuffstat.GetN0();
         int n1 = dposomhypersuffstat.GetN1();
         if ((n0 + n1) != Ngene) {
@@ -3,6 +3,7 @@
 #include <iostream>
 #include "Chrono.hpp"
 #include "MultiGeneProbModel.hpp"
+#include "PerfCounters.hpp"
 using namespace std;
 
 // c++11
@@ -13,8 +14,14 @@ MultiGeneChain::MultiGeneChain(int inmyid, int innprocs)
 
 void MultiGeneChain::SavePoint() {
     if (saveall) {
+        // gene states held by slaves go to per-process shards of the .chain file
+        // (see MultiGeneProbModel::SetGeneShardFile), started afresh with the
+        // first point
+        GetMultiGeneModel()->SetGeneShardFile(name + ".chain", size > 0);
         if (!myid) {
             ofstream chain_os((name + ".chain").c_str(), ios_base::app);
+            chain_os.seekp(0, ios_base::end);
+            AppendChainIndex(chain_os.tellp());
             GetMultiGeneModel()->MasterToStream(chain_os);
         } else {
             GetMultiGeneModel()->SlaveToStream();
@@ -44,6 +51,9 @@ void MultiGeneChain::Move() {
     }
     SavePoint();
     Save();
+#ifdef PERFCOUNT
+    PerfCounters::MPIReduce();
+#endif
     if (!myid) {
         Monitor();
     }
@@ -59,12 +69,12 @@ void MultiGeneChain::Start() {
 }
 
 void MultiGeneChain::MasterSendRunningStatus(int status) {
-    MPI_Bcast(&status, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&status, 1, MPI_INT, 0, ChainComm);
 }
 
 int MultiGeneChain::SlaveReceiveRunningStatus() {
     int status;
-    MPI_Bcast(&status, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&status, 1, MPI_INT, 0, ChainComm);
     return status;
 }
 
@@ -11,6 +11,17 @@
  * MultiGeneChain overrides several functions of Chain and defines new methods,
  * implementing part of the behavior of the class relating to the multi-gene and
  * multi-process settings.
+ *
+ * For models whose gene states are held only by slaves, each process writes
+ * the states of its genes into its own files (<chainname>.param.shard<proc> and
+ * <chainname>.chain.shard<proc>), and the .param and .chain files written by
+ * master give the shard and offset of each gene, by name (see
+ * MultiGeneProbModel::SetGeneShardFile). A chain can thus be restarted, or
+ * read, with another number of processes than the one with which it was run.
+ * Chains started with earlier versions, whose .param file does not state the
+ * gene format (see MultiGeneMPIModule::ReadParamTrailer), keep the former per-process blocks and must be restarted, or
+ * read, with the same number of processes (see
+ * MultiGeneMPIModule::SetGeneFormat).
  */
 
 class MultiGeneChain : public Chain {
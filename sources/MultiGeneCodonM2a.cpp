@@ -21,6 +21,8 @@ class MultiGeneCodonM2aChain : public MultiGeneChain {
     // Chain parameters
     string modeltype, datapath, datafile, treefile;
     int writegenedata;
+    // write gene- and site-specific output as per-process binary shards
+    int shardgenedata;
     int blmode, blsamplemode, nucmode, purommode, dposommode, purwmode, poswmode;
     double pihypermean, pihyperinvconc;
     double puromhypermean, puromhyperinvconc;
@@ -43,7 +45,8 @@ class MultiGeneCodonM2aChain : public MultiGeneChain {
     //! \param inuntil: maximum MCMC sample size
     //! \param inwritegenedata: if 1, then trace gene- and condition-specific
     //! shift probabilities in separate files; if 2, then also trace site-specific
-    //! shift probabilities \param name: base name for all files related to this
+    //! shift probabilities \param inshardgenedata: write gene- and site-specific
+    //! output as per-process binary shards (see mergeshards) \param name: base name for all files related to this
     //! MCMC run \param force: overwrite existing files with same name \param
     //! inmyid, int innprocs: process id and total number of MPI processes
     MultiGeneCodonM2aChain(string indatapath, string indatafile, string intreefile, int inblmode, int inblsamplemode, int innucmode,
@@ -53,7 +56,7 @@ class MultiGeneCodonM2aChain : public MultiGeneChain {
                            double indposomhyperinvshape, double inpurwhypermean,
                            double inpurwhyperinvconc, double inposwhypermean,
                            double inposwhyperinvconc, int inmodalprior,
-                           int inevery, int inuntil, int inwritegenedata,
+                           int inevery, int inuntil, int inwritegenedata, int inshardgenedata,
                            string inname, int force, int inmyid, int innprocs)
         : MultiGeneChain(inmyid, innprocs),
           modeltype("MULTIGENECODONM2A"),
@@ -82,6 +85,7 @@ class MultiGeneCodonM2aChain : public MultiGeneChain {
         every = inevery;
         until = inuntil;
         writegenedata = inwritegenedata;
+        shardgenedata = inshardgenedata;
         name = inname;
         New(force);
     }
@@ -139,16 +143,8 @@ class MultiGeneCodonM2aChain : public MultiGeneChain {
 
         // bug: this was not in param file
         purommode = 1;
-        int tmp;
-        is >> tmp;
-        if (tmp) {
-            is >> purommode;
-            is >> tmp;
-            if (tmp)    {
-                cerr << "Error when reading model\n";
-                exit(1);
-            }
-        }
+        shardgenedata = 0;
+        int geneformat = MultiGeneMPIModule::ReadParamTrailer(is, {&purommode, &shardgenedata});
         is >> every >> until >> size;
 
         if (modeltype == "MULTIGENECODONM2A") {
@@ -170,6 +166,7 @@ class MultiGeneCodonM2aChain : public MultiGeneChain {
         if (!myid) {
             cerr << "allocate\n";
         }
+        GetModel()->SetGeneFormat(geneformat);
         GetModel()->Allocate();
 
         if (!myid) {
@@ -202,9 +199,7 @@ class MultiGeneCodonM2aChain : public MultiGeneChain {
             param_os << purwhypermean << '\t' << purwhyperinvconc << '\n';
             param_os << poswhypermean << '\t' << poswhyperinvconc << '\n';
             param_os << modalprior << '\n';
-            param_os << 1 << '\n';
-            param_os << purommode << '\n';
-            param_os << 0 << '\n';
+            GetModel()->WriteParamTrailer(param_os, {purommode, shardgenedata});
             param_os << every << '\t' << until << '\t' << size << '\n';
             GetModel()->MasterToStream(param_os);
         } else {
@@ -215,6 +210,17 @@ class MultiGeneCodonM2aChain : public MultiGeneChain {
     void MakeFiles(int force) override {
         MultiGeneChain::MakeFiles(force);
 
+        if (shardgenedata) {
+            if (writegenedata >= 1) {
+                GetModel()->MasterMakeShardedTrace(name + ".posw", false);
+                GetModel()->MasterMakeShardedTrace(name + ".posom", false);
+            }
+            if (writegenedata == 2) {
+                GetModel()->MasterMakeShardedTrace(name + ".sitepp", true);
+            }
+            return;
+        }
+
         if (writegenedata >= 1) {
             ofstream pos((name + ".posw").c_str());
             ofstream omos((name + ".posom").c_str());
@@ -226,6 +232,26 @@ class MultiGeneCodonM2aChain : public MultiGeneChain {
 
     void SavePoint() override {
         MultiGeneChain::SavePoint();
+        if (shardgenedata) {
+            if (writegenedata >= 1) {
+                if (!myid) {
+                    GetModel()->MasterShardedTrace(name + ".posw", false);
+                    GetModel()->MasterShardedTrace(name + ".posom", false);
+                } else {
+                    GetModel()->SlaveShardPosWeight(name + ".posw");
+                    GetModel()->SlaveShardPosOm(name + ".posom");
+                }
+            }
+            if (writegenedata == 2) {
+                if (!myid) {
+                    GetModel()->MasterShardedTrace(name + ".sitepp", true);
+                } else {
+                    GetModel()->SlaveShardSitesPostProb(name + ".sitepp");
+                }
+            }
+            return;
+        }
+
         if (writegenedata >= 1) {
             if (!myid) {
                 ofstream posw_os((name + ".posw").c_str(), ios_base::app);
@@ -253,8 +279,9 @@ int main(int argc, char *argv[]) {
     int nprocs = 0;
 
     MPI_Init(&argc, &argv);
-    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
-    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+    MultiChainSplit(argc, argv);
+    MPI_Comm_rank(ChainComm, &myid);
+    MPI_Comm_size(ChainComm, &nprocs);
 
     MultiGeneCodonM2aChain *chain = 0;
     string name = "";
@@ -290,9 +317,13 @@ int main(int argc, char *argv[]) {
             cerr << "\t-f: force overwrite of already existing chain\n";
             cerr << "\t-x <every> <until>: saving frequency and stopping time "
                     "(default: every = 1, until = -1)\n";
+            cerr << "\t-nchain <k>: run k independent chains (<chainname>_0 to <chainname>_<k-1>) "
+                    "in one job, each over np/k processes with its own copy of the data\n";
             cerr << "\t-g: without gene-specific output files (.posw and .posom)\n";
             cerr << "\t+g: with gene-specific output files (.posw and .posom)\n";
             cerr << "\t+G: with gene- and site-specific output files\n";
+            cerr << "\t-shard: gene- and site-specific output written by each process into "
+                    "its own binary file (convert into text with mergeshards)\n";
             // cerr << "\tin all cases, complete information about chain state is saved "
             //         "in .chain and .param files\n";
             // cerr << "\t.chain: one line for each cycle\n";
@@ -318,7 +349,7 @@ int main(int argc, char *argv[]) {
 
     // starting a chain from existing files
     if (argc == 2 && argv[1][0] != '-') {
-        name = argv[1];
+        name = MultiChainName(argv[1]);
         chain = new MultiGeneCodonM2aChain(name, myid, nprocs);
     }
 
@@ -355,6 +386,7 @@ int main(int argc, char *argv[]) {
         int blsamplemode = 0;
 
         int writegenedata = 1;
+        int shardgenedata = 0;
 
         int force = 1;
         int every = 1;
@@ -461,6 +493,11 @@ int main(int argc, char *argv[]) {
                     writegenedata = 1;
                 } else if (s == "+G") {
                     writegenedata = 2;
+                } else if (s == "-shard") {
+                    shardgenedata = 1;
+                } else if (s == "-subsettaxa") {
+                    cerr << "error: -subsettaxa is only available in multigeneglobom\n";
+                    exit(1);
                 } else if (s == "-f") {
                     force = 1;
                 } else if ((s == "-x") || (s == "-extract")) {
@@ -474,7 +511,7 @@ int main(int argc, char *argv[]) {
                     if (i != (argc - 1)) {
                         throw(0);
                     }
-                    name = argv[i];
+                    name = MultiChainName(argv[i]);
                 }
                 i++;
             }
@@ -493,7 +530,7 @@ int main(int argc, char *argv[]) {
             datapath, datafile, treefile, blmode, blsamplemode, nucmode, purommode, dposommode, purwmode, poswmode,
             pihypermean, pihyperinvconc, puromhypermean, puromhyperinvconc, dposomhypermean,
             dposomhyperinvshape, purwhypermean, purwhyperinvconc, poswhypermean, poswhyperinvconc, modalprior,
-            every, until, writegenedata, name, force, myid, nprocs);
+            every, until, writegenedata, shardgenedata, name, force, myid, nprocs);
     }
 
     chrono.Stop();
@@ -164,19 +164,23 @@ void MultiGeneCodonM2aModel::Allocate() {
                     cerr << "error: alignment not allocated\n";
                     exit(1);
                 }
-                geneprocess[gene] = new CodonM2aModel(alivector[gene], tree, pi);
             }
         }
-        else    {
-            for (int gene = 0; gene < GetLocalNgene(); gene++) {
-                geneprocess[gene] = new CodonM2aModel(datapath, GetLocalGeneName(gene), treefile, pi);
-            }
-        }
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            geneprocess[gene]->SetAcrossGenesModes(blmode, nucmode);
-            geneprocess[gene]->Allocate();
-        }
+
+        SlaveConstructGenes(
+            geneprocess,
+            [&](int gene) {
+                if (alivector.size()) {
+                    return new CodonM2aModel(alivector[gene], tree, pi);
+                }
+                return new CodonM2aModel(datapath, GetLocalGeneName(gene), treefile, pi);
+            },
+            [&](int gene) {
+                geneprocess[gene]->SetAcrossGenesModes(blmode, nucmode);
+                geneprocess[gene]->Allocate();
+            });
     }
+    ReportStartupTime();
 }
 
 void MultiGeneCodonM2aModel::FastUpdate() {
@@ -288,12 +292,6 @@ void MultiGeneCodonM2aModel::SlavePostPred(string name) {
     // SlaveSendLogProbs();
 }
 
-void MultiGeneCodonM2aModel::GenePostPred(string name) {
-    for (int gene = 0; gene < GetLocalNgene(); gene++) {
-        geneprocess[gene]->PostPred(name + GetLocalGeneName(gene));
-    }
-}
-
 void MultiGeneCodonM2aModel::SetAcrossGenesModes(int inblmode, int innucmode, int inpurommode,
                                                  int indposommode, int inpurwmode, int inposwmode) {
     blmode = inblmode;
@@ -663,59 +661,87 @@ double MultiGeneCodonM2aModel::MixtureHyperLogPrior() const {
 // Moves
 // ------------------
 
+// messages exchanged within one rep are packed together whenever possible
+// (see MultiGeneMPIModule::BeginPack): the suff stats of the mixture
+// hyperparameters and of the gene nuc rate hyperparameters (nucmode == 1) go up
+// together; branch length suff stats depend on the gene omegas redrawn by
+// SetMixtureArrays, and therefore need a second round trip, which also brings
+// back the nuc rate hyperparameters. Global nuc rates (nucmode == 2) depend on
+// branch lengths and are exchanged separately.
+
 void MultiGeneCodonM2aModel::MasterMove() {
     int nrep = 30;
 
     for (int rep = 0; rep < nrep; rep++) {
         // mixture hyperparameters
+        BeginUnpack();
         MasterReceiveMixtureHyperSuffStat();
+        if (nucmode == 1) {
+            MasterReceiveNucRatesHyperSuffStat();
+        }
+        EndUnpack();
         movechrono.Start();
         MoveMixtureHyperParameters();
         movechrono.Stop();
+        BeginPack();
         MasterSendMixtureHyperParameters();
-
-        // global branch lengths, or gene branch lengths hyperparameters
-        if (blmode == 2) {
-            MasterReceiveBranchLengthsSuffStat();
+        if ((!blmode) && (nucmode == 1)) {
             movechrono.Start();
-            ResampleBranchLengths();
-            MoveLambda();
+            MoveNucRatesHyperParameters();
             movechrono.Stop();
-            MasterSendGlobalBranchLengths();
-        } else if (blmode == 1) {
-            if (blsamplemode == 1)   {
+            MasterSendNucRatesHyperParameters();
+        }
+        EndPack();
+
+        // global branch lengths, or gene branch lengths hyperparameters
+        if (blmode) {
+            BeginUnpack();
+            if (blmode == 2) {
+                MasterReceiveBranchLengthsSuffStat();
+            } else if (blsamplemode == 1) {
                 MasterReceiveGeneBranchLengthsSuffStat();
-                movechrono.Start();
-                MoveBranchLengthsHyperParametersIntegrated();
-                movechrono.Stop();
-                MasterSendBranchLengthsHyperParameters();
-                // MasterReceiveGeneBranchLengths();
-            }
-            else    {
+            } else {
                 MasterReceiveBranchLengthsHyperSuffStat();
-                movechrono.Start();
+            }
+            EndUnpack();
+
+            movechrono.Start();
+            if (blmode == 2) {
+                ResampleBranchLengths();
+                MoveLambda();
+            } else if (blsamplemode == 1) {
+                MoveBranchLengthsHyperParametersIntegrated();
+            } else {
                 MoveBranchLengthsHyperParameters();
-                movechrono.Stop();
+            }
+            if (nucmode == 1) {
+                MoveNucRatesHyperParameters();
+            }
+            movechrono.Stop();
+
+            BeginPack();
+            if (blmode == 2) {
+                MasterSendGlobalBranchLengths();
+            } else {
                 MasterSendBranchLengthsHyperParameters();
             }
+            if (nucmode == 1) {
+                MasterSendNucRatesHyperParameters();
+            }
+            EndPack();
         }
 
-        // global nucrates, or gene nucrates hyperparameters
+        // global nucrates
         if (nucmode == 2) {
             MasterReceiveNucPathSuffStat();
             movechrono.Start();
             MoveNucRates();
             movechrono.Stop();
             MasterSendGlobalNucRates();
-        } else if (nucmode == 1) {
-            MasterReceiveNucRatesHyperSuffStat();
-            movechrono.Start();
-            MoveNucRatesHyperParameters();
-            movechrono.Stop();
-            MasterSendNucRatesHyperParameters();
         }
     }
     burnin++;
+    BeginUnpack();
     if (blmode != 2) {
         MasterReceiveGeneBranchLengths();
     }
@@ -724,6 +750,7 @@ void MultiGeneCodonM2aModel::MasterMove() {
     }
     MasterReceiveMixture();
     MasterReceiveLogProbs();
+    EndUnpack();
 }
 
 // slave move
@@ -744,41 +771,64 @@ void MultiGeneCodonM2aModel::SlaveMove() {
         movechrono.Stop();
 
         // mixture hyperparameters
+        BeginPack();
         SlaveSendMixtureHyperSuffStat();
+        if (nucmode == 1) {
+            SlaveSendNucRatesHyperSuffStat();
+        }
+        EndPack();
+        BeginUnpack();
         SlaveReceiveMixtureHyperParameters();
+        if ((!blmode) && (nucmode == 1)) {
+            SlaveReceiveNucRatesHyperParameters();
+        }
+        EndUnpack();
         SetMixtureArrays();
 
         // global branch lengths, or gene branch lengths hyperparameters
-        if (blmode == 2) {
-            SlaveSendBranchLengthsSuffStat();
-            SlaveReceiveGlobalBranchLengths();
-        } else if (blmode == 1) {
-            if (blsamplemode == 1)   {
+        if (blmode) {
+            BeginPack();
+            if (blmode == 2) {
+                SlaveSendBranchLengthsSuffStat();
+            } else if (blsamplemode == 1) {
                 // integrated move
                 SlaveSendGeneBranchLengthsSuffStat();
-                SlaveReceiveBranchLengthsHyperParameters();
-                ResampleGeneBranchLengths();
-            }
-            else    {
+            } else {
                 // conditional move
                 SlaveSendBranchLengthsHyperSuffStat();
+            }
+            EndPack();
+
+            BeginUnpack();
+            if (blmode == 2) {
+                SlaveReceiveGlobalBranchLengths();
+            } else {
                 SlaveReceiveBranchLengthsHyperParameters();
-                GeneResampleEmptyBranches();
+            }
+            if (nucmode == 1) {
+                SlaveReceiveNucRatesHyperParameters();
+            }
+            EndUnpack();
+
+            if (blmode == 1) {
+                if (blsamplemode == 1) {
+                    ResampleGeneBranchLengths();
+                } else {
+                    GeneResampleEmptyBranches();
+                }
             }
         }
 
-        // global nucrates, or gene nucrates hyperparameters
+        // global nucrates
         if (nucmode == 2) {
             SlaveSendNucPathSuffStat();
             SlaveReceiveGlobalNucRates();
-        } else if (nucmode == 1) {
-            SlaveSendNucRatesHyperSuffStat();
-            SlaveReceiveNucRatesHyperParameters();
         }
     }
     burnin++;
 
     // collect current state
+    BeginPack();
     if (blmode != 2) {
         SlaveSendGeneBranchLengths();
     }
@@ -787,6 +837,7 @@ void MultiGeneCodonM2aModel::SlaveMove() {
     }
     SlaveSendMixture();
     SlaveSendLogProbs();
+    EndPack();
 }
 
 void MultiGeneCodonM2aModel::GeneResampleSub(double frac) {
@@ -796,6 +847,7 @@ void MultiGeneCodonM2aModel::GeneResampleSub(double frac) {
 }
 
 void MultiGeneCodonM2aModel::MoveGeneParameters(int nrep) {
+    PERF_TIMER(ParameterMove);
     for (int gene = 0; gene < GetLocalNgene(); gene++) {
         geneprocess[gene]->MoveParameters(nrep);
         geneprocess[gene]->GetMixtureParameters((*puromarray)[gene], (*dposomarray)[gene],
@@ -810,10 +862,12 @@ void MultiGeneCodonM2aModel::MoveGeneParameters(int nrep) {
 }
 
 void MultiGeneCodonM2aModel::ResampleBranchLengths() {
+    PERF_TIMER(BranchLengthMove);
     branchlength->GibbsResample(*lengthpathsuffstatarray);
 }
 
 void MultiGeneCodonM2aModel::ResampleGeneBranchLengths()   {
+    PERF_TIMER(BranchLengthMove);
     for (int gene = 0; gene < GetLocalNgene(); gene++) {
         geneprocess[gene]->ResampleBranchLengths();
         geneprocess[gene]->GetBranchLengths((*branchlengtharray)[gene]);
@@ -821,6 +875,7 @@ void MultiGeneCodonM2aModel::ResampleGeneBranchLengths()   {
 }
 
 void MultiGeneCodonM2aModel::MoveLambda() {
+    PERF_TIMER(HyperMove);
     hyperlengthsuffstat.Clear();
     hyperlengthsuffstat.AddSuffStat(*branchlength);
     ScalingMove(lambda, 1.0, 10, &MultiGeneCodonM2aModel::LambdaHyperLogProb,
@@ -831,6 +886,7 @@ void MultiGeneCodonM2aModel::MoveLambda() {
 }
 
 void MultiGeneCodonM2aModel::MoveBranchLengthsHyperParametersIntegrated() {
+    PERF_TIMER(HyperMove);
 
     BranchLengthsHyperScalingMoveIntegrated(1.0, 10);
     BranchLengthsHyperScalingMoveIntegrated(0.3, 10);
@@ -905,6 +961,7 @@ double MultiGeneCodonM2aModel::BranchLengthsHyperScalingMoveIntegrated(double tu
 }
 
 void MultiGeneCodonM2aModel::MoveBranchLengthsHyperParameters() {
+    PERF_TIMER(HyperMove);
 
     BranchLengthsHyperScalingMove(1.0, 10);
     BranchLengthsHyperScalingMove(0.3, 10);
@@ -948,6 +1005,7 @@ double MultiGeneCodonM2aModel::BranchLengthsHyperScalingMove(double tuning, int
 }
 
 void MultiGeneCodonM2aModel::MoveNucRatesHyperParameters() {
+    PERF_TIMER(HyperMove);
     ProfileMove(nucrelratehypercenter, 1.0, 1, 10, &MultiGeneCodonM2aModel::NucRatesHyperLogProb,
                 &MultiGeneCodonM2aModel::NoUpdate, this);
     ProfileMove(nucrelratehypercenter, 0.3, 1, 10, &MultiGeneCodonM2aModel::NucRatesHyperLogProb,
@@ -979,6 +1037,7 @@ void MultiGeneCodonM2aModel::MoveNucRatesHyperParameters() {
 }
 
 void MultiGeneCodonM2aModel::MoveNucRates() {
+    PERF_TIMER(NucRatesMove);
     vector<double> &nucrelrate = (*nucrelratearray)[0];
     ProfileMove(nucrelrate, 0.1, 1, 10, &MultiGeneCodonM2aModel::NucRatesLogProb,
                 &MultiGeneCodonM2aModel::UpdateNucMatrix, this);
@@ -995,6 +1054,7 @@ void MultiGeneCodonM2aModel::MoveNucRates() {
 }
 
 void MultiGeneCodonM2aModel::MoveMixtureHyperParameters() {
+    PERF_TIMER(HyperMove);
     if (purommode == 1) {
         SlidingMove(puromhypermean, 1.0, 10, 0, 1, &MultiGeneCodonM2aModel::MixtureHyperLogProb,
                     &MultiGeneCodonM2aModel::NoUpdate, this);
@@ -1040,6 +1100,7 @@ void MultiGeneCodonM2aModel::MoveMixtureHyperParameters() {
 }
 
 void MultiGeneCodonM2aModel::MovePoswHyper()	{
+    PERF_TIMER(HyperMove);
 
         SlidingMove(poswhypermean, 1.0, 10, 0, 1, &MultiGeneCodonM2aModel::MixtureHyperLogProb,
                     &MultiGeneCodonM2aModel::NoUpdate, this);
@@ -1086,6 +1147,7 @@ int MultiGeneCodonM2aModel::PoswCompMove(double tuning)	{
 
 
 void MultiGeneCodonM2aModel::ResamplePi() {
+    PERF_TIMER(HyperMove);
     int n0 = poswsuffstat.GetN0();
     int n1 = poswsuffstat.GetN1();
     if ((n0 + n1) != Ngene) {
@@ -1395,7 +1457,7 @@ void MultiGeneCodonM2aModel::MasterTraceSitesPostProb(ostream &os) {
         int totnsite = GetSlaveTotNsite(proc);
         double *array = new double[totnsite];
         MPI_Status stat;
-        MPI_Recv(array, totnsite, MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD, &stat);
+        MPI_Recv(array, totnsite, MPI_DOUBLE, proc, TAG1, ChainComm, &stat);
 
         int i = 0;
         for (int gene = 0; gene < Ngene; gene++) {
@@ -1427,9 +1489,15 @@ void MultiGeneCodonM2aModel::MasterTraceSitesPostProb(ostream &os) {
 }
 
 void MultiGeneCodonM2aModel::SlaveTraceSitesPostProb() {
+    double *array = new double[GetLocalTotNsite()];
+    GetLocalSitesPostProb(array);
+    MPI_Send(array, GetLocalTotNsite(), MPI_DOUBLE, 0, TAG1, ChainComm);
+    delete[] array;
+}
+
+void MultiGeneCodonM2aModel::GetLocalSitesPostProb(double *array) const {
     int ngene = GetLocalNgene();
     int totnsite = GetLocalTotNsite();
-    double *array = new double[totnsite];
     int i = 0;
     for (int gene = 0; gene < ngene; gene++) {
         geneprocess[gene]->GetSitesPostProb(array + i);
@@ -1444,11 +1512,30 @@ void MultiGeneCodonM2aModel::SlaveTraceSitesPostProb() {
         i += GetLocalGeneNsite(gene);
     }
     if (i != totnsite) {
-        cerr << "error in MultiGeneCodonM2aModel::SlaveTraceSitesPostProb: non "
+        cerr << "error in MultiGeneCodonM2aModel::GetLocalSitesPostProb: non "
                 "matching number of sites\n";
         exit(1);
     }
+}
+
+void MultiGeneCodonM2aModel::SlaveShardPosWeight(string filename) {
+    std::vector<double> values(GetLocalNgene());
+    for (int gene = 0; gene < GetLocalNgene(); gene++) {
+        values[gene] = poswarray->GetVal(gene);
+    }
+    SlaveShardedTrace(filename, false, values);
+}
 
-    MPI_Send(array, totnsite, MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD);
-    delete[] array;
+void MultiGeneCodonM2aModel::SlaveShardPosOm(string filename) {
+    std::vector<double> values(GetLocalNgene());
+    for (int gene = 0; gene < GetLocalNgene(); gene++) {
+        values[gene] = poswarray->GetVal(gene) ? 1 + dposomarray->GetVal(gene) : 1.0;
+    }
+    SlaveShardedTrace(filename, false, values);
+}
+
+void MultiGeneCodonM2aModel::SlaveShardSitesPostProb(string filename) {
+    std::vector<double> values(GetLocalTotNsite());
+    GetLocalSitesPostProb(values.data());
+    SlaveShardedTrace(filename, true, values);
 }
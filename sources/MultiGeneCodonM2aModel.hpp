@@ -107,7 +107,7 @@ class MultiGeneCodonM2aModel : public MultiGeneProbModel {
 
     void MasterPostPred(string name) override;
     void SlavePostPred(string name) override;
-    void GenePostPred(string name);
+    ProbModel *GetLocalGeneModel(int gene) override { return geneprocess[gene]; }
 
     //-------------------
     // Traces and Monitors
@@ -122,6 +122,15 @@ class MultiGeneCodonM2aModel : public MultiGeneProbModel {
     void MasterTraceSitesPostProb(ostream &os);
     void SlaveTraceSitesPostProb();
 
+    // sharded versions of the three traces above, slave side (see
+    // MultiGeneProbModel::MasterMakeShardedTrace)
+    void SlaveShardPosWeight(string filename);
+    void SlaveShardPosOm(string filename);
+    void SlaveShardSitesPostProb(string filename);
+
+    //! site post probs of all local genes, concatenated (slave side)
+    void GetLocalSitesPostProb(double *array) const;
+
     void Monitor(ostream &os) const override {}
     void MasterFromStream(istream &is) override;
     void MasterToStream(ostream &os) const override;
@@ -260,13 +260,17 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
         } else {
             geneprocess.assign(GetLocalNgene(), (ConditionOmegaModel *)0);
 
-            for (int gene = 0; gene < GetLocalNgene(); gene++) {
-                geneprocess[gene] =
-                    new ConditionOmegaModel(GetLocalGeneName(gene), treefile, Ncond, Nlevel);
-                geneprocess[gene]->SetAcrossGenesModes(blmode, nucmode);
-                geneprocess[gene]->Allocate();
-            }
+            SlaveConstructGenes(
+                geneprocess,
+                [&](int gene) {
+                    return new ConditionOmegaModel(GetLocalGeneName(gene), treefile, Ncond, Nlevel);
+                },
+                [&](int gene) {
+                    geneprocess[gene]->SetAcrossGenesModes(blmode, nucmode);
+                    geneprocess[gene]->Allocate();
+                });
         }
+        ReportStartupTime();
     }
 
     // called upon constructing the model
@@ -661,11 +665,7 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
         GenePostPred(name);
     }
 
-    void GenePostPred(string name) {
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            geneprocess[gene]->PostPred(name + GetLocalGeneName(gene));
-        }
-    }
+    ProbModel *GetLocalGeneModel(int gene) override { return geneprocess[gene]; }
 
     void TouchNucMatrix() {
         nucmatrix->CopyStationary((*nucstatarray)[0]);
@@ -905,6 +905,11 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
     // all methods starting with Gene are called only be slaves, and do some work
     // across all genes allocated to that slave
 
+    // gene branch lengths (blmode != 2) do not depend on the hyperparameters
+    // sent back by the master within the same rep: gene branch lengths and nuc
+    // rates are then both moved before a single exchange of their suff stats
+    // and hyperparameters (see MultiGeneMPIModule::BeginPack)
+
     void MasterMove() override {
         int nrep = 30;
 
@@ -913,31 +918,52 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
             MoveOmegaHyperParameters(3);
             MasterSendOmegaHyperParameters();
 
-            // global branch lengths, or gene branch lengths hyperparameters
+            // global branch lengths
             if (blmode == 2) {
                 MasterReceiveBranchLengthsSuffStat();
                 ResampleBranchLengths();
                 MoveLambda();
                 MasterSendGlobalBranchLengths();
-            } else if (blmode == 1) {
-                MasterReceiveBranchLengthsHyperSuffStat();
-                MoveBranchLengthsHyperParameters();
-                MasterSendBranchLengthsHyperParameters();
             }
 
-            // global nucrates, or gene nucrates hyperparameters
-            if (nucmode == 2) {
-                MasterReceiveNucPathSuffStat();
-                MoveNucRates();
-                MasterSendGlobalNucRates();
-            } else if (nucmode == 1) {
-                MasterReceiveNucRatesHyperSuffStat();
-                MoveNucRatesHyperParameters();
-                MasterSendNucRatesHyperParameters();
+            // gene branch lengths hyperparameters, and global nucrates or gene
+            // nucrates hyperparameters
+            if ((blmode == 1) || nucmode) {
+                BeginUnpack();
+                if (blmode == 1) {
+                    MasterReceiveBranchLengthsHyperSuffStat();
+                }
+                if (nucmode == 2) {
+                    MasterReceiveNucPathSuffStat();
+                } else if (nucmode == 1) {
+                    MasterReceiveNucRatesHyperSuffStat();
+                }
+                EndUnpack();
+
+                if (blmode == 1) {
+                    MoveBranchLengthsHyperParameters();
+                }
+                if (nucmode == 2) {
+                    MoveNucRates();
+                } else if (nucmode == 1) {
+                    MoveNucRatesHyperParameters();
+                }
+
+                BeginPack();
+                if (blmode == 1) {
+                    MasterSendBranchLengthsHyperParameters();
+                }
+                if (nucmode == 2) {
+                    MasterSendGlobalNucRates();
+                } else if (nucmode == 1) {
+                    MasterSendNucRatesHyperParameters();
+                }
+                EndPack();
             }
         }
 
         // collect current state
+        BeginUnpack();
         if (blmode != 2) {
             MasterReceiveGeneBranchLengths();
         }
@@ -946,6 +972,7 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
         }
         MasterReceiveOmega();
         MasterReceiveLogProbs();
+        EndUnpack();
     }
 
     // slave move
@@ -954,35 +981,68 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
 
         int nrep = 30;
 
+        GeneCollectPathSuffStat();
+
         for (int rep = 0; rep < nrep; rep++) {
+            // whether path suff stats for next rep have already been collected
+            bool pathss = (rep == nrep - 1);
 
-            GeneCollectPathSuffStat();
             SlaveSendOmegaSuffStat();
             SlaveReceiveOmegaHyperParameters();
             GeneResampleOmega();
 
-            // global branch lengths, or gene branch lengths hyperparameters
+            // global branch lengths, or gene branch lengths
             if (blmode == 2) {
                 SlaveSendBranchLengthsSuffStat();
                 SlaveReceiveGlobalBranchLengths();
             } else if (blmode == 1) {
                 MoveGeneBranchLengths();
-                SlaveSendBranchLengthsHyperSuffStat();
-                SlaveReceiveBranchLengthsHyperParameters();
             }
 
-            // global nucrates, or gene nucrates hyperparameters
-            if (nucmode == 2) {
-                SlaveSendNucPathSuffStat();
-                SlaveReceiveGlobalNucRates();
-            } else if (nucmode == 1) {
+            if (nucmode == 1) {
                 MoveGeneNucRates();
-                SlaveSendNucRatesHyperSuffStat();
-                SlaveReceiveNucRatesHyperParameters();
+            }
+
+            // gene branch lengths hyperparameters, and global nucrates or gene
+            // nucrates hyperparameters
+            if ((blmode == 1) || nucmode) {
+                BeginPack();
+                if (blmode == 1) {
+                    SlaveSendBranchLengthsHyperSuffStat();
+                }
+                if (nucmode == 2) {
+                    SlaveSendNucPathSuffStat();
+                } else if (nucmode == 1) {
+                    SlaveSendNucRatesHyperSuffStat();
+                }
+                EndPack();
+
+                // branch lengths are not modified by the reply: collect path
+                // suff stats for the next rep while the master moves
+                if (!pathss) {
+                    GeneCollectPathSuffStat();
+                    pathss = true;
+                }
+
+                BeginUnpack();
+                if (blmode == 1) {
+                    SlaveReceiveBranchLengthsHyperParameters();
+                }
+                if (nucmode == 2) {
+                    SlaveReceiveGlobalNucRates();
+                } else if (nucmode == 1) {
+                    SlaveReceiveNucRatesHyperParameters();
+                }
+                EndUnpack();
+            }
+
+            if (!pathss) {
+                GeneCollectPathSuffStat();
             }
         }
 
         // collect current state
+        BeginPack();
         if (blmode != 2) {
             SlaveSendGeneBranchLengths();
         }
@@ -992,6 +1052,7 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
 
         SlaveSendOmega();
         SlaveSendLogProbs();
+        EndPack();
     }
 
     void GeneResampleSub(double frac) {
@@ -1029,10 +1090,12 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
     // Branch lengths
 
     void ResampleBranchLengths() {
+        PERF_TIMER(BranchLengthMove);
         branchlength->GibbsResample(*lengthpathsuffstatarray);
     }
 
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &MultiGeneConditionOmegaModel::LambdaHyperLogProb,
@@ -1043,6 +1106,7 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveBranchLengthsHyperParameters() {
+        PERF_TIMER(HyperMove);
 
         BranchLengthsHyperScalingMove(1.0, 10);
         BranchLengthsHyperScalingMove(0.3, 10);
@@ -1088,6 +1152,7 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
     // Nucleotide rates
 
     void MoveNucRatesHyperParameters() {
+        PERF_TIMER(HyperMove);
         ProfileMove(nucrelratehypercenter, 1.0, 1, 10, &MultiGeneConditionOmegaModel::NucRatesHyperLogProb,
                     &MultiGeneConditionOmegaModel::NoUpdate, this);
         ProfileMove(nucrelratehypercenter, 0.3, 1, 10, &MultiGeneConditionOmegaModel::NucRatesHyperLogProb,
@@ -1119,6 +1184,7 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveNucRates() {
+        PERF_TIMER(NucRatesMove);
         vector<double> &nucrelrate = (*nucrelratearray)[0];
         ProfileMove(nucrelrate, 0.1, 1, 10, &MultiGeneConditionOmegaModel::NucRatesLogProb,
                     &MultiGeneConditionOmegaModel::TouchNucMatrix, this);
@@ -1135,6 +1201,7 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveOmegaHyperParameters(int nrep) {
+        PERF_TIMER(HyperMove);
         for (int rep = 0; rep < nrep; rep++) {
             MoveGeneW(1.0, 1);
             MoveCondV(1.0, 1);
@@ -1150,6 +1217,7 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
     }
 
     double MoveCondV(double tuning, int nrep) {
+        PERF_TIMER(OmegaMove);
         double nacc = 0;
         for (int rep = 0; rep < nrep; rep++) {
             for (int j = 1; j < GetNcond(); j++) {
@@ -1173,6 +1241,7 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
     }
 
     double MoveGeneW(double tuning, int nrep) {
+        PERF_TIMER(OmegaMove);
         double nacc = 0;
         for (int rep = 0; rep < nrep; rep++) {
             for (int i = 0; i < GetNgene(); i++) {
@@ -1216,6 +1285,7 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveCondVHyperParams(double tuning, int nrep) {
+        PERF_TIMER(HyperMove);
         hypercondvsuffstat.Clear();
         hypercondvsuffstat.AddSuffStat(*condvarray);
 
@@ -1231,6 +1301,7 @@ class MultiGeneConditionOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveGeneWHyperParams(double tuning, int nrep) {
+        PERF_TIMER(HyperMove);
         hypergenewsuffstat.Clear();
         hypergenewsuffstat.AddSuffStat(*genewarray);
 
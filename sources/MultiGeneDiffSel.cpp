@@ -98,12 +98,7 @@ class MultiGeneDiffSelChain : public MultiGeneChain {
         is >> datafile >> treefile;
         is >> ncond >> nlevel >> codonmodel;
         is >> blmode >> nucmode;
-        int tmp;
-        is >> tmp;
-        if (tmp) {
-            cerr << "-- Error when reading model\n";
-            exit(1);
-        }
+        int geneformat = MultiGeneMPIModule::ReadParamTrailer(is, {});
         is >> every >> until >> saveall >> writegenedata >> size;
 
         if (modeltype == "MULTIGENEDIFFSEL") {
@@ -114,7 +109,9 @@ class MultiGeneDiffSelChain : public MultiGeneChain {
                  << " : does not recognise model type : " << modeltype << '\n';
             exit(1);
         }
+        GetModel()->SetGeneFormat(geneformat);
         GetModel()->Allocate();
+        GetModel()->SetGeneShardFile(name + ".param", false);
         GetModel()->FromStream(is);
         GetModel()->Update();
         if (!myid) {
@@ -124,13 +121,14 @@ class MultiGeneDiffSelChain : public MultiGeneChain {
     }
 
     void Save() override {
+        GetModel()->SetGeneShardFile(name + ".param", false);
         if (!myid) {
             ofstream param_os((name + ".param").c_str());
             param_os << GetModelType() << '\n';
             param_os << datafile << '\t' << treefile << '\n';
             param_os << ncond << '\t' << nlevel << '\t' << codonmodel << '\n';
             param_os << blmode << '\t' << nucmode << '\n';
-            param_os << 0 << '\n';
+            GetModel()->WriteParamTrailer(param_os, {});
             param_os << every << '\t' << until << '\t' << saveall << '\t' << writegenedata << '\t'
                      << size << '\n';
             GetModel()->MasterToStream(param_os);
@@ -171,8 +169,9 @@ int main(int argc, char *argv[]) {
     int nprocs = 0;
 
     MPI_Init(&argc, &argv);
-    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
-    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+    MultiChainSplit(argc, argv);
+    MPI_Comm_rank(ChainComm, &myid);
+    MPI_Comm_size(ChainComm, &nprocs);
 
     string name = "";
     MultiGeneDiffSelChain *chain = 0;
@@ -189,6 +188,8 @@ int main(int argc, char *argv[]) {
             cerr << "\t-f: force overwrite of already existing chain\n";
             cerr << "\t-x <every> <until>: saving frequency and stopping time "
                     "(default: every = 1, until = -1)\n";
+            cerr << "\t-nchain <k>: run k independent chains (<chainname>_0 to <chainname>_<k-1>) "
+                    "in one job, each over np/k processes with its own copy of the data\n";
             cerr << "\t+G: with site-specific output files\n";
             cerr << '\n';
             cerr << "model options:\n";
@@ -203,7 +204,7 @@ int main(int argc, char *argv[]) {
 
     // starting a chain from existing files
     if (argc == 2 && argv[1][0] != '-') {
-        name = argv[1];
+        name = MultiChainName(argv[1]);
         chain = new MultiGeneDiffSelChain(name, myid, nprocs);
     }
 
@@ -237,6 +238,9 @@ int main(int argc, char *argv[]) {
                 } else if ((s == "-t") || (s == "-T")) {
                     i++;
                     treefile = argv[i];
+                } else if (s == "-subsettaxa") {
+                    cerr << "error: -subsettaxa is only available in multigeneglobom\n";
+                    exit(1);
                 } else if (s == "-f") {
                     force = 1;
                 } else if (s == "-s") {
@@ -288,7 +292,7 @@ int main(int argc, char *argv[]) {
                     if (i != (argc - 1)) {
                         throw(0);
                     }
-                    name = argv[i];
+                    name = MultiChainName(argv[i]);
                 }
                 i++;
             }
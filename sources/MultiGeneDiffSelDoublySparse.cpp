@@ -123,12 +123,7 @@ class MultiGeneDiffSelDoublySparseChain : public MultiGeneChain {
         is >> blmode >> nucmode >> shiftmode;
         is >> pihypermean >> pihyperinvconc;
         is >> shiftprobmean >> shiftprobinvconc;
-        int tmp;
-        is >> tmp;
-        if (tmp) {
-            cerr << "-- Error when reading model\n";
-            exit(1);
-        }
+        int geneformat = MultiGeneMPIModule::ReadParamTrailer(is, {});
         is >> burnin;
         is >> every >> until >> saveall >> writegenedata >> size;
 
@@ -146,7 +141,9 @@ class MultiGeneDiffSelDoublySparseChain : public MultiGeneChain {
             GetModel()->SetWithToggles(1);
         }
         GetModel()->SetFitnessCenterMode(fitnesscentermode);
+        GetModel()->SetGeneFormat(geneformat);
         GetModel()->Allocate();
+        GetModel()->SetGeneShardFile(name + ".param", false);
         GetModel()->FromStream(is);
         GetModel()->Update();
         if (!myid) {
@@ -156,6 +153,7 @@ class MultiGeneDiffSelDoublySparseChain : public MultiGeneChain {
     }
 
     void Save() override {
+        GetModel()->SetGeneShardFile(name + ".param", false);
         if (!myid) {
             ofstream param_os((name + ".param").c_str());
             param_os << GetModelType() << '\n';
@@ -165,7 +163,7 @@ class MultiGeneDiffSelDoublySparseChain : public MultiGeneChain {
             param_os << fitnesscentermode << '\n';
             param_os << blmode << '\t' << nucmode << '\t' << shiftmode << '\n';
             param_os << pihypermean << '\t' << pihyperinvconc << '\t' << shiftprobmean << '\t' << shiftprobinvconc << '\n';
-            param_os << 0 << '\n';
+            GetModel()->WriteParamTrailer(param_os, {});
             param_os << burnin << '\t';
             param_os << every << '\t' << until << '\t' << saveall << '\t' << writegenedata << '\t' << size << '\n';
             GetModel()->MasterToStream(param_os);
@@ -232,8 +230,9 @@ int main(int argc, char *argv[]) {
     int nprocs = 0;
 
     MPI_Init(&argc, &argv);
-    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
-    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+    MultiChainSplit(argc, argv);
+    MPI_Comm_rank(ChainComm, &myid);
+    MPI_Comm_size(ChainComm, &nprocs);
 
     string name = "";
     MultiGeneDiffSelDoublySparseChain *chain = 0;
@@ -262,6 +261,8 @@ int main(int argc, char *argv[]) {
             cerr << "\t-f: force overwrite of already existing chain\n";
             cerr << "\t-x <every> <until>: saving frequency and stopping time "
                     "(default: every = 1, until = -1)\n";
+            cerr << "\t-nchain <k>: run k independent chains (<chainname>_0 to <chainname>_<k-1>) "
+                    "in one job, each over np/k processes with its own copy of the data\n";
             cerr << "\t-g: without gene-specific output files (.geneshiftprob and geneshiftcounts)\n";
             cerr << "\t+g: with gene-specific output files\n";
             cerr << "\t+G: with gene- and site-specific output files\n";
@@ -287,7 +288,7 @@ int main(int argc, char *argv[]) {
 
     // starting a chain from existing files
     else if (argc == 2 && argv[1][0] != '-') {
-        name = argv[1];
+        name = MultiChainName(argv[1]);
         chain = new MultiGeneDiffSelDoublySparseChain(name, myid, nprocs);
     }
 
@@ -330,6 +331,9 @@ int main(int argc, char *argv[]) {
                 } else if ((s == "-t") || (s == "-T")) {
                     i++;
                     treefile = argv[i];
+                } else if (s == "-subsettaxa") {
+                    cerr << "error: -subsettaxa is only available in multigeneglobom\n";
+                    exit(1);
                 } else if (s == "-f") {
                     force = 1;
                 } else if (s == "-s") {
@@ -429,7 +433,7 @@ int main(int argc, char *argv[]) {
                     if (i != (argc - 1)) {
                         throw(0);
                     }
-                    name = argv[i];
+                    name = MultiChainName(argv[i]);
                 }
                 i++;
             }
@@ -203,17 +203,22 @@ class MultiGeneDiffSelDoublySparseModel : public MultiGeneProbModel {
         } else {
             geneprocess.assign(GetLocalNgene(), (DiffSelDoublySparseModel *)0);
 
-            for (int gene = 0; gene < GetLocalNgene(); gene++) {
-                geneprocess[gene] =
-                    new DiffSelDoublySparseModel(GetLocalGeneName(gene), treefile, Ncond, Nlevel,
-                                                 codonmodel, epsilon, fitnessshape, pihypermean, shiftprobmean, shiftprobinvconc);
-                geneprocess[gene]->SetBLMode(blmode);
-                geneprocess[gene]->SetNucMode(nucmode);
-                geneprocess[gene]->SetFitnessCenterMode(fitnesscentermode);
-                geneprocess[gene]->SetWithToggles(withtoggle);
-                geneprocess[gene]->Allocate();
-            }
+            SlaveConstructGenes(
+                geneprocess,
+                [&](int gene) {
+                    return new DiffSelDoublySparseModel(GetLocalGeneName(gene), treefile, Ncond,
+                                                        Nlevel, codonmodel, epsilon, fitnessshape,
+                                                        pihypermean, shiftprobmean, shiftprobinvconc);
+                },
+                [&](int gene) {
+                    geneprocess[gene]->SetBLMode(blmode);
+                    geneprocess[gene]->SetNucMode(nucmode);
+                    geneprocess[gene]->SetFitnessCenterMode(fitnesscentermode);
+                    geneprocess[gene]->SetWithToggles(withtoggle);
+                    geneprocess[gene]->Allocate();
+                });
         }
+        ReportStartupTime();
     }
 
     void FastUpdate() {
@@ -274,11 +279,7 @@ class MultiGeneDiffSelDoublySparseModel : public MultiGeneProbModel {
         GenePostPred(name);
     }
 
-    void GenePostPred(string name) {
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            geneprocess[gene]->PostPred(name + GetLocalGeneName(gene));
-        }
-    }
+    ProbModel *GetLocalGeneModel(int gene) override { return geneprocess[gene]; }
 
     void SetWithToggles(int in) {
         withtoggle = in;
@@ -385,29 +386,11 @@ class MultiGeneDiffSelDoublySparseModel : public MultiGeneProbModel {
         os << shiftprobhyperinvconc << '\t';
         os << pi << '\t';
 
-        for (int proc = 1; proc < GetNprocs(); proc++) {
-            MPI_Status stat;
-            int size;
-            MPI_Recv(&size, 1, MPI_INT, proc, TAG1, MPI_COMM_WORLD, &stat);
-            MPIBuffer buffer(size);
-            MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD,
-                     &stat);
-            os << size << '\n';
-            buffer.ToStream(os);
-        }
+        MasterGeneStatesToStream(os);
     }
 
     void SlaveToStream() const override {
-        int size = 0;
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            size += geneprocess[gene]->GetMPISize();
-        }
-        MPIBuffer buffer(size);
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            buffer << *geneprocess[gene];
-        }
-        MPI_Send(&size, 1, MPI_INT, 0, TAG1, MPI_COMM_WORLD);
-        MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD);
+        SlaveGeneStatesToStream(geneprocess);
     }
 
     void MasterFromStream(istream &is) override {
@@ -427,34 +410,11 @@ class MultiGeneDiffSelDoublySparseModel : public MultiGeneProbModel {
         is >> shiftprobhyperinvconc;
         is >> pi;
 
-        for (int proc = 1; proc < GetNprocs(); proc++) {
-            int size;
-            is >> size;
-            MPI_Send(&size, 1, MPI_INT, proc, TAG1, MPI_COMM_WORLD);
-            MPIBuffer buffer(size);
-            buffer.FromStream(is);
-            MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD);
-        }
+        MasterGeneStatesFromStream(is);
     }
 
     void SlaveFromStream() override {
-        int checksize = 0;
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            checksize += geneprocess[gene]->GetMPISize();
-        }
-        MPI_Status stat;
-        int size;
-        MPI_Recv(&size, 1, MPI_INT, 0, TAG1, MPI_COMM_WORLD, &stat);
-        if (size != checksize) {
-            cerr << "error in SlaveFromStream: non matching buffer size\n";
-            exit(1);
-        }
-        MPIBuffer buffer(size);
-        MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD, &stat);
-
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            buffer >> *geneprocess[gene];
-        }
+        SlaveGeneStatesFromStream(geneprocess);
     }
 
     double GetSlaveMoveTime() const { return moveTime; }
@@ -735,6 +695,7 @@ class MultiGeneDiffSelDoublySparseModel : public MultiGeneProbModel {
     }
 
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &MultiGeneDiffSelDoublySparseModel::LambdaHyperLogProb,
@@ -745,6 +706,7 @@ class MultiGeneDiffSelDoublySparseModel : public MultiGeneProbModel {
     }
 
     void MoveBranchLengthsHyperParameters(int nrep) {
+        PERF_TIMER(HyperMove);
         for (int j = 0; j < Nbranch; j++) {
             BranchLengthsHyperScalingMove(1.0, nrep);
             BranchLengthsHyperScalingMove(0.3, nrep);
@@ -794,6 +756,7 @@ class MultiGeneDiffSelDoublySparseModel : public MultiGeneProbModel {
     }
 
     void MoveNucRatesHyperParameters(int nrep) {
+        PERF_TIMER(HyperMove);
         ProfileMove(nucrelratehypercenter, 1.0, 1, nrep,
                     &MultiGeneDiffSelDoublySparseModel::NucRatesHyperLogProb,
                     &MultiGeneDiffSelDoublySparseModel::NoUpdate, this);
@@ -837,6 +800,7 @@ class MultiGeneDiffSelDoublySparseModel : public MultiGeneProbModel {
     }
 
     void MoveShiftProbHyperParameters(int nrep) {
+        PERF_TIMER(HyperMove);
         if (pihyperinvconc) {
             MovePi(0.3, nrep);
         }
@@ -1132,7 +1096,7 @@ class MultiGeneDiffSelDoublySparseModel : public MultiGeneProbModel {
                     int totnsite = GetSlaveTotNsite(proc);
                     double *array = new double[totnsite * Naa];
                     MPI_Status stat;
-                    MPI_Recv(array, totnsite * Naa, MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD, &stat);
+                    MPI_Recv(array, totnsite * Naa, MPI_DOUBLE, proc, TAG1, ChainComm, &stat);
 
                     int i = 0;
                     for (int gene = 0; gene < Ngene; gene++) {
@@ -1166,7 +1130,7 @@ class MultiGeneDiffSelDoublySparseModel : public MultiGeneProbModel {
                     int totnsite = GetSlaveTotNsite(proc);
                     int *array = new int[totnsite * Naa];
                     MPI_Status stat;
-                    MPI_Recv(array, totnsite * Naa, MPI_INT, proc, TAG1, MPI_COMM_WORLD, &stat);
+                    MPI_Recv(array, totnsite * Naa, MPI_INT, proc, TAG1, ChainComm, &stat);
 
                     int i = 0;
                     for (int gene = 0; gene < Ngene; gene++) {
@@ -1218,7 +1182,7 @@ class MultiGeneDiffSelDoublySparseModel : public MultiGeneProbModel {
                     exit(1);
                 }
 
-                MPI_Send(array, totnsite * Naa, MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD);
+                MPI_Send(array, totnsite * Naa, MPI_DOUBLE, 0, TAG1, ChainComm);
                 delete[] array;
             }
             for (int k = 1; k < Ncond; k++) {
@@ -1236,7 +1200,7 @@ class MultiGeneDiffSelDoublySparseModel : public MultiGeneProbModel {
                     exit(1);
                 }
 
-                MPI_Send(array, totnsite * Naa, MPI_INT, 0, TAG1, MPI_COMM_WORLD);
+                MPI_Send(array, totnsite * Naa, MPI_INT, 0, TAG1, ChainComm);
                 delete[] array;
             }
         }
@@ -127,16 +127,21 @@ class MultiGeneDiffSelModel : public MultiGeneProbModel {
         } else {
             geneprocess.assign(GetLocalNgene(), (DiffSelModel *)0);
 
-            for (int gene = 0; gene < GetLocalNgene(); gene++) {
-                int fixglob = 1;
-                int fixvar = 1;
-                geneprocess[gene] = new DiffSelModel(GetLocalGeneName(gene), treefile, Ncond,
-                                                           Nlevel, fixglob, fixvar, codonmodel);
-                geneprocess[gene]->SetBLMode(blmode);
-                geneprocess[gene]->SetNucMode(nucmode);
-                geneprocess[gene]->Allocate();
-            }
+            int fixglob = 1;
+            int fixvar = 1;
+            SlaveConstructGenes(
+                geneprocess,
+                [&](int gene) {
+                    return new DiffSelModel(GetLocalGeneName(gene), treefile, Ncond, Nlevel,
+                                            fixglob, fixvar, codonmodel);
+                },
+                [&](int gene) {
+                    geneprocess[gene]->SetBLMode(blmode);
+                    geneprocess[gene]->SetNucMode(nucmode);
+                    geneprocess[gene]->Allocate();
+                });
         }
+        ReportStartupTime();
     }
 
     void FastUpdate() {
@@ -219,29 +224,11 @@ class MultiGeneDiffSelModel : public MultiGeneProbModel {
         os << *nucrelratearray << '\t';
         os << *nucstatarray << '\t';
 
-        for (int proc = 1; proc < GetNprocs(); proc++) {
-            MPI_Status stat;
-            int size;
-            MPI_Recv(&size, 1, MPI_INT, proc, TAG1, MPI_COMM_WORLD, &stat);
-            MPIBuffer buffer(size);
-            MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD,
-                     &stat);
-            os << size << '\n';
-            buffer.ToStream(os);
-        }
+        MasterGeneStatesToStream(os);
     }
 
     void SlaveToStream() const override {
-        int size = 0;
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            size += geneprocess[gene]->GetMPISize();
-        }
-        MPIBuffer buffer(size);
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            buffer << *geneprocess[gene];
-        }
-        MPI_Send(&size, 1, MPI_INT, 0, TAG1, MPI_COMM_WORLD);
-        MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD);
+        SlaveGeneStatesToStream(geneprocess);
     }
 
     void MasterFromStream(istream &is) override {
@@ -257,34 +244,11 @@ class MultiGeneDiffSelModel : public MultiGeneProbModel {
         is >> *nucrelratearray;
         is >> *nucstatarray;
 
-        for (int proc = 1; proc < GetNprocs(); proc++) {
-            int size;
-            is >> size;
-            MPI_Send(&size, 1, MPI_INT, proc, TAG1, MPI_COMM_WORLD);
-            MPIBuffer buffer(size);
-            buffer.FromStream(is);
-            MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD);
-        }
+        MasterGeneStatesFromStream(is);
     }
 
     void SlaveFromStream() override {
-        int checksize = 0;
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            checksize += geneprocess[gene]->GetMPISize();
-        }
-        MPI_Status stat;
-        int size;
-        MPI_Recv(&size, 1, MPI_INT, 0, TAG1, MPI_COMM_WORLD, &stat);
-        if (size != checksize) {
-            cerr << "error in SlaveFromStream: non matching buffer size\n";
-            exit(1);
-        }
-        MPIBuffer buffer(size);
-        MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD, &stat);
-
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            buffer >> *geneprocess[gene];
-        }
+        SlaveGeneStatesFromStream(geneprocess);
     }
 
     double GetSlaveMoveTime() const { return moveTime; }
@@ -467,6 +431,7 @@ class MultiGeneDiffSelModel : public MultiGeneProbModel {
     }
 
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &MultiGeneDiffSelModel::LambdaHyperLogProb,
@@ -477,6 +442,7 @@ class MultiGeneDiffSelModel : public MultiGeneProbModel {
     }
 
     void MoveBranchLengthsHyperParameters() {
+        PERF_TIMER(HyperMove);
         for (int j = 0; j < Nbranch; j++) {
             BranchLengthsHyperScalingMove(1.0, 10);
             BranchLengthsHyperScalingMove(0.3, 10);
@@ -523,6 +489,7 @@ class MultiGeneDiffSelModel : public MultiGeneProbModel {
     }
 
     void MoveNucRatesHyperParameters() {
+        PERF_TIMER(HyperMove);
         ProfileMove(nucrelratehypercenter, 1.0, 1, 10,
                     &MultiGeneDiffSelModel::NucRatesHyperLogProb,
                     &MultiGeneDiffSelModel::NoUpdate, this);
@@ -700,7 +667,7 @@ class MultiGeneDiffSelModel : public MultiGeneProbModel {
                 int totnsite = GetSlaveTotNsite(proc);
                 double *array = new double[totnsite * Naa];
                 MPI_Status stat;
-                MPI_Recv(array, totnsite * Naa, MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD, &stat);
+                MPI_Recv(array, totnsite * Naa, MPI_DOUBLE, proc, TAG1, ChainComm, &stat);
 
                 int i = 0;
                 for (int gene = 0; gene < Ngene; gene++) {
@@ -748,7 +715,7 @@ class MultiGeneDiffSelModel : public MultiGeneProbModel {
                 exit(1);
             }
 
-            MPI_Send(array, totnsite * Naa, MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD);
+            MPI_Send(array, totnsite * Naa, MPI_DOUBLE, 0, TAG1, ChainComm);
             delete[] array;
         }
     }
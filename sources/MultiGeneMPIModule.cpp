@@ -24,8 +24,13 @@ void MultiGeneMPIModule::AllocateFromList(string datafile, string indatapath) {
     vector<int> genealloc(Ngene, 0);
     vector<int> geneweight(Ngene, 0);
 
+    // only master reads all alignments to get their sizes (which it then
+    // broadcasts); slaves just need the first one, as a reference for the taxon set
     for (int gene = 0; gene < Ngene; gene++) {
         is >> genename[gene];
+        if (myid && gene) {
+            continue;
+        }
         SequenceAlignment *tmpdata = new FileSequenceAlignment(datapath + genename[gene]);
 
         if (!gene) {
@@ -39,6 +44,8 @@ void MultiGeneMPIModule::AllocateFromList(string datafile, string indatapath) {
             delete tmpdata;
         }
     }
+    MPI_Bcast(genesize.data(), Ngene, MPI_INT, 0, ChainComm);
+    MPI_Bcast(geneweight.data(), Ngene, MPI_INT, 0, ChainComm);
     MakeGeneList(genename, genesize, geneweight, genealloc);
 }
 
@@ -157,28 +164,23 @@ void MultiGeneMPIModule::MakeGeneList(const vector<string>& genename, const vect
     }
 
     if (!myid) {
+        // master keeps genes in the order of the data file, whatever the number
+        // of processes, so that gene arrays saved by master (see MasterToStream
+        // in multi-gene models) can be reloaded with another allocation
         LocalNgene = Ngene;
-        GeneName.assign(Ngene, "noname");
-        GeneNsite.assign(Ngene, 0);
-        GeneAlloc.assign(Ngene, 0);
-        int i = 0;
+        GeneName = genename;
+        GeneNsite = genesize;
+        GeneAlloc = genealloc;
+        SlaveGeneList.assign(nprocs, std::vector<int>());
+        for (int gene = 0; gene < Ngene; gene++) {
+            SlaveGeneList[genealloc[gene]].push_back(gene);
+        }
         cerr << '\n';
         cerr << "proc\tngene\ttotnsite\n";
         for (int proc = 1; proc < nprocs; proc++) {
             cerr << proc << '\t' << SlaveNgene[proc] << '\t' << SlaveTotNsite[proc] << '\n';
-            for (int gene = 0; gene < Ngene; gene++) {
-                if (genealloc[gene] == proc) {
-                    GeneAlloc[i] = proc;
-                    GeneName[i] = genename[gene];
-                    GeneNsite[i] = genesize[gene];
-                    i++;
-                }
-            }
         }
         cerr << '\n';
-        if (i != Ngene) {
-            cerr << "error in mpimodule: non matching number of genes\n";
-        }
     } else {
         LocalNgene = SlaveNgene[myid];
         GeneName.assign(LocalNgene, "NoName");
@@ -195,6 +197,55 @@ void MultiGeneMPIModule::MakeGeneList(const vector<string>& genename, const vect
     }
 }
 
+void MultiGeneMPIModule::SetGeneFormat(int informat) {
+    geneformat = informat;
+    if (!myid && !geneformat) {
+        // earlier versions: master held genes grouped by process
+        vector<string> genename;
+        vector<int> genesize;
+        vector<int> genealloc;
+        SlaveGeneList.assign(nprocs, std::vector<int>());
+        for (int proc = 1; proc < nprocs; proc++) {
+            for (int gene = 0; gene < Ngene; gene++) {
+                if (GeneAlloc[gene] == proc) {
+                    SlaveGeneList[proc].push_back(genename.size());
+                    genename.push_back(GeneName[gene]);
+                    genesize.push_back(GeneNsite[gene]);
+                    genealloc.push_back(proc);
+                }
+            }
+        }
+        GeneName = genename;
+        GeneNsite = genesize;
+        GeneAlloc = genealloc;
+    }
+}
+
+int MultiGeneMPIModule::ReadParamTrailer(istream &is, const vector<int *> &fields) {
+    int geneformat = 0;
+    int check;
+    is >> check;
+    for (size_t i = 0; check && (i <= fields.size()); i++) {
+        is >> ((i < fields.size()) ? *fields[i] : geneformat);
+        is >> check;
+    }
+    if (check) {
+        cerr << "error when reading model\n";
+        exit(1);
+    }
+    return geneformat;
+}
+
+void MultiGeneMPIModule::WriteParamTrailer(ostream &os, const vector<int> &fields) const {
+    for (int field : fields) {
+        os << 1 << '\n';
+        os << field << '\n';
+    }
+    os << 1 << '\n';
+    os << geneformat << '\n';
+    os << 0 << '\n';
+}
+
 void MultiGeneMPIModule::PrintGeneList(ostream &os) const {
     if (myid) {
         cerr << "error: slave in MultiGeneMPIModule::PrintGeneList\n";
@@ -205,3 +256,108 @@ void MultiGeneMPIModule::PrintGeneList(ostream &os) const {
         os << GeneName[gene] << '\t' << GeneNsite[gene] << '\n';
     }
 }
+
+void MultiGeneMPIModule::ReportStartupTime() const {
+    // phase times, then number of threads
+    double local[4] = {startuptime[0], startuptime[1], startuptime[2], 0};
+    if (myid) {
+        local[3] = GetLocalNthread();
+    }
+    double max[4];
+    MPI_Reduce(local, max, 4, MPI_DOUBLE, MPI_MAX, 0, ChainComm);
+    if (!myid) {
+        cerr << "gene construction (max over slaves, up to " << max[3]
+             << " threads per slave): reading " << max[0] / 1000 << "s, allocating "
+             << max[1] / 1000 << "s, unfolding " << max[2] / 1000 << "s\n";
+    }
+}
+
+void MultiGeneMPIModule::BeginPack() const {
+    if (packing) {
+        cerr << "error in MultiGeneMPIModule::BeginPack: already packing\n";
+        exit(1);
+    }
+    WaitPack();
+    packbuffer.assign(myid ? 1 : nprocs, vector<double>());
+    packing = true;
+}
+
+void MultiGeneMPIModule::PackGlobal(const MPIBuffer &buffer) const {
+    for (auto &pack : packbuffer) {
+        pack.insert(pack.end(), buffer.GetBuffer(), buffer.GetBuffer() + buffer.GetSize());
+    }
+}
+
+void MultiGeneMPIModule::PackToProc(int proc, const MPIBuffer &buffer) const {
+    vector<double> &pack = packbuffer[proc];
+    pack.insert(pack.end(), buffer.GetBuffer(), buffer.GetBuffer() + buffer.GetSize());
+}
+
+void MultiGeneMPIModule::EndPack() const {
+    packing = false;
+    // buffers must stay alive until the sends complete (WaitPack)
+    sendbuffer.swap(packbuffer);
+    if (!myid) {
+        sendrequest.assign(nprocs - 1, MPI_REQUEST_NULL);
+        for (int proc = 1; proc < nprocs; proc++) {
+            MPI_Isend(sendbuffer[proc].data(), sendbuffer[proc].size(), MPI_DOUBLE, proc, TAG1,
+                      ChainComm, &sendrequest[proc - 1]);
+        }
+    } else {
+        sendrequest.assign(1, MPI_REQUEST_NULL);
+        MPI_Isend(sendbuffer[0].data(), sendbuffer[0].size(), MPI_DOUBLE, 0, TAG1,
+                  ChainComm, &sendrequest[0]);
+    }
+}
+
+void MultiGeneMPIModule::WaitPack() const {
+    if (!sendrequest.empty()) {
+        MPI_Waitall(sendrequest.size(), sendrequest.data(), MPI_STATUSES_IGNORE);
+        sendrequest.clear();
+    }
+}
+
+void MultiGeneMPIModule::BeginUnpack() const {
+    if (unpacking) {
+        cerr << "error in MultiGeneMPIModule::BeginUnpack: already unpacking\n";
+        exit(1);
+    }
+    unpackbuffer.assign(myid ? 1 : nprocs, vector<double>());
+    unpackpos.assign(unpackbuffer.size(), 0);
+    PERF_TIMER(MPIWait);
+    for (int k = myid ? 0 : 1; k < (int)unpackbuffer.size(); k++) {
+        // size of the packed message is known only on the sending side
+        int source = myid ? 0 : k;
+        MPI_Status stat;
+        MPI_Probe(source, TAG1, ChainComm, &stat);
+        int count;
+        MPI_Get_count(&stat, MPI_DOUBLE, &count);
+        unpackbuffer[k].resize(count);
+        MPI_Recv(unpackbuffer[k].data(), count, MPI_DOUBLE, source, TAG1, ChainComm, &stat);
+    }
+    unpacking = true;
+}
+
+void MultiGeneMPIModule::Unpack(int proc, MPIBuffer &buffer) const {
+    if (myid) {
+        proc = 0;
+    }
+    const vector<double> &pack = unpackbuffer[proc];
+    if (unpackpos[proc] + buffer.GetSize() > pack.size()) {
+        cerr << "error in MultiGeneMPIModule::Unpack: message too short\n";
+        exit(1);
+    }
+    copy(pack.begin() + unpackpos[proc], pack.begin() + unpackpos[proc] + buffer.GetSize(),
+         buffer.GetBuffer());
+    unpackpos[proc] += buffer.GetSize();
+}
+
+void MultiGeneMPIModule::EndUnpack() const {
+    for (int k = myid ? 0 : 1; k < (int)unpackbuffer.size(); k++) {
+        if (unpackpos[k] != unpackbuffer[k].size()) {
+            cerr << "error in MultiGeneMPIModule::EndUnpack: message not entirely read\n";
+            exit(1);
+        }
+    }
+    unpacking = false;
+}
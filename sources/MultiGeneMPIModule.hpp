@@ -8,11 +8,19 @@ using namespace std;
 #include "BranchArray.hpp"
 #include "MPIBuffer.hpp"
 #include "Parallel.hpp"
+#include "PerfCounters.hpp"
+#include "PhyloProcess.hpp"
 #include "SequenceAlignment.hpp"
 
 class MultiGeneMPIModule {
   public:
-    MultiGeneMPIModule(int inmyid, int innprocs) : myid(inmyid), nprocs(innprocs) {}
+    MultiGeneMPIModule(int inmyid, int innprocs)
+        : myid(inmyid),
+          nprocs(innprocs),
+          geneformat(1),
+          packing(false),
+          unpacking(false),
+          startuptime{0, 0, 0} {}
     ~MultiGeneMPIModule() {}
 
     int GetMyid() const { return myid; }
@@ -48,17 +56,120 @@ class MultiGeneMPIModule {
 
     void PrintGeneList(ostream &os) const;
 
+    //! \brief format of the gene states saved by this model
+    //!
+    //! 1 (default): master holds genes in the order of the data file, and gene
+    //! states held by slaves are written into per-process shards, keyed by gene
+    //! name (see MultiGeneProbModel::SetGeneShardFile). 0: format of earlier
+    //! versions, where master held genes grouped by process, and gene states
+    //! were written by master in per-process blocks; files in that format can
+    //! only be read with the number of processes with which they were written.
+    //! To be called after the genes have been allocated (model constructor),
+    //! and before Allocate.
+    void SetGeneFormat(int informat);
+
+    int GetGeneFormat() const { return geneformat; }
+
+    //! \brief read the optional fields closing the header of a .param file
+    //!
+    //! Each field is preceded by a 1, and the list is closed by a 0. fields
+    //! are the model-specific ones (e.g. subsettaxa), in the order in which
+    //! they were introduced; the gene format (see SetGeneFormat) always comes
+    //! last, and is returned. Files written by earlier versions stop earlier:
+    //! missing fields keep their current value, and a missing gene format is
+    //! taken to be 0.
+    static int ReadParamTrailer(istream &is, const vector<int *> &fields);
+
+    //! write the fields read by ReadParamTrailer, followed by the gene format
+    void WriteParamTrailer(ostream &os, const vector<int> &fields) const;
+
+    //! \brief construct the models of the genes held by this slave
+    //!
+    //! make(gene) returns a new model for local gene, reading its alignment and
+    //! the tree, and is called over several threads (ThreadedFor). init(gene)
+    //! then sets up and allocates the model, gene after gene, since this draws
+    //! initial values from the random number generator. The phylogenetic
+    //! processes, whose allocation is most of the work, are unfolded at the
+    //! end, again over threads (PhyloProcess::DeferUnfold). Phase times are
+    //! reported by ReportStartupTime.
+    template <class M, class F, class G>
+    void SlaveConstructGenes(std::vector<M *> &geneprocess, F make, G init) {
+        Chrono chrono;
+        chrono.Start();
+        ThreadedFor(GetLocalNgene(), [&](int gene) { geneprocess[gene] = make(gene); });
+        chrono.Stop();
+        startuptime[0] = chrono.GetTime();
+
+        chrono.Reset();
+        chrono.Start();
+        PhyloProcess::DeferUnfold(true);
+        for (int gene = 0; gene < GetLocalNgene(); gene++) {
+            init(gene);
+        }
+        PhyloProcess::DeferUnfold(false);
+        chrono.Stop();
+        startuptime[1] = chrono.GetTime();
+
+        chrono.Reset();
+        chrono.Start();
+        PhyloProcess::UnfoldDeferred();
+        chrono.Stop();
+        startuptime[2] = chrono.GetTime();
+    }
+
+    //! \brief report times spent by slaves in constructing their genes
+    //!
+    //! collective (called by master and slaves once all genes are
+    //! constructed): master writes the maximum over slaves of the time spent
+    //! in each phase of SlaveConstructGenes
+    void ReportStartupTime() const;
+
+    //! \brief start packing outgoing messages
+    //!
+    //! Between BeginPack and EndPack, messages sent by slaves to master
+    //! (SlaveSendAdditive, SlaveSendGeneArray) or by master to slaves
+    //! (MasterSendGlobal, MasterSendGeneArray) are appended to one buffer per
+    //! destination, which EndPack then sends as a single message. The receiving
+    //! side brackets the matching receive calls, in the same order, between
+    //! BeginUnpack and EndUnpack. This groups the exchanges of suff stats and
+    //! hyperparameters that are ready at the same time into one round trip.
+    //!
+    //! EndPack does not wait for the messages to be delivered (MPI_Isend):
+    //! work that does not depend on the reply can be done between EndPack and
+    //! BeginUnpack, while the other side is busy. The send buffers are released
+    //! by WaitPack, called by the next BeginPack.
+    void BeginPack() const;
+    //! send packed messages (one per slave on master, one to master on slave),
+    //! without waiting for completion
+    void EndPack() const;
+    //! wait for completion of the messages sent by the last EndPack
+    void WaitPack() const;
+    //! receive one packed message (from each slave on master, from master on
+    //! slave), to be read by subsequent receive calls
+    void BeginUnpack() const;
+    //! check that the packed messages have been entirely read
+    void EndUnpack() const;
+
     template <class T>
     void MasterSendGlobal(const T &t) const {
         MPIBuffer buffer(MPISize(t));
         buffer << t;
-        MPI_Bcast(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        if (packing) {
+            PackGlobal(buffer);
+        } else {
+            MPI_Bcast(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, ChainComm);
+        }
     }
 
     template <class T>
     void SlaveReceiveGlobal(T &t) {
         MPIBuffer buffer(MPISize(t));
-        MPI_Bcast(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        if (unpacking) {
+            Unpack(0, buffer);
+        } else {
+            PERF_TIMER(MPIWait);
+            MPI_Bcast(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, ChainComm);
+        }
         buffer >> t;
     }
 
@@ -66,13 +177,22 @@ class MultiGeneMPIModule {
     void MasterSendGlobal(const T &t, const U &u) const {
         MPIBuffer buffer(MPISize(t) + MPISize(u));
         buffer << t << u;
-        MPI_Bcast(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        if (packing) {
+            PackGlobal(buffer);
+        } else {
+            MPI_Bcast(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, ChainComm);
+        }
     }
 
     template <class T, class U>
     void SlaveReceiveGlobal(T &t, U &u) {
         MPIBuffer buffer(MPISize(t) + MPISize(u));
-        MPI_Bcast(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        if (unpacking) {
+            Unpack(0, buffer);
+        } else {
+            PERF_TIMER(MPIWait);
+            MPI_Bcast(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, ChainComm);
+        }
         buffer >> t >> u;
     }
 
@@ -80,31 +200,43 @@ class MultiGeneMPIModule {
     void SlaveSendAdditive(const T &t) const {
         MPIBuffer buffer(MPISize(t));
         buffer << t;
-        MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD);
+        if (packing) {
+            PackGlobal(buffer);
+        } else {
+            MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, ChainComm);
+        }
     }
 
     template <class T>
     void MasterReceiveAdditive(T &t) {
         for (int proc = 1; proc < GetNprocs(); proc++) {
             MPIBuffer buffer(MPISize(t));
-            MPI_Status stat;
-            MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD,
-                     &stat);
+            if (unpacking) {
+                Unpack(proc, buffer);
+            } else {
+                MPI_Status stat;
+                PERF_TIMER(MPIWait);
+                MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1,
+                         ChainComm, &stat);
+            }
             t += buffer;
         }
     }
 
     template <class T>
     void MasterSendGeneArray(const Selector<T> &array) const {
-        int thusfar = 0;
         for (int proc = 1; proc < GetNprocs(); proc++) {
             int ngene = GetSlaveNgene(proc);
             MPIBuffer buffer(ngene * MPISize(array.GetVal(0)));
-            for (int gene = 0; gene < ngene; gene++) {
-                buffer << array.GetVal(thusfar);
-                thusfar++;
+            for (int gene : SlaveGeneList[proc]) {
+                buffer << array.GetVal(gene);
+            }
+            if (packing) {
+                PackToProc(proc, buffer);
+            } else {
+                MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1,
+                         ChainComm);
             }
-            MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD);
         }
     }
 
@@ -112,8 +244,14 @@ class MultiGeneMPIModule {
     void SlaveReceiveGeneArray(Array<T> &array) {
         int ngene = GetLocalNgene();
         MPIBuffer buffer(ngene * MPISize(array[0]));
-        MPI_Status stat;
-        MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD, &stat);
+        if (unpacking) {
+            Unpack(0, buffer);
+        } else {
+            MPI_Status stat;
+            PERF_TIMER(MPIWait);
+            MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, ChainComm,
+                     &stat);
+        }
         for (int gene = 0; gene < ngene; gene++) {
             buffer >> array[gene];
         }
@@ -126,36 +264,46 @@ class MultiGeneMPIModule {
         for (int gene = 0; gene < ngene; gene++) {
             buffer << array.GetVal(gene);
         }
-        MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD);
+        if (packing) {
+            PackGlobal(buffer);
+        } else {
+            MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, ChainComm);
+        }
     }
 
     template <class T>
-    void MasterReceiveGeneArray(Array<T> &array) {
-        int thusfar = 0;
+    void MasterReceiveGeneArray(Array<T> &array) const {
         for (int proc = 1; proc < GetNprocs(); proc++) {
             int ngene = GetSlaveNgene(proc);
             MPIBuffer buffer(ngene * MPISize(array[0]));
-            MPI_Status stat;
-            MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD,
-                     &stat);
-            for (int gene = 0; gene < ngene; gene++) {
-                buffer >> array[thusfar];
-                thusfar++;
+            if (unpacking) {
+                Unpack(proc, buffer);
+            } else {
+                MPI_Status stat;
+                PERF_TIMER(MPIWait);
+                MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1,
+                         ChainComm, &stat);
+            }
+            for (int gene : SlaveGeneList[proc]) {
+                buffer >> array[gene];
             }
         }
     }
 
     template <class T, class U>
     void MasterSendGeneArray(const Selector<T> &v, const Selector<U> &w) const {
-        int thusfar = 0;
         for (int proc = 1; proc < GetNprocs(); proc++) {
             int ngene = GetSlaveNgene(proc);
             MPIBuffer buffer(ngene * (MPISize(v.GetVal(0)) + MPISize(w.GetVal(0))));
-            for (int gene = 0; gene < ngene; gene++) {
-                buffer << v.GetVal(thusfar) << w.GetVal(thusfar);
-                thusfar++;
+            for (int gene : SlaveGeneList[proc]) {
+                buffer << v.GetVal(gene) << w.GetVal(gene);
+            }
+            if (packing) {
+                PackToProc(proc, buffer);
+            } else {
+                MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1,
+                         ChainComm);
             }
-            MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD);
         }
     }
 
@@ -163,8 +311,14 @@ class MultiGeneMPIModule {
     void SlaveReceiveGeneArray(Array<T> &v, Array<U> &w) {
         int ngene = GetLocalNgene();
         MPIBuffer buffer(ngene * (MPISize(v[0]) + MPISize(w[0])));
-        MPI_Status stat;
-        MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD, &stat);
+        if (unpacking) {
+            Unpack(0, buffer);
+        } else {
+            MPI_Status stat;
+            PERF_TIMER(MPIWait);
+            MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, ChainComm,
+                     &stat);
+        }
         for (int gene = 0; gene < ngene; gene++) {
             buffer >> v[gene] >> w[gene];
         }
@@ -177,28 +331,51 @@ class MultiGeneMPIModule {
         for (int gene = 0; gene < ngene; gene++) {
             buffer << v.GetVal(gene) << w.GetVal(gene);
         }
-        MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD);
+        if (packing) {
+            PackGlobal(buffer);
+        } else {
+            MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, ChainComm);
+        }
     }
 
     template <class T, class U>
-    void MasterReceiveGeneArray(Array<T> &v, Array<U> &w) {
-        int thusfar = 0;
+    void MasterReceiveGeneArray(Array<T> &v, Array<U> &w) const {
         for (int proc = 1; proc < GetNprocs(); proc++) {
             int ngene = GetSlaveNgene(proc);
             MPIBuffer buffer(ngene * (MPISize(v[0]) + MPISize(w[0])));
-            MPI_Status stat;
-            MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD,
-                     &stat);
-            for (int gene = 0; gene < ngene; gene++) {
-                buffer >> v[thusfar] >> w[thusfar];
-                thusfar++;
+            if (unpacking) {
+                Unpack(proc, buffer);
+            } else {
+                MPI_Status stat;
+                PERF_TIMER(MPIWait);
+                MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1,
+                         ChainComm, &stat);
+            }
+            for (int gene : SlaveGeneList[proc]) {
+                buffer >> v[gene] >> w[gene];
             }
         }
     }
 
   protected:
+    // message packing (see BeginPack)
+    void PackGlobal(const MPIBuffer &buffer) const;
+    void PackToProc(int proc, const MPIBuffer &buffer) const;
+    void Unpack(int proc, MPIBuffer &buffer) const;
+
     int myid;
     int nprocs;
+    int geneformat;
+
+    // packed messages, indexed by destination (resp. source) process; on a
+    // slave, only entry 0 is used
+    mutable bool packing;
+    mutable bool unpacking;
+    mutable std::vector<std::vector<double>> packbuffer;
+    mutable std::vector<std::vector<double>> sendbuffer;
+    mutable std::vector<MPI_Request> sendrequest;
+    mutable std::vector<std::vector<double>> unpackbuffer;
+    mutable std::vector<size_t> unpackpos;
 
     string datapath;
 
@@ -207,10 +384,16 @@ class MultiGeneMPIModule {
     std::vector<int> SlaveNgene;
     std::vector<int> SlaveTotNsite;
     std::vector<int> GeneAlloc;
+    // master: indices of the genes allocated to each process, in the order of
+    // the local genes of that process
+    std::vector<std::vector<int>> SlaveGeneList;
     std::vector<string> GeneName;
     std::vector<int> GeneNsite;
 
     SequenceAlignment *refdata;
+
+    // times (ms) spent in each phase of SlaveConstructGenes
+    double startuptime[3];
 };
 
 #endif
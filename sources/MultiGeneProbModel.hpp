@@ -2,13 +2,20 @@
 #ifndef MULTIPROBMODEL_H
 #define MULTIPROBMODEL_H
 
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
 #include "MultiGeneMPIModule.hpp"
+#include "PostPredTest.hpp"
 #include "ProbModel.hpp"
 
 class MultiGeneProbModel : public ProbModel, public MultiGeneMPIModule {
   public:
     MultiGeneProbModel(int inmyid, int innprocs)
-        : ProbModel(), MultiGeneMPIModule(inmyid, innprocs) {}
+        : ProbModel(), MultiGeneMPIModule(inmyid, innprocs),
+          geneshardappend(false),
+          postpredwrite(false) {}
 
     virtual void Update() override {
         if (!myid) {
@@ -32,6 +39,8 @@ class MultiGeneProbModel : public ProbModel, public MultiGeneMPIModule {
         } else {
             SlaveMove();
         }
+        // no message left in flight between cycles
+        WaitPack();
         return 1;
     }
 
@@ -51,6 +60,132 @@ class MultiGeneProbModel : public ProbModel, public MultiGeneMPIModule {
         }
     }
 
+    //! \brief set the base name of the files holding the states of the genes
+    //!
+    //! Models whose gene states are held only by slaves write them in parallel,
+    //! each process into its own file, <filename>.shard<myid> (see
+    //! SlaveGenesToShard), and master writes a manifest giving the location of
+    //! each gene (see MasterGeneManifestToStream). To be called on all processes
+    //! before ToStream or FromStream (filename is typically <chainname>.param
+    //! or <chainname>.chain); if append is set, states are appended to the
+    //! shards (as for points saved in the .chain file), otherwise shards are
+    //! overwritten.
+    void SetGeneShardFile(string filename, bool append) {
+        geneshardname = filename;
+        geneshardappend = append;
+    }
+
+    //! name of the file holding the states of the genes written by process proc
+    string GetGeneShardFileName(int proc) const {
+        if (geneshardname.empty()) {
+            cerr << "error: gene shard file name not set (see SetGeneShardFile)\n";
+            exit(1);
+        }
+        ostringstream s;
+        s << geneshardname << ".shard" << proc;
+        return s.str();
+    }
+
+    //! \brief create the index of a sharded gene- or site-specific trace
+    //! (master side, new chain only)
+    //!
+    //! Instead of being gathered by master and written as text (one line per
+    //! point), the values of a gene-specific (one value per gene) or
+    //! site-specific (one value per site) trace can be written in parallel,
+    //! each slave appending the values of its own genes, in binary, to its own
+    //! file, <filename>.<segment>.shard<proc> (see SlaveShardedTrace). The
+    //! index, <filename>.shardindex, gives for each gene its shard and the
+    //! offset and number of its values within the record written by this shard
+    //! at each point. Each run of the chain starts a new segment (new shards,
+    //! new gene offsets), so that a chain can be restarted with another number
+    //! of processes. The text file is reconstructed by mergeshards.
+    void MasterMakeShardedTrace(string filename, bool sitelevel) const {
+        ofstream os((filename + ".shardindex").c_str());
+        os << "SHARDEDTRACE\t" << (sitelevel ? "site" : "gene") << '\n';
+    }
+
+    //! \brief sharded trace, master side, to be called at each point
+    //!
+    //! only does something at the first point saved by this run: appends a new
+    //! segment to the index, and sends its number to the slaves
+    void MasterShardedTrace(string filename, bool sitelevel) {
+        if (shardsegment.count(filename)) {
+            return;
+        }
+        string indexname = filename + ".shardindex";
+        ifstream is(indexname.c_str());
+        string header, level;
+        is >> header >> level;
+        if ((header != "SHARDEDTRACE") || (level != (sitelevel ? "site" : "gene"))) {
+            cerr << "error: " << indexname << " is not the index of a sharded "
+                 << (sitelevel ? "site" : "gene") << "-specific trace\n";
+            exit(1);
+        }
+        int segment = 0;
+        string tag;
+        while (is >> tag) {
+            int seg, nproc, ngene;
+            is >> seg >> nproc >> ngene;
+            if ((tag != "segment") || (seg != segment)) {
+                cerr << "error when reading " << indexname << '\n';
+                exit(1);
+            }
+            is.ignore(numeric_limits<streamsize>::max(), '\n');
+            for (int gene = 0; gene < ngene; gene++) {
+                is.ignore(numeric_limits<streamsize>::max(), '\n');
+            }
+            segment++;
+        }
+        is.close();
+
+        ofstream os(indexname.c_str(), ios_base::app);
+        os << "segment\t" << segment << '\t' << GetNprocs() << '\t' << GetNgene() << '\n';
+        std::vector<int> recordsize(GetNprocs(), 0);
+        for (int gene = 0; gene < GetNgene(); gene++) {
+            int proc = GeneAlloc[gene];
+            int count = sitelevel ? GeneNsite[gene] : 1;
+            os << GeneName[gene] << '\t' << proc << '\t' << recordsize[proc] << '\t' << count
+               << '\n';
+            recordsize[proc] += count;
+        }
+        os.close();
+
+        MPI_Bcast(&segment, 1, MPI_INT, 0, ChainComm);
+        shardsegment[filename] = segment;
+    }
+
+    //! \brief sharded trace, slave side, to be called at each point: appends
+    //! the values of the local genes (in the order of the local genes; one per
+    //! gene, or nsite per gene if sitelevel) to the shard of this process
+    void SlaveShardedTrace(string filename, bool sitelevel, const std::vector<double> &values) {
+        if ((int)values.size() != (sitelevel ? GetLocalTotNsite() : GetLocalNgene())) {
+            cerr << "error in SlaveShardedTrace: non matching number of values\n";
+            exit(1);
+        }
+        ios_base::openmode mode = ios_base::app;
+        if (!shardsegment.count(filename)) {
+            int segment;
+            MPI_Bcast(&segment, 1, MPI_INT, 0, ChainComm);
+            shardsegment[filename] = segment;
+            mode = ios_base::trunc;
+        }
+        string shardname = GetShardedTraceFileName(filename, shardsegment[filename], myid);
+        ofstream os(shardname.c_str(), ios_base::out | ios_base::binary | mode);
+        os.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(double));
+        if (!os) {
+            cerr << "error: cannot write " << shardname << '\n';
+            exit(1);
+        }
+    }
+
+    //! name of the file holding the values of a sharded trace written by
+    //! process proc during a given segment (see MasterMakeShardedTrace)
+    static string GetShardedTraceFileName(string filename, int segment, int proc) {
+        ostringstream s;
+        s << filename << '.' << segment << ".shard" << proc;
+        return s.str();
+    }
+
     virtual void MasterToStream(ostream &os) const {}
     virtual void SlaveToStream() const {}
     virtual void MasterFromStream(istream &is) {}
@@ -64,6 +199,316 @@ class MultiGeneProbModel : public ProbModel, public MultiGeneMPIModule {
 
     virtual void MasterPostPred(string name) {}
     virtual void SlavePostPred(string name) {}
+
+    //! return a pointer to the model of a local gene (slave side)
+    virtual ProbModel *GetLocalGeneModel(int gene) {
+        cerr << "error: in MultiGeneProbModel::GetLocalGeneModel\n";
+        exit(1);
+    }
+
+    //! \brief switch to posterior predictive test mode
+    //!
+    //! subsequent calls to PostPred simulate gene alignments in memory and
+    //! accumulate per-gene test statistics (see PostPredTest), instead of
+    //! writing one alignment per gene into a file (files are still written if
+    //! writefiles is set). Results are collected by PostPredTestToFile.
+    void SetPostPredTest(bool writefiles) {
+        postpredwrite = writefiles;
+        if (myid) {
+            genepostpredtest.clear();
+            genepostpredsimu.clear();
+            genepostpredsimu.reserve(GetLocalNgene());
+            for (int gene = 0; gene < GetLocalNgene(); gene++) {
+                const CodonSequenceAlignment *obsdata = GetLocalGeneModel(gene)->GetCodonData();
+                genepostpredtest.push_back(PostPredTest(*obsdata));
+                genepostpredsimu.push_back(CodonSequenceAlignment(*obsdata));
+            }
+        }
+    }
+
+    //! \brief posterior predictive simulation for all local genes (slave side)
+    //!
+    //! for each gene, writes alignment into file name + gene name, or, in
+    //! posterior predictive test mode, updates gene test statistics.
+    void GenePostPred(string name) {
+        for (int gene = 0; gene < GetLocalNgene(); gene++) {
+            ProbModel *genemodel = GetLocalGeneModel(gene);
+            string genename = name + GetLocalGeneName(gene);
+            if (genepostpredtest.empty()) {
+                genemodel->PostPred(genename);
+            } else {
+                genemodel->PostPredSimu(genepostpredsimu[gene]);
+                genepostpredtest[gene].AddReplicate(genepostpredsimu[gene]);
+                if (postpredwrite) {
+                    ofstream os(genename.c_str());
+                    genepostpredsimu[gene].SequenceAlignment::ToStream(os);
+                }
+            }
+        }
+    }
+
+    //! \brief gather per-gene posterior predictive tests on master, and write
+    //! them into file (one line per gene)
+    void PostPredTestToFile(string filename) {
+        if (!myid) {
+            SimpleArray<PostPredTest> genetest(GetNgene());
+            MasterReceiveGeneArray(genetest);
+            ofstream os(filename.c_str());
+            os << "gene";
+            genetest.GetVal(0).TableHeader(os);
+            os << '\n';
+            for (int gene = 0; gene < GetNgene(); gene++) {
+                os << GetLocalGeneName(gene);
+                genetest.GetVal(gene).TableRow(os);
+                os << '\n';
+            }
+        } else {
+            SimpleArray<PostPredTest> genetest(GetLocalNgene());
+            for (int gene = 0; gene < GetLocalNgene(); gene++) {
+                genetest[gene] = genepostpredtest[gene];
+            }
+            SlaveSendGeneArray(genetest);
+        }
+    }
+
+  protected:
+    //! \brief master side of the writing of the states of the genes held by
+    //! slaves: writes a manifest (see MasterGeneManifestToStream), or, for
+    //! chains started with earlier versions (see SetGeneFormat), per-process
+    //! blocks (see MasterGeneBlocksToStream)
+    void MasterGeneStatesToStream(ostream &os) const {
+        if (GetGeneFormat()) {
+            MasterGeneManifestToStream(os);
+        } else {
+            MasterGeneBlocksToStream(os);
+        }
+    }
+
+    //! slave side of MasterGeneStatesToStream
+    template <class T>
+    void SlaveGeneStatesToStream(const std::vector<T *> &genemodel) const {
+        if (GetGeneFormat()) {
+            SlaveGenesToShard(genemodel);
+        } else {
+            SlaveGenesToBlock(genemodel);
+        }
+    }
+
+    //! master side of the reading of the states of the genes held by slaves
+    //! (see MasterGeneStatesToStream)
+    void MasterGeneStatesFromStream(istream &is) {
+        if (GetGeneFormat()) {
+            MasterGeneManifestFromStream(is);
+        } else {
+            MasterGeneBlocksFromStream(is);
+        }
+    }
+
+    //! slave side of MasterGeneStatesFromStream
+    template <class T>
+    void SlaveGeneStatesFromStream(std::vector<T *> &genemodel) {
+        if (GetGeneFormat()) {
+            SlaveGenesFromShard(genemodel);
+        } else {
+            SlaveGenesFromBlock(genemodel);
+        }
+    }
+
+    //! \brief master side of the parallel writing of gene states: collects the
+    //! offset of each gene in its shard and writes the manifest (number of
+    //! genes, then name, shard and offset of each gene)
+    void MasterGeneManifestToStream(ostream &os) const {
+        SimpleArray<double> offset(GetNgene());
+        MasterReceiveGeneArray(offset);
+        os << GetNgene();
+        for (int gene = 0; gene < GetNgene(); gene++) {
+            os << '\t' << GeneName[gene] << '\t' << GeneAlloc[gene] << '\t'
+               << (long long)offset.GetVal(gene);
+        }
+        os << '\n';
+    }
+
+    //! \brief slave side of the parallel writing of gene states: writes the
+    //! state of each local gene (name, size and MPI buffer, one gene per line)
+    //! into the shard of this process
+    template <class T>
+    void SlaveGenesToShard(const std::vector<T *> &genemodel) const {
+        ios_base::openmode mode = geneshardappend ? ios_base::app : ios_base::trunc;
+        ofstream os(GetGeneShardFileName(myid).c_str(), ios_base::out | mode);
+        if (!os) {
+            cerr << "error: cannot write " << GetGeneShardFileName(myid) << '\n';
+            exit(1);
+        }
+        os.seekp(0, ios_base::end);
+        SimpleArray<double> offset(GetLocalNgene());
+        for (int gene = 0; gene < GetLocalNgene(); gene++) {
+            offset[gene] = os.tellp();
+            unsigned int size = MPISize(*genemodel[gene]);
+            MPIBuffer buffer(size);
+            buffer << *genemodel[gene];
+            os << GetLocalGeneName(gene) << '\t' << size << '\t';
+            buffer.ToStream(os);
+            os << '\n';
+        }
+        os.close();
+        SlaveSendGeneArray(offset);
+    }
+
+    //! \brief master side of the reading of gene states: reads the manifest,
+    //! and sends to each slave the location of its genes
+    //!
+    //! genes are matched by name, so that the states can be read back with
+    //! another number of processes (and thus another allocation of genes) than
+    //! the one with which they were written
+    void MasterGeneManifestFromStream(istream &is) {
+        int ngene;
+        is >> ngene;
+        if (ngene != GetNgene()) {
+            cerr << "error when reading gene states: non matching number of genes\n";
+            cerr << ngene << '\t' << GetNgene() << '\n';
+            exit(1);
+        }
+        std::map<string, pair<int, double>> location;
+        for (int gene = 0; gene < ngene; gene++) {
+            string name;
+            int shard;
+            long long offset;
+            is >> name >> shard >> offset;
+            location[name] = make_pair(shard, (double)offset);
+        }
+        SimpleArray<int> shard(GetNgene());
+        SimpleArray<double> offset(GetNgene());
+        for (int gene = 0; gene < GetNgene(); gene++) {
+            auto l = location.find(GeneName[gene]);
+            if (l == location.end()) {
+                cerr << "error when reading gene states: cannot find gene " << GeneName[gene]
+                     << '\n';
+                exit(1);
+            }
+            shard[gene] = l->second.first;
+            offset[gene] = l->second.second;
+        }
+        MasterSendGeneArray(shard, offset);
+    }
+
+    //! \brief slave side of the reading of gene states: reads the state of
+    //! each local gene from the shard and at the offset sent by master
+    template <class T>
+    void SlaveGenesFromShard(std::vector<T *> &genemodel) {
+        SimpleArray<int> shard(GetLocalNgene());
+        SimpleArray<double> offset(GetLocalNgene());
+        SlaveReceiveGeneArray(shard, offset);
+        std::map<int, ifstream *> shardis;
+        for (int gene = 0; gene < GetLocalNgene(); gene++) {
+            ifstream *&is = shardis[shard[gene]];
+            if (!is) {
+                is = new ifstream(GetGeneShardFileName(shard[gene]).c_str());
+                if (!*is) {
+                    cerr << "error: cannot open " << GetGeneShardFileName(shard[gene]) << '\n';
+                    exit(1);
+                }
+            }
+            is->seekg((streamoff)offset[gene]);
+            string name;
+            unsigned int size;
+            *is >> name >> size;
+            if ((name != GetLocalGeneName(gene)) || (size != MPISize(*genemodel[gene]))) {
+                cerr << "error when reading state of gene " << GetLocalGeneName(gene) << " in "
+                     << GetGeneShardFileName(shard[gene]) << ": found " << name << " of size "
+                     << size << '\n';
+                exit(1);
+            }
+            MPIBuffer buffer(size);
+            buffer.FromStream(*is);
+            buffer >> *genemodel[gene];
+        }
+        for (auto &s : shardis) {
+            delete s.second;
+        }
+    }
+
+    //! \brief master side of the writing of gene states in the format of
+    //! earlier versions: for each slave, receives the states of its genes and
+    //! writes them as one block (size, then MPI buffer)
+    void MasterGeneBlocksToStream(ostream &os) const {
+        for (int proc = 1; proc < GetNprocs(); proc++) {
+            MPI_Status stat;
+            int size;
+            MPI_Recv(&size, 1, MPI_INT, proc, TAG1, ChainComm, &stat);
+            MPIBuffer buffer(size);
+            MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1, ChainComm,
+                     &stat);
+            os << size << '\n';
+            buffer.ToStream(os);
+        }
+    }
+
+    //! slave side of MasterGeneBlocksToStream
+    template <class T>
+    void SlaveGenesToBlock(const std::vector<T *> &genemodel) const {
+        int size = 0;
+        for (int gene = 0; gene < GetLocalNgene(); gene++) {
+            size += MPISize(*genemodel[gene]);
+        }
+        MPIBuffer buffer(size);
+        for (int gene = 0; gene < GetLocalNgene(); gene++) {
+            buffer << *genemodel[gene];
+        }
+        MPI_Send(&size, 1, MPI_INT, 0, TAG1, ChainComm);
+        MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, ChainComm);
+    }
+
+    //! \brief master side of the reading of gene states in the format of
+    //! earlier versions: sends each block to the corresponding slave
+    void MasterGeneBlocksFromStream(istream &is) {
+        for (int proc = 1; proc < GetNprocs(); proc++) {
+            int size;
+            is >> size;
+            MPI_Send(&size, 1, MPI_INT, proc, TAG1, ChainComm);
+            MPIBuffer buffer(size);
+            buffer.FromStream(is);
+            MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, proc, TAG1, ChainComm);
+        }
+    }
+
+    //! slave side of MasterGeneBlocksFromStream
+    template <class T>
+    void SlaveGenesFromBlock(std::vector<T *> &genemodel) {
+        int checksize = 0;
+        for (int gene = 0; gene < GetLocalNgene(); gene++) {
+            checksize += MPISize(*genemodel[gene]);
+        }
+        MPI_Status stat;
+        int size;
+        MPI_Recv(&size, 1, MPI_INT, 0, TAG1, ChainComm, &stat);
+        if (size != checksize) {
+            cerr << "error when reading gene states: non matching buffer size\n";
+            cerr << "(files written by earlier versions must be read with the same number of "
+                    "processes)\n";
+            exit(1);
+        }
+        MPIBuffer buffer(size);
+        MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, ChainComm, &stat);
+        for (int gene = 0; gene < GetLocalNgene(); gene++) {
+            buffer >> *genemodel[gene];
+        }
+    }
+
+    //! base name of the files holding the states of the genes
+    string geneshardname;
+    //! flag: append gene states to shards (otherwise, overwrite)
+    bool geneshardappend;
+
+    //! segment of each sharded trace written by this run (see
+    //! MasterMakeShardedTrace)
+    std::map<string, int> shardsegment;
+
+    //! flag: in posterior predictive test mode, also write simulated alignments
+    bool postpredwrite;
+    //! per-gene posterior predictive tests (slave side, test mode only)
+    std::vector<PostPredTest> genepostpredtest;
+    //! per-gene simulated alignments, reused across points (slave side)
+    std::vector<CodonSequenceAlignment> genepostpredsimu;
 };
 
 #endif
@@ -17,7 +17,9 @@ void MultiGeneSample::OpenChainFile() {
         cerr << "error : chain not long enough\n";
         exit(1);
     }
+    totsize = size;
     currentpoint = 0;
+    GetMultiGeneModel()->SetGeneShardFile(name + ".chain", true);
 
     if (!myid) {
         chain_is = new ifstream((name + ".chain").c_str());
@@ -25,14 +27,11 @@ void MultiGeneSample::OpenChainFile() {
             cerr << "error: cannot find file " << name << ".chain\n";
             exit(1);
         }
-        for (int i = 0; i < burnin; i++) {
-            GetMultiGeneModel()->MasterFromStream(*chain_is);
-        }
-    } else {
-        for (int i = 0; i < burnin; i++) {
-            GetMultiGeneModel()->SlaveFromStream();
-        }
+        chainindexed = ReadChainIndex();
     }
+    // slaves follow the master's reading mode
+    MPI_Bcast(&chainindexed, 1, MPI_INT, 0, ChainComm);
+    chainpos = 0;
 }
 
 void MultiGeneSample::GetNextPoint() {
@@ -40,15 +39,19 @@ void MultiGeneSample::GetNextPoint() {
         cerr << "error in Sample::GetNextPoint: going past last points\n";
         exit(1);
     }
-    if (currentpoint) {
+    if (chainindexed) {
         if (!myid) {
-            for (int i = 0; i < every - 1; i++) {
+            SeekChainPoint(GetChainPoint());
+        }
+    } else {
+        // no index: parse (and discard) all points up to the requested one
+        while (chainpos < GetChainPoint()) {
+            if (!myid) {
                 GetMultiGeneModel()->MasterFromStream(*chain_is);
-            }
-        } else {
-            for (int i = 0; i < every - 1; i++) {
+            } else {
                 GetMultiGeneModel()->SlaveFromStream();
             }
+            chainpos++;
         }
     }
     if (!myid)  {
@@ -57,6 +60,7 @@ void MultiGeneSample::GetNextPoint() {
     else    {
         GetMultiGeneModel()->SlaveFromStream();
     }
+    chainpos = GetChainPoint() + 1;
     currentpoint++;
 }
 
@@ -68,7 +72,7 @@ void MultiGeneSample::MasterPostPred() {
         ostringstream s;
         s << "ppred" << name << "_" << i << "_";
         model->PostPred(s.str());
-        MPI_Barrier(MPI_COMM_WORLD);
+        MPI_Barrier(ChainComm);
     }
     cerr << '\n';
 }
@@ -79,6 +83,6 @@ void MultiGeneSample::SlavePostPred() {
         ostringstream s;
         s << "ppred" << name << "_" << i << "_";
         model->PostPred(s.str());
-        MPI_Barrier(MPI_COMM_WORLD);
+        MPI_Barrier(ChainComm);
     }
 }
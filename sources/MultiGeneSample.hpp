@@ -40,6 +40,17 @@ class MultiGeneSample : public Sample {
     virtual void MasterPostPred();
     virtual void SlavePostPred();
 
+    //! \brief per-gene posterior predictive tests, results in <name>.ppredtest
+    //! (one line per gene)
+    void PostPredCheck(bool writefiles = false) override {
+        GetMultiGeneModel()->SetPostPredTest(writefiles);
+        PostPred();
+        GetMultiGeneModel()->PostPredTestToFile(name + ".ppredtest");
+        if (!myid) {
+            cerr << "posterior predictive tests in " << name << ".ppredtest\n";
+        }
+    }
+
   protected:
     int myid;
     int nprocs;
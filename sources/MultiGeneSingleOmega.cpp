@@ -17,6 +17,7 @@ class MultiGeneSingleOmegaChain : public MultiGeneChain {
     string modeltype, datafile, treefile;
     int blmode, nucmode, omegamode;
     double omegahypermean, omegahyperinvshape;
+    int subsettaxa;
 
   public:
     MultiGeneSingleOmegaModel *GetModel() {
@@ -33,10 +34,11 @@ class MultiGeneSingleOmegaChain : public MultiGeneChain {
     //! \param inuntil: maximum MCMC sample size
     //! \param name: base name for all files related to this MCMC run
     //! \param force: overwrite existing files with same name
+    //! \param insubsettaxa: run each gene over the tree restricted to its present taxa
     //! \param inmyid, int innprocs: process id and total number of MPI processes
     MultiGeneSingleOmegaChain(string indatafile, string intreefile, int inblmode, int innucmode, int inomegamode, 
                               double inomegahypermean, double inomegahyperinvshape,
-                              int inevery, int inuntil,
+                              int insubsettaxa, int inevery, int inuntil,
                               string inname, int force, int inmyid, int innprocs)
         : MultiGeneChain(inmyid, innprocs),
           modeltype("MULTIGENESINGLEOMEGA"),
@@ -47,6 +49,7 @@ class MultiGeneSingleOmegaChain : public MultiGeneChain {
         omegamode = inomegamode;
         omegahypermean = inomegahypermean;
         omegahyperinvshape = inomegahyperinvshape;
+        subsettaxa = insubsettaxa;
         every = inevery;
         until = inuntil;
         name = inname;
@@ -65,6 +68,7 @@ class MultiGeneSingleOmegaChain : public MultiGeneChain {
         model = new MultiGeneSingleOmegaModel(datafile, treefile, myid, nprocs);
         GetModel()->SetAcrossGenesModes(blmode,nucmode,omegamode);
         GetModel()->SetOmegaHyperParameters(omegahypermean,omegahyperinvshape);
+        GetModel()->SetTaxonSubsetting(subsettaxa);
         if (!myid) {
             cerr << "allocate\n";
         }
@@ -89,18 +93,15 @@ class MultiGeneSingleOmegaChain : public MultiGeneChain {
         is >> datafile >> treefile;
         is >> blmode >> nucmode >> omegamode;
         is >> omegahypermean >> omegahyperinvshape;
-        int tmp;
-        is >> tmp;
-        if (tmp) {
-            cerr << "error when reading model\n";
-            exit(1);
-        }
+        subsettaxa = 0;
+        int geneformat = MultiGeneMPIModule::ReadParamTrailer(is, {&subsettaxa});
         is >> every >> until >> size;
 
         if (modeltype == "MULTIGENESINGLEOMEGA") {
             model = new MultiGeneSingleOmegaModel(datafile, treefile, myid, nprocs);
             GetModel()->SetAcrossGenesModes(blmode,nucmode,omegamode);
             GetModel()->SetOmegaHyperParameters(omegahypermean,omegahyperinvshape);
+            GetModel()->SetTaxonSubsetting(subsettaxa);
         } else {
             cerr << "error when opening file " << name
                  << " : does not recognise model type : " << modeltype << '\n';
@@ -109,6 +110,7 @@ class MultiGeneSingleOmegaChain : public MultiGeneChain {
         if (!myid) {
             cerr << "allocate\n";
         }
+        GetModel()->SetGeneFormat(geneformat);
         GetModel()->Allocate();
         model->FromStream(is);
         if (!myid) {
@@ -128,7 +130,7 @@ class MultiGeneSingleOmegaChain : public MultiGeneChain {
             param_os << datafile << '\t' << treefile << '\n';
             param_os << blmode << '\t' << nucmode << '\t' << omegamode << '\n';
             param_os << omegahypermean << '\t' << omegahyperinvshape << '\n';
-            param_os << 0 << '\n';
+            GetModel()->WriteParamTrailer(param_os, {subsettaxa});
             param_os << every << '\t' << until << '\t' << size << '\n';
             GetModel()->MasterToStream(param_os);
         } else {
@@ -159,15 +161,16 @@ int main(int argc, char *argv[]) {
     int nprocs = 0;
 
     MPI_Init(&argc, &argv);
-    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
-    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+    MultiChainSplit(argc, argv);
+    MPI_Comm_rank(ChainComm, &myid);
+    MPI_Comm_size(ChainComm, &nprocs);
 
     MultiGeneSingleOmegaChain *chain = 0;
     string name = "";
 
     // starting a chain from existing files
     if (argc == 2 && argv[1][0] != '-') {
-        name = argv[1];
+        name = MultiChainName(argv[1]);
         chain = new MultiGeneSingleOmegaChain(name, myid, nprocs);
     }
 
@@ -183,6 +186,7 @@ int main(int argc, char *argv[]) {
         int omegamode = 1;
         double omegahypermean = 1.0;
         double omegahyperinvshape = 1.0;
+        int subsettaxa = 0;
 
         try {
             if (argc == 1) {
@@ -236,6 +240,8 @@ int main(int argc, char *argv[]) {
                         cerr << "error: does not recongnize command after -bl\n";
                         exit(1);
                     }
+                } else if (s == "-subsettaxa") {
+                    subsettaxa = 1;
                 } else if ((s == "-x") || (s == "-extract")) {
                     i++;
                     if (i == argc) throw(0);
@@ -247,7 +253,7 @@ int main(int argc, char *argv[]) {
                     if (i != (argc - 1)) {
                         throw(0);
                     }
-                    name = argv[i];
+                    name = MultiChainName(argv[i]);
                 }
                 i++;
             }
@@ -256,12 +262,16 @@ int main(int argc, char *argv[]) {
             }
         } catch (...) {
             cerr << "globom -d <alignment> -t <tree> <chainname> \n";
+            cerr << "\t-subsettaxa: run each gene over the tree restricted to its present taxa\n";
+            cerr << "\t             (only in multigeneglobom; other multi-gene programs reject it)\n";
+            cerr << "\t-nchain <k>: run k independent chains (<chainname>_0 to <chainname>_<k-1>) "
+                    "in one job, each over np/k processes with its own copy of the data\n";
             cerr << '\n';
             exit(1);
         }
 
         chain = new MultiGeneSingleOmegaChain(datafile, treefile, blmode, nucmode, omegamode, omegahypermean, omegahyperinvshape,
-                                              every, until, name, force, myid,
+                                              subsettaxa, every, until, name, force, myid,
                                               nprocs);
     }
 
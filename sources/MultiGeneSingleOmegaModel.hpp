@@ -41,6 +41,10 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
     int nucmode;
     int omegamode;
 
+    // whether genes run over the tree restricted to their present taxa
+    // (see SingleOmegaModel constructor)
+    bool subsettaxa;
+
     // Branch lengths
 
     double lambda;
@@ -104,6 +108,7 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
         blmode = 1;
         nucmode = 1;
         omegamode = 1;
+        subsettaxa = false;
 
         AllocateAlignments(datafile);
         treefile = intreefile;
@@ -184,12 +189,17 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
         } else {
             geneprocess.assign(GetLocalNgene(), (SingleOmegaModel *)0);
 
-            for (int gene = 0; gene < GetLocalNgene(); gene++) {
-                geneprocess[gene] = new SingleOmegaModel(GetLocalGeneName(gene), treefile);
-                geneprocess[gene]->SetAcrossGenesModes(blmode, nucmode);
-                geneprocess[gene]->Allocate();
-            }
+            SlaveConstructGenes(
+                geneprocess,
+                [&](int gene) {
+                    return new SingleOmegaModel(GetLocalGeneName(gene), treefile, subsettaxa);
+                },
+                [&](int gene) {
+                    geneprocess[gene]->SetAcrossGenesModes(blmode, nucmode);
+                    geneprocess[gene]->Allocate();
+                });
         }
+        ReportStartupTime();
     }
 
     // called upon constructing the model
@@ -202,6 +212,14 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
         omegamode = inomegamode;
     }
 
+    //! \brief restrict each gene to the taxa present in its alignment
+    //!
+    //! called upon constructing the model (before Allocate). Genes with absent
+    //! taxa then sample their substitution histories over the tree restricted
+    //! to their present taxa, their branch lengths (and suff stats) being still
+    //! defined over the whole tree, so that nothing changes on the master side.
+    void SetTaxonSubsetting(bool insubsettaxa) { subsettaxa = insubsettaxa; }
+
     void SetOmegaHyperParameters(double inomegahypermean, double inomegahyperinvshape)  {
         omegahypermean = inomegahypermean;
         omegahyperinvshape = inomegahyperinvshape;
@@ -319,11 +337,7 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
         GenePostPred(name);
     }
 
-    void GenePostPred(string name) {
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            geneprocess[gene]->PostPred(name + GetLocalGeneName(gene));
-        }
-    }
+    ProbModel *GetLocalGeneModel(int gene) override { return geneprocess[gene]; }
 
     CodonStateSpace *GetCodonStateSpace() const {
         return (CodonStateSpace *)refcodondata->GetStateSpace();
@@ -691,41 +705,76 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
     // all methods starting with Gene are called only be slaves, and do some work
     // across all genes allocated to that slave
 
+    // at each rep, the suff stats for omega, branch lengths and nuc rates are
+    // all computed by the slaves before any of the corresponding (hyper)parameters
+    // is updated by the master, and are therefore exchanged in a single round
+    // trip (see MultiGeneMPIModule::BeginPack)
+
+    //! whether anything is exchanged between master and slaves at each rep
+    bool HasGlobalExchange() const { return (omegamode == 1) || blmode || nucmode; }
+
     void MasterMove() override {
         int nrep = 30;
 
         for (int rep = 0; rep < nrep; rep++) {
+            if (!HasGlobalExchange()) {
+                continue;
+            }
+
+            BeginUnpack();
             if (omegamode == 1) {
                 MasterReceiveOmega();
+            }
+            if (blmode == 2) {
+                MasterReceiveBranchLengthsSuffStat();
+            } else if (blmode == 1) {
+                MasterReceiveBranchLengthsHyperSuffStat();
+            }
+            if (nucmode == 2) {
+                MasterReceiveNucPathSuffStat();
+            } else if (nucmode == 1) {
+                MasterReceiveNucRatesHyperSuffStat();
+            }
+            EndUnpack();
+
+            if (omegamode == 1) {
                 MoveOmegaHyperParameters();
-                MasterSendOmegaHyperParameters();
             }
 
             // global branch lengths, or gene branch lengths hyperparameters
             if (blmode == 2) {
-                MasterReceiveBranchLengthsSuffStat();
                 ResampleBranchLengths();
                 MoveLambda();
-                MasterSendGlobalBranchLengths();
             } else if (blmode == 1) {
-                MasterReceiveBranchLengthsHyperSuffStat();
                 MoveBranchLengthsHyperParameters();
-                MasterSendBranchLengthsHyperParameters();
             }
 
             // global nucrates, or gene nucrates hyperparameters
             if (nucmode == 2) {
-                MasterReceiveNucPathSuffStat();
                 MoveNucRates();
-                MasterSendGlobalNucRates();
             } else if (nucmode == 1) {
-                MasterReceiveNucRatesHyperSuffStat();
                 MoveNucRatesHyperParameters();
+            }
+
+            BeginPack();
+            if (omegamode == 1) {
+                MasterSendOmegaHyperParameters();
+            }
+            if (blmode == 2) {
+                MasterSendGlobalBranchLengths();
+            } else if (blmode == 1) {
+                MasterSendBranchLengthsHyperParameters();
+            }
+            if (nucmode == 2) {
+                MasterSendGlobalNucRates();
+            } else if (nucmode == 1) {
                 MasterSendNucRatesHyperParameters();
             }
+            EndPack();
         }
 
         // collect current state
+        BeginUnpack();
         if (blmode != 2) {
             MasterReceiveGeneBranchLengths();
         }
@@ -734,6 +783,7 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
         }
         MasterReceiveOmega();
         MasterReceiveLogProbs();
+        EndUnpack();
     }
 
     // slave move
@@ -746,31 +796,47 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
 
             MoveGeneParameters(1.0);
 
+            if (!HasGlobalExchange()) {
+                continue;
+            }
+
+            BeginPack();
             if (omegamode == 1) {
                 SlaveSendOmega();
-                SlaveReceiveOmegaHyperParameters();
             }
+            if (blmode == 2) {
+                SlaveSendBranchLengthsSuffStat();
+            } else if (blmode == 1) {
+                SlaveSendBranchLengthsHyperSuffStat();
+            }
+            if (nucmode == 2) {
+                SlaveSendNucPathSuffStat();
+            } else if (nucmode == 1) {
+                SlaveSendNucRatesHyperSuffStat();
+            }
+            EndPack();
 
+            BeginUnpack();
+            if (omegamode == 1) {
+                SlaveReceiveOmegaHyperParameters();
+            }
             // global branch lengths, or gene branch lengths hyperparameters
             if (blmode == 2) {
-                SlaveSendBranchLengthsSuffStat();
                 SlaveReceiveGlobalBranchLengths();
             } else if (blmode == 1) {
-                SlaveSendBranchLengthsHyperSuffStat();
                 SlaveReceiveBranchLengthsHyperParameters();
             }
-
             // global nucrates, or gene nucrates hyperparameters
             if (nucmode == 2) {
-                SlaveSendNucPathSuffStat();
                 SlaveReceiveGlobalNucRates();
             } else if (nucmode == 1) {
-                SlaveSendNucRatesHyperSuffStat();
                 SlaveReceiveNucRatesHyperParameters();
             }
+            EndUnpack();
         }
 
         // collect current state
+        BeginPack();
         if (blmode != 2) {
             SlaveSendGeneBranchLengths();
         }
@@ -779,6 +845,7 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
         }
         SlaveSendOmega();
         SlaveSendLogProbs();
+        EndPack();
     }
 
     void GeneResampleSub(double frac) {
@@ -788,6 +855,7 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveGeneParameters(int nrep)   {
+        PERF_TIMER(ParameterMove);
         for (int gene = 0; gene < GetLocalNgene(); gene++) {
             geneprocess[gene]->MoveParameters(nrep);
 
@@ -804,10 +872,12 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
     // Branch lengths
 
     void ResampleBranchLengths() {
+        PERF_TIMER(BranchLengthMove);
         branchlength->GibbsResample(*lengthpathsuffstatarray);
     }
 
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &MultiGeneSingleOmegaModel::LambdaHyperLogProb,
@@ -818,6 +888,7 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveBranchLengthsHyperParameters() {
+        PERF_TIMER(HyperMove);
 
         BranchLengthsHyperScalingMove(1.0, 10);
         BranchLengthsHyperScalingMove(0.3, 10);
@@ -863,6 +934,7 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
     // Nucleotide rates
 
     void MoveNucRatesHyperParameters() {
+        PERF_TIMER(HyperMove);
         ProfileMove(nucrelratehypercenter, 1.0, 1, 10, &MultiGeneSingleOmegaModel::NucRatesHyperLogProb,
                     &MultiGeneSingleOmegaModel::NoUpdate, this);
         ProfileMove(nucrelratehypercenter, 0.3, 1, 10, &MultiGeneSingleOmegaModel::NucRatesHyperLogProb,
@@ -894,6 +966,7 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveNucRates() {
+        PERF_TIMER(NucRatesMove);
         vector<double> &nucrelrate = (*nucrelratearray)[0];
         ProfileMove(nucrelrate, 0.1, 1, 10, &MultiGeneSingleOmegaModel::NucRatesLogProb,
                     &MultiGeneSingleOmegaModel::UpdateNucMatrix, this);
@@ -912,6 +985,7 @@ class MultiGeneSingleOmegaModel : public MultiGeneProbModel {
     // Omega
 
     void MoveOmegaHyperParameters() {
+        PERF_TIMER(HyperMove);
         omegahypersuffstat.Clear();
         omegahypersuffstat.AddSuffStat(*omegaarray);
 
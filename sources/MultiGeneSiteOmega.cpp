@@ -16,6 +16,8 @@ class MultiGeneSiteOmegaChain : public MultiGeneChain {
     // Chain parameters
     string modeltype, datafile, treefile;
     int writegenedata;
+    // write gene- and site-specific output as per-process binary shards
+    int shardgenedata;
     int blmode, nucmode, omegamode;
     double omegameanhypermean, omegameanhyperinvshape;
     double omegainvshapehypermean, omegainvshapehyperinvshape;
@@ -33,13 +35,17 @@ class MultiGeneSiteOmegaChain : public MultiGeneChain {
     //! \param intreefile: name of file contaning tree
     //! \param inevery: thinning factor
     //! \param inuntil: maximum MCMC sample size
+    //! \param inwritegenedata: if 1, trace gene omegas (and dS) in separate
+    //! files; if 2, also trace site omegas
+    //! \param inshardgenedata: write those files as per-process binary shards
+    //! (see mergeshards)
     //! \param name: base name for all files related to this MCMC run
     //! \param force: overwrite existing files with same name
     //! \param inmyid, int innprocs: process id and total number of MPI processes
     MultiGeneSiteOmegaChain(string indatafile, string intreefile, int inblmode, int innucmode, int inomegamode,
                               double inomegameanhypermean, double inomegameanhyperinvshape, 
                               double inomegainvshapehypermean, double inomegainvshapehyperinvshape, 
-                              int inevery, int inuntil, int inwritegenedata,
+                              int inevery, int inuntil, int inwritegenedata, int inshardgenedata,
                               string inname, int force, int inmyid, int innprocs)
         : MultiGeneChain(inmyid, innprocs),
           modeltype("MULTIGENESITEOMEGA"),
@@ -55,6 +61,7 @@ class MultiGeneSiteOmegaChain : public MultiGeneChain {
         every = inevery;
         until = inuntil;
         writegenedata = inwritegenedata;
+        shardgenedata = inshardgenedata;
         name = inname;
         New(force);
     }
@@ -97,12 +104,8 @@ class MultiGeneSiteOmegaChain : public MultiGeneChain {
         is >> blmode >> nucmode >> omegamode;
         is >> omegameanhypermean >> omegameanhyperinvshape;
         is >> omegainvshapehypermean >> omegainvshapehyperinvshape;
-        int tmp;
-        is >> tmp;
-        if (tmp) {
-            cerr << "error when reading model\n";
-            exit(1);
-        }
+        shardgenedata = 0;
+        int geneformat = MultiGeneMPIModule::ReadParamTrailer(is, {&shardgenedata});
         is >> every >> until >> size;
 
         if (modeltype == "MULTIGENESITEOMEGA") {
@@ -117,6 +120,7 @@ class MultiGeneSiteOmegaChain : public MultiGeneChain {
         if (!myid) {
             cerr << "allocate\n";
         }
+        GetModel()->SetGeneFormat(geneformat);
         GetModel()->Allocate();
         model->FromStream(is);
         if (!myid) {
@@ -138,7 +142,7 @@ class MultiGeneSiteOmegaChain : public MultiGeneChain {
             param_os << blmode << '\t' << nucmode << '\t' << omegamode << '\n';
             param_os << omegameanhypermean << '\t' << omegameanhyperinvshape << '\n';
             param_os << omegainvshapehypermean << '\t' << omegainvshapehyperinvshape << '\n';
-            param_os << 0 << '\n';
+            GetModel()->WriteParamTrailer(param_os, {shardgenedata});
             param_os << every << '\t' << until << '\t' << size << '\n';
             GetModel()->MasterToStream(param_os);
         } else {
@@ -152,7 +156,15 @@ class MultiGeneSiteOmegaChain : public MultiGeneChain {
             exit(1);
         }
         MultiGeneChain::MakeFiles(force);
-        if (writegenedata)  {
+        if (writegenedata && shardgenedata) {
+            GetModel()->MasterMakeShardedTrace(name + ".geneom", false);
+            if (blmode != 2) {
+                GetModel()->MasterMakeShardedTrace(name + ".geneds", false);
+            }
+            if (writegenedata == 2) {
+                GetModel()->MasterMakeShardedTrace(name + ".siteom", true);
+            }
+        } else if (writegenedata)  {
             ofstream os((name + ".geneom").c_str());
             if (blmode != 2)    {    
                 ofstream os((name + ".geneds").c_str());
@@ -165,6 +177,30 @@ class MultiGeneSiteOmegaChain : public MultiGeneChain {
 
     void SavePoint() override {
         MultiGeneChain::SavePoint();
+        if (shardgenedata) {
+            if (writegenedata) {
+                if (!myid) {
+                    GetModel()->MasterShardedTrace(name + ".geneom", false);
+                    if (blmode != 2) {
+                        GetModel()->MasterShardedTrace(name + ".geneds", false);
+                    }
+                } else {
+                    GetModel()->SlaveShardOmega(name + ".geneom");
+                    if (blmode != 2) {
+                        GetModel()->SlaveShardedS(name + ".geneds");
+                    }
+                }
+            }
+            if (writegenedata == 2) {
+                if (!myid) {
+                    GetModel()->MasterShardedTrace(name + ".siteom", true);
+                } else {
+                    GetModel()->SlaveShardSiteOmega(name + ".siteom");
+                }
+            }
+            return;
+        }
+
         if (writegenedata)  {
             if (!myid) {
                 ofstream os((name + ".geneom").c_str(), ios_base::app);
@@ -191,15 +227,16 @@ int main(int argc, char *argv[]) {
     int nprocs = 0;
 
     MPI_Init(&argc, &argv);
-    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
-    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+    MultiChainSplit(argc, argv);
+    MPI_Comm_rank(ChainComm, &myid);
+    MPI_Comm_size(ChainComm, &nprocs);
 
     MultiGeneSiteOmegaChain *chain = 0;
     string name = "";
 
     // starting a chain from existing files
     if (argc == 2 && argv[1][0] != '-') {
-        name = argv[1];
+        name = MultiChainName(argv[1]);
         chain = new MultiGeneSiteOmegaChain(name, myid, nprocs);
     }
 
@@ -218,6 +255,7 @@ int main(int argc, char *argv[]) {
         double omegainvshapehypermean = 1.0;
         double omegainvshapehyperinvshape = 1.0;
         int writegenedata = 1;
+        int shardgenedata = 0;
 
         try {
             if (argc == 1) {
@@ -234,6 +272,9 @@ int main(int argc, char *argv[]) {
                 } else if ((s == "-t") || (s == "-T")) {
                     i++;
                     treefile = argv[i];
+                } else if (s == "-subsettaxa") {
+                    cerr << "error: -subsettaxa is only available in multigeneglobom\n";
+                    exit(1);
                 } else if (s == "-f") {
                     force = 1;
                 } else if (s == "-omega") {
@@ -281,6 +322,8 @@ int main(int argc, char *argv[]) {
                     writegenedata = 1;
                 } else if (s == "+G") {
                     writegenedata = 2;
+                } else if (s == "-shard") {
+                    shardgenedata = 1;
                 } else if ((s == "-x") || (s == "-extract")) {
                     i++;
                     if (i == argc) throw(0);
@@ -292,7 +335,7 @@ int main(int argc, char *argv[]) {
                     if (i != (argc - 1)) {
                         throw(0);
                     }
-                    name = argv[i];
+                    name = MultiChainName(argv[i]);
                 }
                 i++;
             }
@@ -301,13 +344,15 @@ int main(int argc, char *argv[]) {
             }
         } catch (...) {
             cerr << "globom -d <alignment> -t <tree> <chainname> \n";
+            cerr << "\t-nchain <k>: run k independent chains (<chainname>_0 to <chainname>_<k-1>) "
+                    "in one job, each over np/k processes with its own copy of the data\n";
             cerr << '\n';
             exit(1);
         }
 
         chain = new MultiGeneSiteOmegaChain(datafile, treefile, blmode, nucmode, omegamode,
                                               omegameanhypermean, omegameanhyperinvshape, omegainvshapehypermean, omegainvshapehyperinvshape,
-                                              every, until, writegenedata, name, force, myid,
+                                              every, until, writegenedata, shardgenedata, name, force, myid,
                                               nprocs);
     }
 
@@ -216,20 +216,23 @@ class MultiGeneSiteOmegaModel : public MultiGeneProbModel {
                         cerr << "error: alignment not allocated\n";
                         exit(1);
                     }
-                    geneprocess[gene] = new SiteOmegaModel(alivector[gene], tree);
-                }
-            }
-            else    {
-                for (int gene = 0; gene < GetLocalNgene(); gene++) {
-                    geneprocess[gene] = new SiteOmegaModel(GetLocalGeneName(gene), treefile);
                 }
             }
 
-            for (int gene = 0; gene < GetLocalNgene(); gene++) {
-                geneprocess[gene]->SetAcrossGenesModes(blmode, nucmode);
-                geneprocess[gene]->Allocate();
-            }
+            SlaveConstructGenes(
+                geneprocess,
+                [&](int gene) {
+                    if (alivector.size()) {
+                        return new SiteOmegaModel(alivector[gene], tree);
+                    }
+                    return new SiteOmegaModel(GetLocalGeneName(gene), treefile);
+                },
+                [&](int gene) {
+                    geneprocess[gene]->SetAcrossGenesModes(blmode, nucmode);
+                    geneprocess[gene]->Allocate();
+                });
         }
+        ReportStartupTime();
     }
 
     // called upon constructing the model
@@ -369,11 +372,7 @@ class MultiGeneSiteOmegaModel : public MultiGeneProbModel {
         GenePostPred(name);
     }
 
-    void GenePostPred(string name) {
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            geneprocess[gene]->PostPred(name + GetLocalGeneName(gene));
-        }
-    }
+    ProbModel *GetLocalGeneModel(int gene) override { return geneprocess[gene]; }
 
     CodonStateSpace *GetCodonStateSpace() const {
         return (CodonStateSpace *)refcodondata->GetStateSpace();
@@ -602,7 +601,7 @@ class MultiGeneSiteOmegaModel : public MultiGeneProbModel {
             int totnsite = GetSlaveTotNsite(proc);
             double *array = new double[totnsite];
             MPI_Status stat;
-            MPI_Recv(array, totnsite, MPI_DOUBLE, proc, TAG1, MPI_COMM_WORLD, &stat);
+            MPI_Recv(array, totnsite, MPI_DOUBLE, proc, TAG1, ChainComm, &stat);
 
             int i = 0;
             for (int gene = 0; gene < Ngene; gene++) {
@@ -626,9 +625,16 @@ class MultiGeneSiteOmegaModel : public MultiGeneProbModel {
     }
 
     void SlaveTraceSiteOmega() {
+        double *array = new double[GetLocalTotNsite()];
+        GetLocalSiteOmega(array);
+        MPI_Send(array, GetLocalTotNsite(), MPI_DOUBLE, 0, TAG1, ChainComm);
+        delete[] array;
+    }
+
+    //! site omegas of all local genes, concatenated (slave side)
+    void GetLocalSiteOmega(double *array) const {
         int ngene = GetLocalNgene();
         int totnsite = GetLocalTotNsite();
-        double *array = new double[totnsite];
         int i = 0;
         for (int gene = 0; gene < ngene; gene++) {
             geneprocess[gene]->GetSiteOmega(array + i);
@@ -643,13 +649,35 @@ class MultiGeneSiteOmegaModel : public MultiGeneProbModel {
             i += GetLocalGeneNsite(gene);
         }
         if (i != totnsite) {
-            cerr << "error in MultiGeneCodonM2aModel::SlaveTraceSiteOmega: non "
+            cerr << "error in MultiGeneSiteOmegaModel::GetLocalSiteOmega: non "
                     "matching number of sites\n";
             exit(1);
         }
+    }
 
-        MPI_Send(array, totnsite, MPI_DOUBLE, 0, TAG1, MPI_COMM_WORLD);
-        delete[] array;
+    // sharded versions of TraceOmega, TracedS and of the site omega trace,
+    // slave side (see MultiGeneProbModel::MasterMakeShardedTrace)
+
+    void SlaveShardOmega(string filename) {
+        std::vector<double> values(GetLocalNgene());
+        for (int gene = 0; gene < GetLocalNgene(); gene++) {
+            values[gene] = omegaarray->GetVal(gene);
+        }
+        SlaveShardedTrace(filename, false, values);
+    }
+
+    void SlaveShardedS(string filename) {
+        std::vector<double> values(GetLocalNgene());
+        for (int gene = 0; gene < GetLocalNgene(); gene++) {
+            values[gene] = branchlengtharray->GetVal(gene).GetTotalLength();
+        }
+        SlaveShardedTrace(filename, false, values);
+    }
+
+    void SlaveShardSiteOmega(string filename) {
+        std::vector<double> values(GetLocalTotNsite());
+        GetLocalSiteOmega(values.data());
+        SlaveShardedTrace(filename, true, values);
     }
 
     //-------------------
@@ -940,6 +968,7 @@ class MultiGeneSiteOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveGeneParameters(int nrep)   {
+        PERF_TIMER(ParameterMove);
         for (int gene = 0; gene < GetLocalNgene(); gene++) {
             geneprocess[gene]->MoveParameters(nrep);
 
@@ -959,10 +988,12 @@ class MultiGeneSiteOmegaModel : public MultiGeneProbModel {
     // Branch lengths
 
     void ResampleBranchLengths() {
+        PERF_TIMER(BranchLengthMove);
         branchlength->GibbsResample(*lengthpathsuffstatarray);
     }
 
     void ResampleGeneBranchLengths()   {
+        PERF_TIMER(BranchLengthMove);
         for (int gene = 0; gene < GetLocalNgene(); gene++) {
             geneprocess[gene]->ResampleBranchLengths();
             geneprocess[gene]->GetBranchLengths((*branchlengtharray)[gene]);
@@ -970,6 +1001,7 @@ class MultiGeneSiteOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &MultiGeneSiteOmegaModel::LambdaHyperLogProb,
@@ -980,6 +1012,7 @@ class MultiGeneSiteOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveBranchLengthsHyperParameters() {
+        PERF_TIMER(HyperMove);
 
         BranchLengthsHyperScalingMove(1.0, 10);
         BranchLengthsHyperScalingMove(0.3, 10);
@@ -1025,6 +1058,7 @@ class MultiGeneSiteOmegaModel : public MultiGeneProbModel {
     // Nucleotide rates
 
     void MoveNucRatesHyperParameters() {
+        PERF_TIMER(HyperMove);
         ProfileMove(nucrelratehypercenter, 1.0, 1, 10, &MultiGeneSiteOmegaModel::NucRatesHyperLogProb,
                     &MultiGeneSiteOmegaModel::NoUpdate, this);
         ProfileMove(nucrelratehypercenter, 0.3, 1, 10, &MultiGeneSiteOmegaModel::NucRatesHyperLogProb,
@@ -1056,6 +1090,7 @@ class MultiGeneSiteOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveNucRates() {
+        PERF_TIMER(NucRatesMove);
         vector<double> &nucrelrate = (*nucrelratearray)[0];
         ProfileMove(nucrelrate, 0.1, 1, 10, &MultiGeneSiteOmegaModel::NucRatesLogProb,
                     &MultiGeneSiteOmegaModel::UpdateNucMatrix, this);
@@ -1074,6 +1109,7 @@ class MultiGeneSiteOmegaModel : public MultiGeneProbModel {
     // Omega
 
     void MoveOmegaHyperParameters() {
+        PERF_TIMER(HyperMove);
         omegameanhypersuffstat.Clear();
         omegameanhypersuffstat.AddSuffStat(*omegameanarray);
 
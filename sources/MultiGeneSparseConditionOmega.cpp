@@ -73,12 +73,7 @@ class MultiGeneSparseConditionOmegaChain : public MultiGeneChain {
         is >> ncond >> nlevel;
         is >> pipos >> pineg;
         is >> blmode >> nucmode;
-        int tmp;
-        is >> tmp;
-        if (tmp) {
-	    cerr << "error when reading model\n";
-	    exit(1);
-        }
+        int geneformat = MultiGeneMPIModule::ReadParamTrailer(is, {});
         is >> every >> until >> size;
 
         if (modeltype == "MULTIGENESPARSECONDOMEGA") {
@@ -91,6 +86,7 @@ class MultiGeneSparseConditionOmegaChain : public MultiGeneChain {
             exit(1);
         }
 
+        GetModel()->SetGeneFormat(geneformat);
         GetModel()->Allocate();
         GetModel()->FromStream(is);
         GetModel()->Update();
@@ -108,7 +104,7 @@ class MultiGeneSparseConditionOmegaChain : public MultiGeneChain {
             param_os << ncond << '\t' << nlevel << '\n';
             param_os << pipos << '\t' << pineg << '\n';
 	    param_os << blmode << '\t' << nucmode << '\n';
-            param_os << 0 << '\n';
+            GetModel()->WriteParamTrailer(param_os, {});
             param_os << every << '\t' << until << '\t' << size << '\n';
             GetModel()->MasterToStream(param_os);
         } else {
@@ -144,8 +140,9 @@ int main(int argc, char *argv[]) {
     int nprocs = 0;
 
     MPI_Init(&argc, &argv);
-    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
-    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+    MultiChainSplit(argc, argv);
+    MPI_Comm_rank(ChainComm, &myid);
+    MPI_Comm_size(ChainComm, &nprocs);
 
     if (nprocs <= 1) {
         cerr << "error: should run the program with at least 2 cores\n";
@@ -157,7 +154,7 @@ int main(int argc, char *argv[]) {
 
     // starting a chain from existing files
     if (argc == 2 && argv[1][0] != '-') {
-        name = argv[1];
+        name = MultiChainName(argv[1]);
         chain = new MultiGeneSparseConditionOmegaChain(name, myid, nprocs);
     }
 
@@ -190,6 +187,9 @@ int main(int argc, char *argv[]) {
                 } else if ((s == "-t") || (s == "-T")) {
                     i++;
                     treefile = argv[i];
+                } else if (s == "-subsettaxa") {
+                    cerr << "error: -subsettaxa is only available in multigeneglobom\n";
+                    exit(1);
                 } else if (s == "-f") {
                     force = 1;
                 } else if (s == "-ncond") {
@@ -239,7 +239,7 @@ int main(int argc, char *argv[]) {
                     if (i != (argc - 1)) {
                         throw(0);
                     }
-                    name = argv[i];
+                    name = MultiChainName(argv[i]);
                 }
                 i++;
             }
@@ -248,6 +248,8 @@ int main(int argc, char *argv[]) {
             }
         } catch (...) {
             cerr << "globom -d <alignment> -t <tree> <chainname> \n";
+            cerr << "\t-nchain <k>: run k independent chains (<chainname>_0 to <chainname>_<k-1>) "
+                    "in one job, each over np/k processes with its own copy of the data\n";
             cerr << '\n';
             exit(1);
         }
@@ -319,13 +319,17 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
         } else {
             geneprocess.assign(GetLocalNgene(), (SparseConditionOmegaModel *)0);
 
-            for (int gene = 0; gene < GetLocalNgene(); gene++) {
-                geneprocess[gene] =
-                    new SparseConditionOmegaModel(GetLocalGeneName(gene), treefile, Ncond, Nlevel);
-                geneprocess[gene]->SetAcrossGenesModes(blmode, nucmode);
-                geneprocess[gene]->Allocate();
-            }
+            SlaveConstructGenes(
+                geneprocess,
+                [&](int gene) {
+                    return new SparseConditionOmegaModel(GetLocalGeneName(gene), treefile, Ncond, Nlevel);
+                },
+                [&](int gene) {
+                    geneprocess[gene]->SetAcrossGenesModes(blmode, nucmode);
+                    geneprocess[gene]->Allocate();
+                });
         }
+        ReportStartupTime();
     }
 
     // called upon constructing the model
@@ -754,11 +758,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
         GenePostPred(name);
     }
 
-    void GenePostPred(string name) {
-        for (int gene = 0; gene < GetLocalNgene(); gene++) {
-            geneprocess[gene]->PostPred(name + GetLocalGeneName(gene));
-        }
-    }
+    ProbModel *GetLocalGeneModel(int gene) override { return geneprocess[gene]; }
 
     void TouchNucMatrix() {
         nucmatrix->CopyStationary((*nucstatarray)[0]);
@@ -1190,10 +1190,12 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     // Branch lengths
 
     void ResampleBranchLengths() {
+        PERF_TIMER(BranchLengthMove);
         branchlength->GibbsResample(*lengthpathsuffstatarray);
     }
 
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &MultiGeneSparseConditionOmegaModel::LambdaHyperLogProb,
@@ -1204,6 +1206,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveBranchLengthsHyperParameters() {
+        PERF_TIMER(HyperMove);
 
         BranchLengthsHyperScalingMove(1.0, 10);
         BranchLengthsHyperScalingMove(0.3, 10);
@@ -1249,6 +1252,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     // Nucleotide rates
 
     void MoveNucRatesHyperParameters() {
+        PERF_TIMER(HyperMove);
         ProfileMove(nucrelratehypercenter, 1.0, 1, 10, &MultiGeneSparseConditionOmegaModel::NucRatesHyperLogProb,
                     &MultiGeneSparseConditionOmegaModel::NoUpdate, this);
         ProfileMove(nucrelratehypercenter, 0.3, 1, 10, &MultiGeneSparseConditionOmegaModel::NucRatesHyperLogProb,
@@ -1280,6 +1284,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveNucRates() {
+        PERF_TIMER(NucRatesMove);
         vector<double> &nucrelrate = (*nucrelratearray)[0];
         ProfileMove(nucrelrate, 0.1, 1, 10, &MultiGeneSparseConditionOmegaModel::NucRatesLogProb,
                     &MultiGeneSparseConditionOmegaModel::TouchNucMatrix, this);
@@ -1469,6 +1474,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveOmegaHyperParameters(int nrep) {
+        PERF_TIMER(HyperMove);
 
         if (burnin <= 10)   {
             GammaResampleGeneW();
@@ -1518,6 +1524,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     }
 
     void ResamplePi()   {
+        PERF_TIMER(HyperMove);
         for (int cond=0; cond<Ncond; cond++)    {
             int count[3];
             count[0] = count[1] = count[2] = 0;
@@ -1552,6 +1559,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     }
 
     double MoveDevPos(double tuning, int nrep)  {
+        PERF_TIMER(OmegaMove);
         double nacc = 0;
         double ntot = 0;
         for (int gene=0; gene<GetNgene(); gene++)    {
@@ -1575,6 +1583,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     }
 
     double MoveDevNeg(double tuning, int nrep)  {
+        PERF_TIMER(OmegaMove);
         double nacc = 0;
         double ntot = 0;
         for (int gene=0; gene<GetNgene(); gene++)    {
@@ -1598,6 +1607,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     }
 
     double MoveCondV(double tuning, int nrep) {
+        PERF_TIMER(OmegaMove);
         double nacc = 0;
         for (int rep = 0; rep < nrep; rep++) {
             for (int j = 1; j < GetNcond(); j++) {
@@ -1621,6 +1631,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     }
 
     double MoveGeneW(double tuning, int nrep) {
+        PERF_TIMER(OmegaMove);
         double nacc = 0;
         for (int rep = 0; rep < nrep; rep++) {
             for (int i = 0; i < GetNgene(); i++) {
@@ -1644,6 +1655,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveDevPosHyperParams(double tuning, int nrep) {
+        PERF_TIMER(HyperMove);
         devposhypersuffstat->Clear();
         devposhypersuffstat->AddSuffStat(*devpos);
 
@@ -1660,6 +1672,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveDevNegHyperParams(double tuning, int nrep) {
+        PERF_TIMER(HyperMove);
         devneghypersuffstat->Clear();
         devneghypersuffstat->AddSuffStat(*devneg);
 
@@ -1676,6 +1689,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveCondVHyperParams(double tuning, int nrep) {
+        PERF_TIMER(HyperMove);
         hypercondvsuffstat.Clear();
         hypercondvsuffstat.AddSuffStat(*condvarray);
 
@@ -1691,6 +1705,7 @@ class MultiGeneSparseConditionOmegaModel : public MultiGeneProbModel {
     }
 
     void MoveGeneWHyperParams(double tuning, int nrep) {
+        PERF_TIMER(HyperMove);
         hypergenewsuffstat.Clear();
         hypergenewsuffstat.AddSuffStat(*genewarray);
 
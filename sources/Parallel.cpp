@@ -0,0 +1,106 @@
+#include "Parallel.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "Random.hpp"
+using namespace std;
+
+MPI_Comm ChainComm = MPI_COMM_WORLD;
+
+static int nchain = 1;
+static int chainid = 0;
+static int nthread = 1;
+
+int MultiChainSplit(int &argc, char *argv[]) {
+    int worldid, worldsize;
+    MPI_Comm_rank(MPI_COMM_WORLD, &worldid);
+    MPI_Comm_size(MPI_COMM_WORLD, &worldsize);
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-nchain")) {
+            if (i == argc - 1) {
+                if (!worldid) {
+                    cerr << "error: -nchain should be followed by a number of chains\n";
+                }
+                exit(1);
+            }
+            nchain = atoi(argv[i + 1]);
+            for (int j = i + 2; j < argc; j++) {
+                argv[j - 2] = argv[j];
+            }
+            argc -= 2;
+            argv[argc] = nullptr;
+            break;
+        }
+    }
+
+    if ((nchain <= 0) || ((nchain > 1) && ((worldsize % nchain) || (worldsize / nchain < 2)))) {
+        if (!worldid) {
+            cerr << "error: cannot split " << worldsize << " processes into " << nchain
+                 << " chains (each chain needs a master and at least one slave, and all chains "
+                    "the same number of processes)\n";
+        }
+        exit(1);
+    }
+
+    if (nchain > 1) {
+        chainid = worldid / (worldsize / nchain);
+        MPI_Comm_split(MPI_COMM_WORLD, chainid, worldid, &ChainComm);
+        // chain 0 keeps the seed it would have in a single-chain run
+        if (chainid) {
+            Random::InitRandom(Random::GetSeed() + 1000003 * chainid);
+        }
+    }
+
+    // cores available to this process
+    MPI_Comm nodecomm;
+    int nlocal;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &nodecomm);
+    MPI_Comm_size(nodecomm, &nlocal);
+    MPI_Comm_free(&nodecomm);
+    nthread = std::thread::hardware_concurrency() / nlocal;
+    if (nthread < 1) {
+        nthread = 1;
+    }
+    return chainid;
+}
+
+string MultiChainName(string name) {
+    if (nchain == 1) {
+        return name;
+    }
+    ostringstream s;
+    s << name << '_' << chainid;
+    return s.str();
+}
+
+int GetLocalNthread() { return nthread; }
+
+void ThreadedFor(int n, const std::function<void(int)> &f) {
+    int nworker = (nthread < n) ? nthread : n;
+    if (nworker <= 1) {
+        for (int i = 0; i < n; i++) {
+            f(i);
+        }
+        return;
+    }
+    // items are handed out one at a time, as their costs can be very uneven
+    std::atomic<int> next(0);
+    auto work = [&]() {
+        for (int i = next++; i < n; i = next++) {
+            f(i);
+        }
+    };
+    std::vector<std::thread> thread;
+    for (int t = 1; t < nworker; t++) {
+        thread.emplace_back(work);
+    }
+    work();
+    for (auto &t : thread) {
+        t.join();
+    }
+}
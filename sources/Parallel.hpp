@@ -20,10 +20,46 @@ copy of the GNU General Public License along with PhyloBayes. If not, see
 #ifndef __PARALLELH
 #define __PARALLELH
 
+#include <functional>
+#include <string>
 #include "mpi.h"
 
 const int TAG1 = 97;
 
+//! communicator of the processes running the current chain: MPI_COMM_WORLD,
+//! unless the job was split into several chains (see MultiChainSplit)
+extern MPI_Comm ChainComm;
+
+//! \brief split the job into several independent chains, if requested by a
+//! -nchain <k> option on the command line
+//!
+//! To be called just after MPI_Init. The option is removed from argc/argv.
+//! Processes are split into k contiguous groups of equal size, each of which
+//! runs its own chain (a master and its slaves) over ChainComm, named
+//! <chainname>_<i> (see MultiChainName), with its own random seed. Chains
+//! share nothing but the MPI job: each process reads and holds its own copy
+//! of the data, so that k chains take as much memory as k separate runs. The
+//! point is to run several replicates with one submission, filling the nodes.
+//! Also counts the processes running on each node (see GetLocalNthread).
+//! Returns the index of the chain of the calling process (0 if no split).
+int MultiChainSplit(int &argc, char *argv[]);
+
+//! name of the chain run by the calling process: name itself, or name_<i> if
+//! the job was split into several chains
+std::string MultiChainName(std::string name);
+
+//! number of threads for the calling process: the cores of its node, divided
+//! by the number of MPI processes running on that node (as determined by
+//! MultiChainSplit; 1 if MultiChainSplit was not called)
+int GetLocalNthread();
+
+//! \brief call f(i) for i = 0..n-1, distributed over GetLocalNthread() threads
+//!
+//! For startup work only (reading alignments, allocating gene models): f
+//! should not use the random number generator, or any other process-global
+//! state.
+void ThreadedFor(int n, const std::function<void(int)> &f);
+
 enum MESSAGE { KILL };
 
 struct prop_arg {
@@ -121,9 +121,8 @@ class PathSuffStat : public SuffStat {
     //! return log p(S | Q) as a function of the Q matrix given as the argument
     double GetLogProb(const SubMatrix &mat) const {
         double total = 0;
-        auto stat = mat.GetStationary();
         for (std::map<int, int>::const_iterator i = rootcount.begin(); i != rootcount.end(); i++) {
-            total += i->second * log(stat[i->first]);
+            total += i->second * mat.LogStationary(i->first);
         }
         for (std::map<int, double>::const_iterator i = waitingtime.begin(); i != waitingtime.end();
              i++) {
@@ -131,7 +130,7 @@ class PathSuffStat : public SuffStat {
         }
         for (std::map<pair<int, int>, int>::const_iterator i = paircount.begin();
              i != paircount.end(); i++) {
-            total += i->second * log(mat(i->first.first, i->first.second));
+            total += i->second * mat.LogRate(i->first.first, i->first.second);
         }
         return total;
     }
@@ -223,21 +222,14 @@ class PathSuffStatNodeArray : public SimpleNodeArray<PathSuffStat> {
     //! matrices
     double GetLogProb(const BranchSelector<SubMatrix> &matrixarray,
                       const SubMatrix &rootmatrix) const {
-        double ret = RecursiveGetLogProb(GetTree().GetRoot(), matrixarray, rootmatrix);
-        return ret;
-    }
-
-    double RecursiveGetLogProb(const Link *from, const BranchSelector<SubMatrix> &matrixarray,
-                               const SubMatrix &rootmatrix) const {
         double total = 0;
-        if (from->isRoot()) {
-            total += GetVal(from->GetNode()->GetIndex()).GetLogProb(rootmatrix);
-        } else {
-            total += GetVal(from->GetNode()->GetIndex())
-                         .GetLogProb(matrixarray.GetVal(from->GetBranch()->GetIndex()));
-        }
-        for (const Link *link = from->Next(); link != from; link = link->Next()) {
-            total += RecursiveGetLogProb(link->Out(), matrixarray, rootmatrix);
+        for (int node : GetTree().GetPreorder()) {
+            int branch = GetTree().GetNodeBranch(node);
+            if (branch == -1) {
+                total += GetVal(node).GetLogProb(rootmatrix);
+            } else {
+                total += GetVal(node).GetLogProb(matrixarray.GetVal(branch));
+            }
         }
         return total;
     }
@@ -0,0 +1,109 @@
+#include "PerfCounters.hpp"
+#include "Parallel.hpp"
+#include "PhyloProcess.hpp"
+#include "SubMatrix.hpp"
+
+const char *PerfCounters::name[Ntimer] = {
+    "sliding move",  "scaling move",   "profile move", "parameter cycle", "branch lengths",
+    "nuc rates",     "omega",          "aa fitness",   "mixture alloc",   "base mixture",
+    "hyperparams",   "state mapping",  "sub mapping",  "log likelihood",  "postpred simu",
+    "mpi wait"};
+Chrono PerfCounters::chrono[Ntimer];
+int PerfCounters::depth[Ntimer];
+double PerfCounters::trialcount[Ntimer];
+double PerfCounters::acccount[Ntimer];
+
+bool PerfCounters::reduced = false;
+double PerfCounters::tottime[Ntimer];
+double PerfCounters::totcall[Ntimer];
+double PerfCounters::tottrial[Ntimer];
+double PerfCounters::totacc[Ntimer];
+double PerfCounters::totdiag = 0;
+double PerfCounters::totunisub = 0;
+double PerfCounters::totpath[4] = {0, 0, 0, 0};
+
+// path sampling method counts (see PhyloProcess::SamplePath)
+static void GetPathCounts(double *count) {
+    count[0] = PhyloProcess::GetRejectionPathCount();
+    count[1] = PhyloProcess::GetRejectionTrialCount();
+    count[2] = PhyloProcess::GetUniformizedPathCount();
+    count[3] = PhyloProcess::GetRejectionFailCount();
+}
+
+void PerfCounters::Reset() {
+    for (int t = 0; t < Ntimer; t++) {
+        chrono[t].Reset();
+        trialcount[t] = 0;
+        acccount[t] = 0;
+    }
+    reduced = false;
+}
+
+void PerfCounters::MPIReduce() {
+    // time, calls, trials, accepts for each timer, then diag and unisub counts,
+    // then path sampling counts
+    int n = 4 * Ntimer + 6;
+    double *local = new double[n];
+    double *tot = new double[n];
+    for (int t = 0; t < Ntimer; t++) {
+        local[4 * t] = chrono[t].GetTime();
+        local[4 * t + 1] = chrono[t].GetCount();
+        local[4 * t + 2] = trialcount[t];
+        local[4 * t + 3] = acccount[t];
+    }
+    local[4 * Ntimer] = SubMatrix::GetDiagCount();
+    local[4 * Ntimer + 1] = SubMatrix::GetUniSubCount();
+    GetPathCounts(local + 4 * Ntimer + 2);
+    MPI_Reduce(local, tot, n, MPI_DOUBLE, MPI_SUM, 0, ChainComm);
+    for (int t = 0; t < Ntimer; t++) {
+        tottime[t] = tot[4 * t];
+        totcall[t] = tot[4 * t + 1];
+        tottrial[t] = tot[4 * t + 2];
+        totacc[t] = tot[4 * t + 3];
+    }
+    totdiag = tot[4 * Ntimer];
+    totunisub = tot[4 * Ntimer + 1];
+    for (int k = 0; k < 4; k++) {
+        totpath[k] = tot[4 * Ntimer + 2 + k];
+    }
+    reduced = true;
+    delete[] local;
+    delete[] tot;
+}
+
+void PerfCounters::ToStream(ostream &os) {
+    if (!reduced) {
+        for (int t = 0; t < Ntimer; t++) {
+            tottime[t] = chrono[t].GetTime();
+            totcall[t] = chrono[t].GetCount();
+            tottrial[t] = trialcount[t];
+            totacc[t] = acccount[t];
+        }
+        totdiag = SubMatrix::GetDiagCount();
+        totunisub = SubMatrix::GetUniSubCount();
+        GetPathCounts(totpath);
+    }
+    os << '\n';
+    os << "performance counters\n";
+    os << "operation\tncall\ttime(ms)\tntrial\tacc\n";
+    for (int t = 0; t < Ntimer; t++) {
+        os << name[t] << '\t' << totcall[t] << '\t' << tottime[t] << '\t';
+        if (tottrial[t]) {
+            os << tottrial[t] << '\t' << totacc[t] / tottrial[t];
+        } else {
+            os << "-\t-";
+        }
+        os << '\n';
+    }
+    os << "diagonalizations    : " << totdiag << '\n';
+    os << "uniformization trunc: " << totunisub << '\n';
+    os << "paths by rejection  : " << totpath[0] << '\t' << "trials per path: ";
+    if (totpath[0]) {
+        os << totpath[1] / totpath[0];
+    } else {
+        os << '-';
+    }
+    os << '\n';
+    os << "paths by uniformiz. : " << totpath[2] << '\t' << "after rejection failed: " << totpath[3]
+       << '\n';
+}
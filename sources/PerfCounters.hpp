@@ -0,0 +1,125 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <iostream>
+#include "Chrono.hpp"
+using namespace std;
+
+/**
+ * \brief Global timers and counters, for profiling MCMC runs
+ *
+ * One entry per type of operation: the generic Metropolis-Hastings moves of
+ * ProbModel, the model-specific move types (branch lengths, nucleotide rates,
+ * omega, amino-acid fitness, mixture allocations, base mixture and
+ * hyperparameters, and the whole parameter cycle between two stochastic
+ * mappings), stochastic mapping and likelihood computation in PhyloProcess,
+ * posterior predictive simulation, time spent waiting for MPI messages. Each
+ * entry records total time and number of calls and, for MH moves, number of
+ * trials and of accepted proposals. The report (ToStream) also gives the number
+ * of matrix diagonalizations and of uniformization truncations counted by
+ * SubMatrix, and the usage of each path sampling method (PhyloProcess).
+ *
+ * Times are inclusive: an operation nested within another one (e.g. a scaling
+ * move within a hyperparameter move) is counted in both. Nested calls to the
+ * same entry are counted only once, at the outermost level.
+ *
+ * The code is instrumented with the PERF_TIMER and PERF_COUNT macros, which
+ * expand to nothing unless compiled with -DPERFCOUNT (make PERFCOUNT=1), in
+ * which case the report is appended to the <chainname>.monitor file. In
+ * multi-gene runs, counters are summed over all processes (MPIReduce) before
+ * being written by the master.
+ */
+
+class PerfCounters {
+  public:
+    enum Timer {
+        SlidingMove,
+        ScalingMove,
+        ProfileMove,
+        ParameterMove,
+        BranchLengthMove,
+        NucRatesMove,
+        OmegaMove,
+        FitnessMove,
+        AllocMove,
+        BaseMixtureMove,
+        HyperMove,
+        StateMapping,
+        SubMapping,
+        LogLikelihood,
+        PostPredSimu,
+        MPIWait,
+        Ntimer
+    };
+
+    //! start timer t (and count one call), unless already running
+    static void Start(Timer t) {
+        if (!depth[t]++) {
+            chrono[t].Start();
+            ++chrono[t];
+        }
+    }
+
+    //! stop timer t, once all nested calls have returned
+    static void Stop(Timer t) {
+        if (!--depth[t]) {
+            chrono[t].Stop();
+        }
+    }
+
+    //! count trials and accepted proposals of a MH move
+    static void Count(Timer t, int ntrial, int nacc) {
+        trialcount[t] += ntrial;
+        acccount[t] += nacc;
+    }
+
+    //! reset all counters
+    static void Reset();
+
+    //! sum counters over all processes (collective; result is on process 0)
+    static void MPIReduce();
+
+    //! write report (summed over processes if MPIReduce was called)
+    static void ToStream(ostream &os);
+
+  private:
+    static const char *name[Ntimer];
+    static Chrono chrono[Ntimer];
+    static int depth[Ntimer];
+    static double trialcount[Ntimer];
+    static double acccount[Ntimer];
+
+    // totals over processes (MPIReduce)
+    static bool reduced;
+    static double tottime[Ntimer];
+    static double totcall[Ntimer];
+    static double tottrial[Ntimer];
+    static double totacc[Ntimer];
+    static double totdiag;
+    static double totunisub;
+    static double totpath[4];
+};
+
+/**
+ * \brief Scoped timer: starts a PerfCounters timer on construction and stops
+ * it on destruction
+ */
+
+class PerfScope {
+  public:
+    explicit PerfScope(PerfCounters::Timer t) : timer(t) { PerfCounters::Start(timer); }
+    ~PerfScope() { PerfCounters::Stop(timer); }
+
+  private:
+    PerfCounters::Timer timer;
+};
+
+#ifdef PERFCOUNT
+#define PERF_TIMER(t) PerfScope perfscope_##t(PerfCounters::t)
+#define PERF_COUNT(t, ntrial, nacc) PerfCounters::Count(PerfCounters::t, ntrial, nacc)
+#else
+#define PERF_TIMER(t)
+#define PERF_COUNT(t, ntrial, nacc)
+#endif
+
+#endif  // PERFCOUNTERS_H
@@ -1,8 +1,18 @@
 #include "PhyloProcess.hpp"
 #include <algorithm>
+#include "Parallel.hpp"
 #include "PathSuffStat.hpp"
+#include "PoissonSuffStat.hpp"
 using namespace std;
 
+bool PhyloProcess::deferunfold = false;
+vector<PhyloProcess *> PhyloProcess::deferred;
+
+unsigned long PhyloProcess::nrejectionpath = 0;
+unsigned long PhyloProcess::nrejectiontrial = 0;
+unsigned long PhyloProcess::nrejectionfail = 0;
+unsigned long PhyloProcess::nuniformizedpath = 0;
+
 PhyloProcess::PhyloProcess(const Tree *intree, const SequenceAlignment *indata,
                            const BranchSelector<double> *inbranchlength,
                            const Selector<double> *insiterate,
@@ -18,6 +28,11 @@ PhyloProcess::PhyloProcess(const Tree *intree, const SequenceAlignment *indata,
     allocsubmatrixarray = false;
     rootsubmatrixarray = inrootsubmatrixarray;
     allocrootsubmatrixarray = false;
+    matrixmode = generic;
+    homogeneousmatrix = nullptr;
+    sitematrixarray = nullptr;
+    branchmatrixarray = nullptr;
+    storepaths = false;
 }
 
 PhyloProcess::PhyloProcess(const Tree *intree, const SequenceAlignment *indata,
@@ -34,6 +49,11 @@ PhyloProcess::PhyloProcess(const Tree *intree, const SequenceAlignment *indata,
     allocsubmatrixarray = true;
     rootsubmatrixarray = new HomogeneousSelector<SubMatrix>(GetNsite(), *insubmatrix);
     allocrootsubmatrixarray = true;
+    matrixmode = homogeneous;
+    homogeneousmatrix = insubmatrix;
+    sitematrixarray = nullptr;
+    branchmatrixarray = nullptr;
+    storepaths = false;
 }
 
 PhyloProcess::PhyloProcess(const Tree *intree, const SequenceAlignment *indata,
@@ -56,6 +76,11 @@ PhyloProcess::PhyloProcess(const Tree *intree, const SequenceAlignment *indata,
     allocsubmatrixarray = true;
     rootsubmatrixarray = insubmatrixarray;
     allocrootsubmatrixarray = false;
+    matrixmode = siteheterogeneous;
+    homogeneousmatrix = nullptr;
+    sitematrixarray = insubmatrixarray;
+    branchmatrixarray = nullptr;
+    storepaths = false;
 }
 
 PhyloProcess::PhyloProcess(const Tree *intree, const SequenceAlignment *indata,
@@ -74,6 +99,11 @@ PhyloProcess::PhyloProcess(const Tree *intree, const SequenceAlignment *indata,
     allocsubmatrixarray = true;
     rootsubmatrixarray = new HomogeneousSelector<SubMatrix>(GetNsite(), *insubmatrix);
     allocrootsubmatrixarray = true;
+    matrixmode = branchheterogeneous;
+    homogeneousmatrix = nullptr;
+    sitematrixarray = nullptr;
+    branchmatrixarray = insubmatrixbrancharray;
+    storepaths = false;
 }
 
 PhyloProcess::~PhyloProcess() {
@@ -86,43 +116,64 @@ PhyloProcess::~PhyloProcess() {
     }
 }
 
-void PhyloProcess::SetData(const SequenceAlignment *indata) { data = indata; }
+void PhyloProcess::SetData(const SequenceAlignment *indata) {
+    data = indata;
+    lnLcached = false;
+}
 
 void PhyloProcess::Unfold() {
+    if (deferunfold) {
+        deferred.push_back(this);
+    } else {
+        DoUnfold();
+    }
+}
+
+void PhyloProcess::UnfoldDeferred() {
+    ThreadedFor(deferred.size(), [](int i) { deferred[i]->DoUnfold(); });
+    deferred.clear();
+}
+
+void PhyloProcess::DoUnfold() {
     sitearray = new int[GetNsite()];
     sitelnL = new double[GetNsite()];
     for (int i = 0; i < GetNsite(); i++) {
         sitearray[i] = 1;
     }
+    lnLcached = false;
+    mixncomp = 0;
+    branchmatrix.assign(GetTree()->GetNbranch(), nullptr);
+    branchlengthtable.assign(GetTree()->GetNbranch(), 0);
+    currentrate = 1.0;
     CreateMissingMap();
     FillMissingMap();
-    RecursiveCreate(GetRoot());
-    RecursiveCreateTBL(GetRoot());
+    CreateStatesAndPaths();
+    CreateTBL();
     ClampData();
 }
 
 void PhyloProcess::Cleanup() {
     DeleteMissingMap();
-    RecursiveDeleteTBL(GetRoot());
-    RecursiveDelete(GetRoot());
+    DeleteTBL();
+    DeleteStatesAndPaths();
     delete[] sitearray;
     delete[] sitelnL;
+    DeleteMixtureCondLikelihoods();
 }
 
 void PhyloProcess::CreateMissingMap() {
-    missingmap = new int *[GetTree()->GetNnode()];
-    for (int j = 0; j < GetTree()->GetNnode(); j++) {
-        missingmap[j] = new int[GetNsite()];
-        for (int i = 0; i < GetNsite(); i++) {
-            missingmap[j][i] = -1;
-        }
+    // one block for all nodes, rows pointing into it
+    int nnode = GetTree()->GetNnode();
+    missingmap = new int *[nnode];
+    missingmap[0] = new int[nnode * GetNsite()];
+    for (int j = 0; j < nnode; j++) {
+        missingmap[j] = missingmap[0] + j * GetNsite();
     }
+    std::fill(missingmap[0], missingmap[0] + nnode * GetNsite(), -1);
 }
 
 void PhyloProcess::DeleteMissingMap() {
-    for (int j = 0; j < GetTree()->GetNnode(); j++) {
-        delete[] missingmap[j];
-    }
+    delete[] missingmap[0];
     delete[] missingmap;
 }
 
@@ -139,8 +190,8 @@ void PhyloProcess::FillMissingMap() {
     }
     */
 
-    BackwardFillMissingMap(GetRoot());
-    ForwardFillMissingMap(GetRoot(), GetRoot());
+    BackwardFillMissingMap();
+    ForwardFillMissingMap();
 }
 
 /*
@@ -160,129 +211,156 @@ void PhyloProcess::PrintMissing(const Link* from, int site)    {
 }
 */
 
-void PhyloProcess::BackwardFillMissingMap(const Link *from) {
-    int index = from->GetNode()->GetIndex();
-    for (int i = 0; i < GetNsite(); i++) {
-        missingmap[index][i] = 0;
-    }
-    if (from->isLeaf()) {
+void PhyloProcess::BackwardFillMissingMap() {
+    for (int index : tree->GetPostorder()) {
         for (int i = 0; i < GetNsite(); i++) {
-            int state = GetData(index, i);
-            if (state != -1) {
-                missingmap[index][i] = 1;
-            }
+            missingmap[index][i] = 0;
         }
-    } else {
-        for (const Link *link = from->Next(); link != from; link = link->Next()) {
-            BackwardFillMissingMap(link->Out());
-            int j = link->Out()->GetNode()->GetIndex();
+        if (tree->isLeafNode(index)) {
             for (int i = 0; i < GetNsite(); i++) {
-                if (missingmap[j][i]) {
-                    missingmap[index][i]++;
+                if (!GetData()->isMissing(index, i)) {
+                    missingmap[index][i] = 1;
+                }
+            }
+        } else {
+            for (int k = tree->GetChildBegin(index); k < tree->GetChildEnd(index); k++) {
+                int j = tree->GetChild(k);
+                for (int i = 0; i < GetNsite(); i++) {
+                    if (missingmap[j][i]) {
+                        missingmap[index][i]++;
+                    }
                 }
             }
         }
     }
 }
 
-void PhyloProcess::ForwardFillMissingMap(const Link *from, const Link *up) {
-    int index = from->GetNode()->GetIndex();
-    int upindex = up->GetNode()->GetIndex();
-
-    if (from->isRoot()) {
-        for (int i = 0; i < GetNsite(); i++) {
-            if (missingmap[index][i] <= 1) {
-                missingmap[index][i] = 0;
-            } else {
-                missingmap[index][i] = 2;
-            }
-        }
-    } else {
-        for (int i = 0; i < GetNsite(); i++) {
-            if (missingmap[index][i] > 0) {
-                if (missingmap[upindex][i]) {
-                    missingmap[index][i] = 1;
+void PhyloProcess::ForwardFillMissingMap() {
+    for (int index : tree->GetPreorder()) {
+        int upindex = tree->GetParentNode(index);
+        if (upindex == -1) {
+            for (int i = 0; i < GetNsite(); i++) {
+                if (!missingmap[index][i]) {
+                    missingmap[index][i] = -1;
+                } else if (missingmap[index][i] == 1) {
+                    missingmap[index][i] = 0;
                 } else {
-                    if (from->isLeaf() || (missingmap[index][i] > 1)) {
-                        missingmap[index][i] = 2;
+                    missingmap[index][i] = 2;
+                }
+            }
+        } else {
+            for (int i = 0; i < GetNsite(); i++) {
+                if (missingmap[index][i] > 0) {
+                    if (missingmap[upindex][i]) {
+                        missingmap[index][i] = 1;
                     } else {
-                        missingmap[index][i] = 0;
+                        if (tree->isLeafNode(index) || (missingmap[index][i] > 1)) {
+                            missingmap[index][i] = 2;
+                        } else {
+                            missingmap[index][i] = 0;
+                        }
                     }
+                } else {
+                    missingmap[index][i] = -1;
                 }
             }
         }
     }
-    for (const Link *link = from->Next(); link != from; link = link->Next()) {
-        ForwardFillMissingMap(link->Out(), from);
-    }
 }
 
-void PhyloProcess::RecursiveCreate(const Link *from) {
-    auto state = new int[GetNsite()];
-    statemap[from->GetNode()] = state;
-
-    auto array = new BranchSitePath *[GetNsite()];
-    for (int i = 0; i < GetNsite(); i++) {
-        array[i] = 0;
+void PhyloProcess::CreateStatesAndPaths() {
+    // as for missingmap, one block for all nodes
+    statemap.assign(tree->GetNnode(), nullptr);
+    statemap[0] = new int[tree->GetNnode() * GetNsite()];
+    for (int j = 1; j < tree->GetNnode(); j++) {
+        statemap[j] = statemap[0] + j * GetNsite();
     }
-    pathmap[from->GetNode()] = array;
-
-    for (const Link *link = from->Next(); link != from; link = link->Next()) {
-        RecursiveCreate(link->Out());
+    sitepath.assign(GetNsite(), vector<PathSegment>());
+    pathbegin.assign(GetNsite() * tree->GetNnode(), 0);
+    pathend.assign(GetNsite() * tree->GetNnode(), 0);
+    if (storepaths) {
+        pathmap.assign(tree->GetNnode(), nullptr);
+        pathmap[0] = new BranchSitePath *[tree->GetNnode() * GetNsite()]();
+        for (int j = 1; j < tree->GetNnode(); j++) {
+            pathmap[j] = pathmap[0] + j * GetNsite();
+        }
     }
 }
 
-void PhyloProcess::RecursiveDelete(const Link *from) {
-    for (const Link *link = from->Next(); link != from; link = link->Next()) {
-        RecursiveDelete(link->Out());
+void PhyloProcess::DeleteStatesAndPaths() {
+    if (!statemap.empty()) {
+        delete[] statemap[0];
+    }
+    statemap.clear();
+    sitepath.clear();
+    pathbegin.clear();
+    pathend.clear();
+    for (auto path : pathmap) {
+        for (int i = 0; i < GetNsite(); i++) {
+            delete path[i];
+        }
     }
+    if (!pathmap.empty()) {
+        delete[] pathmap[0];
+    }
+    pathmap.clear();
+}
 
-    delete[] statemap[from->GetNode()];
+void PhyloProcess::CreateTBL() {
+    condl.assign(tree->GetNnode() * (GetNstate() + 1), 0);
+    branchcondl.assign(tree->GetNnode() * (GetNstate() + 1), 0);
+}
 
-    BranchSitePath **path = pathmap[from->GetNode()];
-    for (int i = 0; i < GetNsite(); i++) {
-        delete path[i];
-    }
+void PhyloProcess::DeleteTBL() {
+    condl.clear();
+    branchcondl.clear();
 }
 
-void PhyloProcess::RecursiveCreateTBL(const Link *from) {
-    condlmap[from] = new double[GetNstate() + 1];
-    for (Link *link = from->Next(); link != from; link = link->Next()) {
-        condlmap[link] = new double[GetNstate() + 1];
-        RecursiveCreateTBL(link->Out());
+void PhyloProcess::LoadBranches() const {
+    for (int j = 0; j < GetTree()->GetNbranch(); j++) {
+        branchlengthtable[j] = GetBranchLength(j);
+    }
+    if (matrixmode == homogeneous) {
+        for (int j = 0; j < GetTree()->GetNbranch(); j++) {
+            branchmatrix[j] = homogeneousmatrix;
+        }
+    } else if (matrixmode == branchheterogeneous) {
+        for (int j = 0; j < GetTree()->GetNbranch(); j++) {
+            branchmatrix[j] = &branchmatrixarray->GetVal(j);
+        }
     }
 }
 
-void PhyloProcess::RecursiveDeleteTBL(const Link *from) {
-    for (Link *link = from->Next(); link != from; link = link->Next()) {
-        RecursiveDeleteTBL(link->Out());
-        delete[] condlmap[link];
+void PhyloProcess::LoadSite(int site) const {
+    currentrate = GetSiteRate(site);
+    if (matrixmode == siteheterogeneous) {
+        const SubMatrix *mat = &sitematrixarray->GetVal(site);
+        for (int j = 0; j < GetTree()->GetNbranch(); j++) {
+            branchmatrix[j] = mat;
+        }
+    } else if (matrixmode == generic) {
+        for (int j = 0; j < GetTree()->GetNbranch(); j++) {
+            branchmatrix[j] = &GetSubMatrix(j, site);
+        }
     }
-    delete[] condlmap[from];
 }
 
 double PhyloProcess::SiteLogLikelihood(int site) const {
-    Pruning(GetRoot(), site);
-    double ret = 0;
-    double *t = GetCondLikelihood(GetRoot());
-    const EVector &stat = GetRootFreq(site);
-
-    for (int k = 0; k < GetNstate(); k++) {
-        ret += t[k] * stat[k];
+    // site log likelihoods of the last pass over all sites are still valid
+    if (lnLcached && isLikelihoodUpToDate()) {
+        return sitelnL[site];
     }
-    if (ret == 0) {
-        cerr << "pruning : 0 \n";
-        for (int k = 0; k < GetNstate(); k++) {
-            cerr << t[k] << '\t' << stat[k] << '\n';
-        }
-        exit(1);
-    }
-    return log(ret) + t[GetNstate()];
+    // sitelnL no longer reflects a single state of the process
+    lnLcached = false;
+    LoadBranches();
+    LoadSite(site);
+    Pruning(site);
+    return FastSiteLogLikelihood(site);
 }
 
 double PhyloProcess::FastSiteLogLikelihood(int site) const {
     double ret = 0;
-    double *t = GetCondLikelihood(GetRoot());
+    double *t = GetCondLikelihood(tree->GetRootNode());
     const EVector &stat = GetRootFreq(site);
     for (int k = 0; k < GetNstate(); k++) {
         ret += t[k] * stat[k];
@@ -309,227 +387,421 @@ double PhyloProcess::GetFastLogProb() const {
 }
 
 double PhyloProcess::GetLogLikelihood() const {
+    PERF_TIMER(LogLikelihood);
+    if (lnLcached && isLikelihoodUpToDate()) {
+        return lnLtotal;
+    }
 #if DEBUG > 1
     MeasureTime timer;
 #endif
     double total = 0;
+    LoadBranches();
     for (int i = 0; i < GetNsite(); i++) {
-        total += SiteLogLikelihood(i);
+        LoadSite(i);
+        Pruning(i);
+        total += FastSiteLogLikelihood(i);
     }
 #if DEBUG > 1
     timer.print<2>("GetLogProb. ");
 #endif
+    StoreLikelihood(total);
     return total;
 }
 
-void PhyloProcess::Pruning(const Link *from, int site) const {
-    double *t = GetCondLikelihood(from);
-    if (from->isLeaf()) {
-        int totcomp = 0;
-        for (int k = 0; k < GetNstate(); k++) {
-            // if (polyprocess != nullptr) {
-            //    t[k] = polyprocess->GetLogProb(site,from->GetNode()->GetIndex(),k);
-            //}
-            // else    {
-            if (isDataCompatible(from->GetNode()->GetIndex(), site, k)) {
-                t[k] = 1;
-                totcomp++;
-            } else {
-                t[k] = 0;
+template <class F>
+void PhyloProcess::ForEachMatrix(F f) const {
+    if (matrixmode == homogeneous) {
+        f(homogeneousmatrix);
+    } else if (matrixmode == siteheterogeneous) {
+        for (int i = 0; i < GetNsite(); i++) {
+            f(&sitematrixarray->GetVal(i));
+        }
+    } else if (matrixmode == branchheterogeneous) {
+        for (int j = 0; j < GetTree()->GetNbranch(); j++) {
+            f(&branchmatrixarray->GetVal(j));
+        }
+        // the same matrix at the root of all sites
+        f(&rootsubmatrixarray->GetVal(0));
+    } else {
+        for (int j = 0; j < GetTree()->GetNbranch(); j++) {
+            for (int i = 0; i < GetNsite(); i++) {
+                f(&GetSubMatrix(j, i));
             }
-            //}
         }
-        if (totcomp == 0) {
-            cerr << "error : no compatibility\n";
-            cerr << GetData(from->GetNode()->GetIndex(), site) << '\n';
-            exit(1);
+        for (int i = 0; i < GetNsite(); i++) {
+            f(&rootsubmatrixarray->GetVal(i));
         }
+    }
+}
 
-        t[GetNstate()] = 0;
-    } else {
-        for (int k = 0; k < GetNstate(); k++) {
-            t[k] = 1.0;
-        }
-        t[GetNstate()] = 0;
-        for (const Link *link = from->Next(); link != from; link = link->Next()) {
-            double *tbl = GetCondLikelihood(link);
-            Pruning(link->Out(), site);
-            GetSubMatrix(link->GetBranch()->GetIndex(), site)
-                .BackwardPropagate(
-                    GetCondLikelihood(link->Out()), GetCondLikelihood(link),
-                    GetBranchLength(link->GetBranch()->GetIndex()) * GetSiteRate(site));
-            for (int k = 0; k < GetNstate(); k++) {
-                t[k] *= tbl[k];
+void PhyloProcess::StoreLikelihood(double lnL) const {
+    lnLtotal = lnL;
+    lnLbranchlength.resize(GetTree()->GetNbranch());
+    for (int j = 0; j < GetTree()->GetNbranch(); j++) {
+        lnLbranchlength[j] = GetBranchLength(j);
+    }
+    lnLsiterate.clear();
+    if (siterate) {
+        lnLsiterate.resize(GetNsite());
+        for (int i = 0; i < GetNsite(); i++) {
+            lnLsiterate[i] = siterate->GetVal(i);
+        }
+    }
+    lnLmatrix.clear();
+    ForEachMatrix([this](const SubMatrix *m) { lnLmatrix.emplace_back(m, m->GetVersion()); });
+    lnLcached = true;
+}
+
+bool PhyloProcess::isLikelihoodUpToDate() const {
+    for (int j = 0; j < GetTree()->GetNbranch(); j++) {
+        if (GetBranchLength(j) != lnLbranchlength[j]) {
+            return false;
+        }
+    }
+    if (siterate) {
+        for (int i = 0; i < GetNsite(); i++) {
+            if (siterate->GetVal(i) != lnLsiterate[i]) {
+                return false;
             }
-            t[GetNstate()] += tbl[GetNstate()];
         }
-        double max = 0;
+    }
+    size_t k = 0;
+    bool same = true;
+    ForEachMatrix([this, &k, &same](const SubMatrix *m) {
+        if (same && ((k == lnLmatrix.size()) || (lnLmatrix[k].first != m) ||
+                     (lnLmatrix[k].second != m->GetVersion()))) {
+            same = false;
+        }
+        k++;
+    });
+    return same && (k == lnLmatrix.size());
+}
+
+void PhyloProcess::MultiplyCondLikelihood(double *t, double *tbl, bool first) const {
+    // both factors are brought above minscale before being multiplied, and the
+    // product is rescaled right away: whatever the number of children, the
+    // running product never goes below minscale^2 (times the overlap of the
+    // two vectors)
+    double max = 0;
+    for (int k = 0; k < GetNstate(); k++) {
+        if (max < tbl[k]) {
+            max = tbl[k];
+        }
+    }
+    RescaleCondLikelihood(tbl, max);
+    max = 0;
+    if (first) {
+        for (int k = 0; k <= GetNstate(); k++) {
+            t[k] = tbl[k];
+        }
         for (int k = 0; k < GetNstate(); k++) {
-            if (t[k] < 0) {
-                /*
-                  cerr << "error in pruning: negative prob : " << t[k] << "\n";
-                  exit(1);
-                */
-                t[k] = 0;
+            if (max < t[k]) {
+                max = t[k];
             }
+        }
+    } else {
+        for (int k = 0; k < GetNstate(); k++) {
+            t[k] *= tbl[k];
             if (max < t[k]) {
                 max = t[k];
             }
         }
+        t[GetNstate()] += tbl[GetNstate()];
+    }
+    RescaleCondLikelihood(t, max);
+}
+
+void PhyloProcess::RescaleCondLikelihood(double *t, double max) const {
+    if (max < minscale) {
         if (max == 0) {
-            cerr << "max = 0\n";
             cerr << "error in pruning: null likelihood\n";
-            if (from->isRoot()) {
-                cerr << "is root\n";
-            }
-            cerr << '\n';
             exit(1);
-            max = 1e-20;
         }
+        // max = m * 2^e, with 0.5 <= m < 1: multiplying by 2^-e is exact
+        int e;
+        frexp(max, &e);
+        double factor = ldexp(1.0, -e);
         for (int k = 0; k < GetNstate(); k++) {
-            t[k] /= max;
+            t[k] *= factor;
         }
-        t[GetNstate()] += log(max);
+        t[GetNstate()] += e * M_LN2;
     }
 }
 
-void PhyloProcess::PruningAncestral(const Link *from, int site) {
-    int &state = GetState(from->GetNode(), site);
-    if (from->isRoot()) {
-        auto aux = new double[GetNstate()];
-        auto cumulaux = new double[GetNstate()];
-        try {
-            double *tbl = GetCondLikelihood(from);
-            const EVector &stat = GetRootFreq(site);
-            double tot = 0;
-            for (int k = 0; k < GetNstate(); k++) {
-                aux[k] = stat[k] * tbl[k];
-                tot += aux[k];
-                cumulaux[k] = tot;
-            }
-            double u = tot * Random::Uniform();
-            int s = 0;
-            while ((s < GetNstate()) && (cumulaux[s] < u)) {
-                s++;
+void PhyloProcess::Pruning(int site) const {
+    for (int node : tree->GetPostorder()) {
+        double *t = GetCondLikelihood(node);
+        if (isMissing(node, site)) {
+            // subtrees without data are skipped; if this is the root, the site
+            // is entirely missing
+            if (node == tree->GetRootNode()) {
+                for (int k = 0; k < GetNstate(); k++) {
+                    t[k] = 1;
+                }
+                t[GetNstate()] = 0;
             }
-            if (s == GetNstate()) {
-                cerr << "error in pruning ancestral: overflow\n";
-                exit(1);
+            continue;
+        }
+        if (tree->isLeafNode(node)) {
+            // observed state read once from the (compact) alignment
+            int obs = GetData(node, site);
+            if (obs == unknown) {
+                for (int k = 0; k < GetNstate(); k++) {
+                    t[k] = 1;
+                }
+            } else {
+                if (obs >= GetNstate()) {
+                    cerr << "error : no compatibility\n";
+                    cerr << obs << '\n';
+                    exit(1);
+                }
+                for (int k = 0; k < GetNstate(); k++) {
+                    t[k] = 0;
+                }
+                t[obs] = 1;
             }
-            state = s;
-        } catch (...) {
-            cerr << "in root::PruningAncestral\n";
-            for (int k = 0; k < GetNstate(); k++) {
-                cerr << aux[k] << '\n';
+
+            t[GetNstate()] = 0;
+        } else {
+            // product over children (of which at least one has data), rescaled
+            // child after child (see MultiplyCondLikelihood)
+            bool first = true;
+            for (int c = tree->GetChildBegin(node); c < tree->GetChildEnd(node); c++) {
+                int child = tree->GetChild(c);
+                if (isMissing(child, site)) {
+                    continue;
+                }
+                double *tbl = GetBranchCondLikelihood(child);
+                int branch = tree->GetNodeBranch(child);
+                GetBranchMatrix(branch).BackwardPropagate(GetCondLikelihood(child), tbl,
+                                                          GetBranchTime(branch));
+                MultiplyCondLikelihood(t, tbl, first);
+                first = false;
             }
+        }
+    }
+}
+
+void PhyloProcess::CreateMixtureCondLikelihoods(int ncomp) const {
+    mixcondl.assign(tree->GetNnode() * ncomp * (GetNstate() + 1), 0);
+    mixbranchcondl.assign(tree->GetNnode() * ncomp * (GetNstate() + 1), 0);
+    mixncomp = ncomp;
+}
+
+void PhyloProcess::DeleteMixtureCondLikelihoods() const {
+    mixcondl.clear();
+    mixbranchcondl.clear();
+    mixncomp = 0;
+}
+
+void PhyloProcess::MixtureSiteLogLikelihood(int site, const Selector<SubMatrix> &components,
+                                            vector<double> &logp) const {
+    int ncomp = components.GetSize();
+    if (ncomp > mixncomp) {
+        CreateMixtureCondLikelihoods(ncomp);
+    }
+    MixturePruning(site, components);
+    double *t = GetMixtureCondLikelihood(tree->GetRootNode());
+    logp.resize(ncomp);
+    for (int c = 0; c < ncomp; c++) {
+        double *tc = t + c * (GetNstate() + 1);
+        const EVector &stat = components.GetVal(c).GetStationary();
+        double ret = 0;
+        for (int k = 0; k < GetNstate(); k++) {
+            ret += tc[k] * stat[k];
+        }
+        if (ret == 0) {
+            cerr << "error in PhyloProcess::MixtureSiteLogLikelihood: null likelihood\n";
             exit(1);
-            throw;
         }
-        delete[] aux;
-        delete[] cumulaux;
+        logp[c] = log(ret) + tc[GetNstate()];
     }
-    for (const Link *link = from->Next(); link != from; link = link->Next()) {
-        auto aux = new double[GetNstate()];
-        auto cumulaux = new double[GetNstate()];
-        try {
-            for (int k = 0; k < GetNstate(); k++) {
-                aux[k] = 1;
-            }
-            GetSubMatrix(link->GetBranch()->GetIndex(), site)
-                .GetFiniteTimeTransitionProb(
-                    state, aux, GetBranchLength(link->GetBranch()->GetIndex()) * GetSiteRate(site));
-            double *tbl = GetCondLikelihood(link->Out());
-            for (int k = 0; k < GetNstate(); k++) {
-                aux[k] *= tbl[k];
-            }
+}
 
-            // dealing with numerical problems:
-            double max = 0;
-            for (int k = 0; k < GetNstate(); k++) {
-                if (aux[k] < 0) {
-                    aux[k] = 0;
-                }
-                if (max < aux[k]) {
-                    max = aux[k];
+void PhyloProcess::MixturePruning(int site, const Selector<SubMatrix> &components) const {
+    int ncomp = components.GetSize();
+    int n = GetNstate() + 1;
+    for (int node : tree->GetPostorder()) {
+        double *t = GetMixtureCondLikelihood(node);
+        if (isMissing(node, site)) {
+            // as in Pruning
+            if (node == tree->GetRootNode()) {
+                for (int c = 0; c < ncomp; c++) {
+                    double *tc = t + c * n;
+                    for (int k = 0; k < GetNstate(); k++) {
+                        tc[k] = 1;
+                    }
+                    tc[GetNstate()] = 0;
                 }
             }
-            if (max == 0) {
-                auto stat = GetSubMatrix(link->GetBranch()->GetIndex(), site).GetStationary();
+            continue;
+        }
+        if (tree->isLeafNode(node)) {
+            // leaf vector is the same for all components
+            int obs = GetData(node, site);
+            if (obs == unknown) {
                 for (int k = 0; k < GetNstate(); k++) {
-                    aux[k] = stat[k];
+                    t[k] = 1;
                 }
+            } else {
+                if (obs >= GetNstate()) {
+                    cerr << "error : no compatibility\n";
+                    cerr << obs << '\n';
+                    exit(1);
+                }
+                for (int k = 0; k < GetNstate(); k++) {
+                    t[k] = 0;
+                }
+                t[obs] = 1;
             }
-            // end of dealing with dirty numerical problems
-            double tot = 0;
-            for (int k = 0; k < GetNstate(); k++) {
-                tot += aux[k];
-                cumulaux[k] = tot;
+            t[GetNstate()] = 0;
+            for (int c = 1; c < ncomp; c++) {
+                copy(t, t + n, t + c * n);
             }
-            double u = tot * Random::Uniform();
-            int s = 0;
-            while ((s < GetNstate()) && (cumulaux[s] < u)) {
-                s++;
+        } else {
+            // as in Pruning, for each component
+            bool first = true;
+            for (int l = tree->GetChildBegin(node); l < tree->GetChildEnd(node); l++) {
+                int child = tree->GetChild(l);
+                if (isMissing(child, site)) {
+                    continue;
+                }
+                const double *up = GetMixtureCondLikelihood(child);
+                double *tbl = GetMixtureBranchCondLikelihood(child);
+                double length = GetBranchLength(tree->GetNodeBranch(child)) * GetSiteRate(site);
+                for (int c = 0; c < ncomp; c++) {
+                    components.GetVal(c).BackwardPropagate(up + c * n, tbl + c * n, length);
+                }
+                for (int c = 0; c < ncomp; c++) {
+                    MultiplyCondLikelihood(t + c * n, tbl + c * n, first);
+                }
+                first = false;
             }
-            if (s == GetNstate()) {
-                cerr << "error in pruning ancestral: overflow\n";
-                exit(1);
+        }
+    }
+}
+
+void PhyloProcess::PruningAncestral(int site) {
+    auto aux = new double[GetNstate()];
+    auto cumulaux = new double[GetNstate()];
+
+    int root = tree->GetRootNode();
+    {
+        double *tbl = GetCondLikelihood(root);
+        const EVector &stat = GetRootFreq(site);
+        double tot = 0;
+        for (int k = 0; k < GetNstate(); k++) {
+            aux[k] = stat[k] * tbl[k];
+            tot += aux[k];
+            cumulaux[k] = tot;
+        }
+        double u = tot * Random::Uniform();
+        int s = 0;
+        while ((s < GetNstate()) && (cumulaux[s] < u)) {
+            s++;
+        }
+        if (s == GetNstate()) {
+            cerr << "error in pruning ancestral: overflow\n";
+            exit(1);
+        }
+        GetState(root, site) = s;
+    }
+
+    // preorder: each node is drawn conditional on the (already drawn) state of
+    // its parent, in the same order as a recursive traversal
+    // (nodes without data below them are left undrawn, see ResamplePaths)
+    for (int node : tree->GetPreorder()) {
+        if ((node == root) || isMissing(node, site)) {
+            continue;
+        }
+        int state = GetState(tree->GetParentNode(node), site);
+        for (int k = 0; k < GetNstate(); k++) {
+            aux[k] = 1;
+        }
+        int branch = tree->GetNodeBranch(node);
+        GetBranchMatrix(branch).GetFiniteTimeTransitionProb(state, aux, GetBranchTime(branch));
+        double *tbl = GetCondLikelihood(node);
+        for (int k = 0; k < GetNstate(); k++) {
+            aux[k] *= tbl[k];
+        }
+
+        // dealing with numerical problems:
+        double max = 0;
+        for (int k = 0; k < GetNstate(); k++) {
+            if (aux[k] < 0) {
+                aux[k] = 0;
+            }
+            if (max < aux[k]) {
+                max = aux[k];
             }
-            int &nodestate = GetState(link->Out()->GetNode(), site);
-            nodestate = s;
-        } catch (...) {
-            cerr << "in internal leave::PruningAncestral\n";
+        }
+        if (max == 0) {
+            auto stat = GetBranchMatrix(branch).GetStationary();
             for (int k = 0; k < GetNstate(); k++) {
-                cerr << aux[k] << '\n';
+                aux[k] = stat[k];
             }
+        }
+        // end of dealing with dirty numerical problems
+        double tot = 0;
+        for (int k = 0; k < GetNstate(); k++) {
+            tot += aux[k];
+            cumulaux[k] = tot;
+        }
+        double u = tot * Random::Uniform();
+        int s = 0;
+        while ((s < GetNstate()) && (cumulaux[s] < u)) {
+            s++;
+        }
+        if (s == GetNstate()) {
+            cerr << "error in pruning ancestral: overflow\n";
             exit(1);
-            throw;
         }
-        delete[] aux;
-        delete[] cumulaux;
-        PruningAncestral(link->Out(), site);
+        GetState(node, site) = s;
     }
+    delete[] aux;
+    delete[] cumulaux;
 }
 
 void PhyloProcess::RootPosteriorDraw(int site) {
     auto aux = new double[GetNstate()];
-    double *tbl = GetCondLikelihood(GetRoot());
+    double *tbl = GetCondLikelihood(tree->GetRootNode());
     const EVector &stat = GetRootFreq(site);
     for (int k = 0; k < GetNstate(); k++) {
         aux[k] = stat[k] * tbl[k];
     }
-    GetState(GetRoot()->GetNode(), site) = Random::DrawFromDiscreteDistribution(aux, GetNstate());
+    GetState(tree->GetRootNode(), site) = Random::DrawFromDiscreteDistribution(aux, GetNstate());
     delete[] aux;
 }
 
-void PhyloProcess::PriorSample(const Link *from, int site, bool rootprior) {
-    int &state = GetState(from->GetNode(), site);
-    if (from->isRoot()) {
-        if (rootprior) {
-            state = Random::DrawFromDiscreteDistribution(GetRootFreq(site), GetNstate());
-            // state =
-            // Random::DrawFromDiscreteDistribution(GetRootFreq(site),GetNstate());
-        } else {
-            RootPosteriorDraw(site);
-        }
+void PhyloProcess::PriorSample(int site, bool rootprior) {
+    int root = tree->GetRootNode();
+    if (rootprior) {
+        GetState(root, site) = Random::DrawFromDiscreteDistribution(GetRootFreq(site), GetNstate());
+    } else {
+        RootPosteriorDraw(site);
     }
-    for (const Link *link = from->Next(); link != from; link = link->Next()) {
-        GetState(link->Out()->GetNode(), site) =
-            GetSubMatrix(link->GetBranch()->GetIndex(), site)
-                .DrawFiniteTime(state,
-                                GetBranchLength(link->GetBranch()->GetIndex()) * GetSiteRate(site));
-        PriorSample(link->Out(), site, rootprior);
+    for (int node : tree->GetPreorder()) {
+        if (node != root) {
+            int branch = tree->GetNodeBranch(node);
+            GetState(node, site) = GetBranchMatrix(branch).DrawFiniteTime(
+                GetState(tree->GetParentNode(node), site), GetBranchTime(branch));
+        }
     }
 }
 
 void PhyloProcess::ResampleState() {
+    LoadBranches();
     for (int i = 0; i < GetNsite(); i++) {
         ResampleState(i);
     }
+    StoreLikelihood(GetFastLogProb());
 }
 
 void PhyloProcess::ResampleState(int site) {
-    Pruning(GetRoot(), site);
-    PruningAncestral(GetRoot(), site);
+    LoadSite(site);
+    Pruning(site);
+    FastSiteLogLikelihood(site);
+    PruningAncestral(site);
     // give information about fixed states at the tips to polyprocess
 }
 
@@ -548,108 +820,285 @@ void PhyloProcess::DrawSites(double fraction) {
 }
 
 void PhyloProcess::ResampleSub() {
-    pruningchrono.Start();
 #if DEBUG > 1
     MeasureTime timer;
 #endif
-
-    for (int i = 0; i < GetNsite(); i++) {
-        if (sitearray[i] != 0) {
-            ResampleState(i);
+    LoadBranches();
+    {
+        PERF_TIMER(StateMapping);
+        int nsite = 0;
+        for (int i = 0; i < GetNsite(); i++) {
+            if (sitearray[i] != 0) {
+                ResampleState(i);
+                nsite++;
+            }
+        }
+        // all sites were pruned: log likelihood comes for free
+        if (nsite == GetNsite()) {
+            StoreLikelihood(GetFastLogProb());
+        } else if (lnLcached && !isLikelihoodUpToDate()) {
+            // some entries of sitelnL were computed in another state than
+            // the cached one
+            lnLcached = false;
         }
     }
 #if DEBUG > 1
     timer.print<2>("ResampleSub - state. ");
 #endif
-    pruningchrono.Stop();
 
-    resamplechrono.Start();
+    PERF_TIMER(SubMapping);
     for (int i = 0; i < GetNsite(); i++) {
         if (sitearray[i] != 0) {
-            ResampleSub(GetRoot(), i);
+            LoadSite(i);
+            ResamplePaths(i);
         }
     }
-    resamplechrono.Stop();
 }
 
 void PhyloProcess::ResampleSub(int site) {
+    LoadBranches();
     ResampleState(site);
-    ResampleSub(GetRoot(), site);
+    ResamplePaths(site);
 }
 
-void PhyloProcess::ResampleSub(const Link *from, int site) {
-    delete pathmap[from->GetNode()][site];
-
-    if (from->isRoot()) {
-        pathmap[from->GetNode()][site] = SampleRootPath(GetState(from->GetNode(), site));
-    } else {
-        pathmap[from->GetNode()][site] =
-            SamplePath(GetState(from->Out()->GetNode(), site), GetState(from->GetNode(), site),
-                       GetBranchLength(from->GetBranch()->GetIndex()), GetSiteRate(site),
-                       GetSubMatrix(from->GetBranch()->GetIndex(), site));
+void PhyloProcess::ResamplePaths(int site) {
+    int root = tree->GetRootNode();
+    vector<PathSegment> &path = sitepath[site];
+    path.clear();
+    // paths are needed only on the branches of the subtree spanned by the
+    // observed leaves (those whose suff stats are collected, see missingmap);
+    // other branches get an empty path
+    for (int node : tree->GetPreorder()) {
+        int index = site * tree->GetNnode() + node;
+        pathbegin[index] = path.size();
+        if (node == root) {
+            if (!isMissing(node, site)) {
+                path.push_back(PathSegment{GetState(node, site), 0});
+            }
+        } else if (missingmap[node][site] == 1) {
+            int branch = tree->GetNodeBranch(node);
+            SamplePath(GetState(tree->GetParentNode(node), site), GetState(node, site),
+                       branchlengthtable[branch], currentrate, GetBranchMatrix(branch), path);
+        }
+        pathend[index] = path.size();
     }
-
-    for (const Link *link = from->Next(); link != from; link = link->Next()) {
-        ResampleSub(link->Out(), site);
+    if (storepaths) {
+        for (int node : tree->GetPreorder()) {
+            delete pathmap[node][site];
+            pathmap[node][site] = nullptr;
+            if (PathBegin(node, site) != PathEnd(node, site)) {
+                pathmap[node][site] = MakePath(PathBegin(node, site), PathEnd(node, site));
+            }
+        }
     }
 }
 
 void PhyloProcess::PostPredSample(string name, bool rootprior) {
-    for (int i = 0; i < GetNsite(); i++) {
-        PostPredSample(i, rootprior);
-    }
     SequenceAlignment tmpdata(*GetData());
-    GetLeafData(&tmpdata);
+    PostPredSample(&tmpdata, rootprior);
     ofstream os(name.c_str());
     tmpdata.ToStream(os);
     os.close();
 }
 
-void PhyloProcess::PostPredSample(int site, bool rootprior) {
-    if (!rootprior) {
-        Pruning(GetRoot(), site);
+void PhyloProcess::PostPredSample(SequenceAlignment *simdata, bool rootprior) {
+    PERF_TIMER(PostPredSimu);
+    LoadBranches();
+    if (matrixmode == generic) {
+        // matrices can differ across branches and sites
+        for (int i = 0; i < GetNsite(); i++) {
+            PostPredSample(i, rootprior);
+        }
+    } else {
+        // sites are simulated independently: group them by matrix and rate, and
+        // simulate each group as a run
+        vector<int> order(GetNsite());
+        for (int i = 0; i < GetNsite(); i++) {
+            order[i] = i;
+        }
+        auto key = [this](int i) {
+            return std::make_pair(reinterpret_cast<uintptr_t>(&rootsubmatrixarray->GetVal(i)),
+                                  GetSiteRate(i));
+        };
+        std::stable_sort(order.begin(), order.end(),
+                         [&key](int i, int j) { return key(i) < key(j); });
+        int i = 0;
+        while (i < GetNsite()) {
+            int j = i + 1;
+            while ((j < GetNsite()) && (key(order[j]) == key(order[i]))) {
+                j++;
+            }
+            PostPredSample(order.data() + i, j - i, rootprior);
+            i = j;
+        }
     }
-    PriorSample(GetRoot(), site, rootprior);
+    GetLeafData(simdata);
 }
 
-void PhyloProcess::GetLeafData(SequenceAlignment *data) { RecursiveGetLeafData(GetRoot(), data); }
+void PhyloProcess::PostPredSample(const int *sites, int nsite, bool rootprior) {
+    for (int k = 0; k < nsite; k++) {
+        LoadSite(sites[k]);
+        if (rootprior) {
+            GetState(tree->GetRootNode(), sites[k]) =
+                Random::DrawFromDiscreteDistribution(GetRootFreq(sites[k]), GetNstate());
+        } else {
+            Pruning(sites[k]);
+            RootPosteriorDraw(sites[k]);
+        }
+    }
+
+    // costs are in units of the cost of one step of the jump chain (a waiting
+    // time and a next state): on a branch with an expected number of
+    // substitutions nsub, simulating the jump chain costs about
+    // nsite*(0.5+nsub), and drawing from a transition table
+    // nsite*DRAWCOST + TABLECOST*min(nsite,Nstate)*Nstate^2, plus, unless
+    // already done by the pruning algorithm, DIAGCOST*Nstate^3 for
+    // diagonalizing the matrix (once for all branches sharing it)
+    double nstate = GetNstate();
+    double nrow = (nsite < nstate) ? nsite : nstate;
+    double diagcost = rootprior ? DIAGCOST * nstate * nstate * nstate : 0;
+    int nbranch = GetTree()->GetNbranch();
+    vector<double> branchsaving(nbranch, 0);
+    std::map<const SubMatrix *, pair<double, double>> matrate;  // rate and total saving
+    for (int j = 0; j < nbranch; j++) {
+        const SubMatrix *mat = &GetBranchMatrix(j);
+        auto m = matrate.find(mat);
+        if (m == matrate.end()) {
+            m = matrate.insert(make_pair(mat, make_pair(mat->GetRate(), 0.0))).first;
+        }
+        double nsub = GetBranchTime(j) * m->second.first;
+        branchsaving[j] =
+            nsite * (0.5 + nsub - DRAWCOST) - TABLECOST * nrow * nstate * nstate;
+        if (branchsaving[j] > 0) {
+            m->second.second += branchsaving[j];
+        }
+    }
 
-void PhyloProcess::RecursiveGetLeafData(const Link *from, SequenceAlignment *data) {
-    if (from->isLeaf()) {
-        for (int site = 0; site < GetNsite(); site++) {
-            int state = GetState(from->GetNode(), site);
-            int obsstate = GetData(from->GetNode()->GetIndex(), site);
-            if (obsstate != unknown) {
-                data->SetState(from->GetNode()->GetIndex(), site, state);
-            } else {
-                data->SetState(from->GetNode()->GetIndex(), site, unknown);
+    for (int node : tree->GetPreorder()) {
+        if (node == tree->GetRootNode()) {
+            continue;
+        }
+        int up = tree->GetParentNode(node);
+        int branch = tree->GetNodeBranch(node);
+        const SubMatrix &mat = GetBranchMatrix(branch);
+        double time = GetBranchTime(branch);
+        if ((branchsaving[branch] > 0) && (matrate[&mat].second > diagcost)) {
+            ResetTransitionTable();
+            for (int k = 0; k < nsite; k++) {
+                GetState(node, sites[k]) =
+                    DrawFromTransitionTable(mat, time, GetState(up, sites[k]));
+            }
+        } else {
+            for (int k = 0; k < nsite; k++) {
+                GetState(node, sites[k]) = mat.DrawFiniteTime(GetState(up, sites[k]), time);
             }
         }
     }
-    for (const Link *link = from->Next(); link != from; link = link->Next()) {
-        RecursiveGetLeafData(link->Out(), data);
+}
+
+void PhyloProcess::ResetTransitionTable() const {
+    if (transprob.empty()) {
+        transprob.assign(GetNstate() * GetNstate(), 0);
+        transalias.assign(GetNstate() * GetNstate(), 0);
     }
+    transrowflag.assign(GetNstate(), 0);
 }
 
-BranchSitePath *PhyloProcess::SampleRootPath(int rootstate) {
-    BranchSitePath *path = new BranchSitePath(rootstate);
-    return path;
+int PhyloProcess::DrawFromTransitionTable(const SubMatrix &mat, double time, int stateup) const {
+    int nstate = GetNstate();
+    double *prob = transprob.data() + stateup * nstate;
+    int *alias = transalias.data() + stateup * nstate;
+    if (!transrowflag[stateup]) {
+        mat.GetFiniteTimeTransitionRow(stateup, prob, time);
+        Random::MakeAliasTable(prob, nstate, prob, alias);
+        transrowflag[stateup] = 1;
+    }
+    return Random::DrawFromAliasTable(prob, alias, nstate);
+}
+
+void PhyloProcess::PostPredSample(int site, bool rootprior) {
+    LoadSite(site);
+    if (!rootprior) {
+        Pruning(site);
+    }
+    PriorSample(site, rootprior);
+}
+
+void PhyloProcess::GetLeafData(SequenceAlignment *data) {
+    for (int node : tree->GetPreorder()) {
+        if (tree->isLeafNode(node)) {
+            for (int site = 0; site < GetNsite(); site++) {
+                int obsstate = GetData(node, site);
+                if (obsstate != unknown) {
+                    data->SetState(node, site, GetState(node, site));
+                } else {
+                    data->SetState(node, site, unknown);
+                }
+            }
+        }
+    }
 }
 
-BranchSitePath *PhyloProcess::SamplePath(int stateup, int statedown, double time, double rate,
-                                         const SubMatrix &matrix) {
-    BranchSitePath *path = ResampleAcceptReject(1000, stateup, statedown, rate, time, matrix);
-    if (!path) {
-        path = ResampleUniformized(stateup, statedown, rate, time, matrix);
+BranchSitePath *PhyloProcess::MakePath(const PathSegment *begin, const PathSegment *end) const {
+    BranchSitePath *path = new BranchSitePath(begin->state);
+    for (const PathSegment *seg = begin + 1; seg != end; seg++) {
+        path->Append(seg->state, (seg - 1)->reltime);
     }
+    path->Last()->SetRelativeTime((end - 1)->reltime);
     return path;
 }
 
-BranchSitePath *PhyloProcess::ResampleAcceptReject(int maxtrial, int stateup, int statedown,
-                                                   double rate, double totaltime,
-                                                   const SubMatrix &matrix) {
+void PhyloProcess::SamplePath(int stateup, int statedown, double time, double rate,
+                              const SubMatrix &matrix, vector<PathSegment> &path) {
+    double efflength = rate * time;
+    if (efflength < 1e-10) {
+        ResampleAcceptReject(1, stateup, statedown, rate, time, matrix, path);
+        nrejectionpath++;
+        return;
+    }
+
+    // lower bound on the acceptance probability of the rejection method
+    double qup = -matrix(stateup, stateup);
+    double noevent = exp(-qup * efflength);
+    double bound = 0;
+    if (stateup == statedown) {
+        bound = noevent;
+    } else {
+        double qdown = -matrix(statedown, statedown);
+        double onestep = 0;
+        if (fabs(qup - qdown) > 1e-8 * qup) {
+            onestep = matrix(stateup, statedown) * (exp(-qdown * efflength) - noevent) /
+                      (qup - qdown);
+        } else {
+            onestep = matrix(stateup, statedown) * efflength * noevent;
+        }
+        bound = onestep / (1 - noevent);
+    }
+
+    if (bound < minacceptance) {
+        double Z = matrix.GetFiniteTimeTransitionProb(stateup, statedown, efflength);
+        double accept = (stateup == statedown) ? Z : Z / (1 - noevent);
+        if (accept < minacceptance) {
+            ResampleUniformized(stateup, statedown, rate, time, matrix, path, Z);
+            nuniformizedpath++;
+            return;
+        }
+    }
+
+    if (ResampleAcceptReject(MAXREJECTIONTRIAL, stateup, statedown, rate, time, matrix, path)) {
+        nrejectionpath++;
+    } else {
+        nrejectionfail++;
+        ResampleUniformized(stateup, statedown, rate, time, matrix, path);
+        nuniformizedpath++;
+    }
+}
+
+bool PhyloProcess::ResampleAcceptReject(int maxtrial, int stateup, int statedown, double rate,
+                                        double totaltime, const SubMatrix &matrix,
+                                        vector<PathSegment> &path) {
     int ntrial = 0;
-    BranchSitePath *path = 0;
+    size_t begin = path.size();
 
     if (rate * totaltime < 1e-10) {
         // if (rate * totaltime == 0)	{
@@ -658,16 +1107,13 @@ BranchSitePath *PhyloProcess::ResampleAcceptReject(int maxtrial, int stateup, in
                     "stateup != statedown, efflength == 0\n";
             exit(1);
         }
-        delete path;
-        path = new BranchSitePath();
+        path.push_back(PathSegment{stateup, 0});
         ntrial++;
-        path->Reset(stateup);
     } else {
         do {
-            delete path;
-            path = new BranchSitePath();
+            path.resize(begin);
             ntrial++;
-            path->Reset(stateup);
+            path.push_back(PathSegment{stateup, 0});
             double t = 0;
             int state = stateup;
 
@@ -678,13 +1124,14 @@ BranchSitePath *PhyloProcess::ResampleAcceptReject(int maxtrial, int stateup, in
 
                 t += u;
                 int newstate = matrix.DrawOneStep(state);
-                path->Append(newstate, u / totaltime);
+                path.back().reltime = u / totaltime;
+                path.push_back(PathSegment{newstate, 0});
                 state = newstate;
             }
             while (t < totaltime) {
                 // draw waiting time
                 double q = -rate * matrix(state, state);
-                double u = -log(1 - Random::Uniform()) / q;
+                double u = Random::sExpo() / q;
                 if (std::isnan(u)) {
                     cerr << "in MatrixSubstitutionProcess:: drawing exponential number: "
                             "nan\n";
@@ -704,38 +1151,37 @@ BranchSitePath *PhyloProcess::ResampleAcceptReject(int maxtrial, int stateup, in
                 t += u;
                 if (t < totaltime) {
                     int newstate = matrix.DrawOneStep(state);
-                    path->Append(newstate, u / totaltime);
+                    path.back().reltime = u / totaltime;
+                    path.push_back(PathSegment{newstate, 0});
                     state = newstate;
                 } else {
                     t -= u;
                     u = totaltime - t;
-                    path->Last()->SetRelativeTime(u / totaltime);
+                    path.back().reltime = u / totaltime;
                     t = totaltime;
                 }
             }
-        } while ((ntrial < maxtrial) && (path->Last()->GetState() != statedown));
+        } while ((ntrial < maxtrial) && (path.back().state != statedown));
     }
+    nrejectiontrial += ntrial;
 
     // if endstate does not match state at the corresponding end of the branch
-    // just force it to match
-    // however, this is really dirty !
-    // normally, in that case, one should give up with accept-reject
-    // and use a uniformized method instead (but not yet adapted to the present
-    // code, see below)
-    if (path->Last()->GetState() != statedown) {
-        // fossil
-        // path->Last()->SetState(statedown);
-        delete path;
-        path = 0;
+    // give up (the uniformized method should then be used instead)
+    if (path.back().state != statedown) {
+        path.resize(begin);
+        return false;
     }
-
-    return path;
+    return true;
 }
 
-BranchSitePath *PhyloProcess::ResampleUniformized(int stateup, int statedown, double rate,
-                                                  double totaltime, const SubMatrix &matrix) {
+void PhyloProcess::ResampleUniformized(int stateup, int statedown, double rate, double totaltime,
+                                       const SubMatrix &matrix, vector<PathSegment> &path,
+                                       double Z) {
     double length = rate * totaltime;
-    int m = matrix.DrawUniformizedSubstitutionNumber(stateup, statedown, length);
+    if (Z < 0) {
+        Z = matrix.GetFiniteTimeTransitionProb(stateup, statedown, length);
+    }
+    int m = matrix.DrawUniformizedSubstitutionNumber(stateup, statedown, length, Z);
 
     vector<double> y(m + 1);
     for (int r = 0; r < m; r++) {
@@ -746,195 +1192,286 @@ BranchSitePath *PhyloProcess::ResampleUniformized(int stateup, int statedown, do
 
     int state = stateup;
 
-    BranchSitePath *path = new BranchSitePath();
-    path->Reset(stateup);
+    path.push_back(PathSegment{stateup, 0});
 
     double t = y[0];
     for (int r = 0; r < m; r++) {
         int k = (r == m - 1) ? statedown
                              : matrix.DrawUniformizedTransition(state, statedown, m - r - 1);
         if (k != state) {
-            path->Append(k, t);
+            path.back().reltime = t;
+            path.push_back(PathSegment{k, 0});
             t = 0;
         }
         state = k;
         t += y[r + 1] - y[r];
     }
-    path->Last()->SetRelativeTime(t);
-    return path;
+    path.back().reltime = t;
 }
 
-void PhyloProcess::AddPathSuffStat(PathSuffStat &suffstat) const {
-    RecursiveAddPathSuffStat(GetRoot(), suffstat);
+void PhyloProcess::AddSegmentPathSuffStat(int node, int site, PathSuffStat &suffstat,
+                                          double factor) const {
+    const PathSegment *end = PathEnd(node, site);
+    for (const PathSegment *seg = PathBegin(node, site); seg != end; seg++) {
+        suffstat.AddWaitingTime(seg->state, seg->reltime * factor);
+        if (seg + 1 != end) {
+            suffstat.IncrementPairCount(seg->state, (seg + 1)->state);
+        }
+    }
 }
 
-void PhyloProcess::RecursiveAddPathSuffStat(const Link *from, PathSuffStat &suffstat) const {
-    LocalAddPathSuffStat(from, suffstat);
-    for (const Link *link = from->Next(); link != from; link = link->Next()) {
-        RecursiveAddPathSuffStat(link->Out(), suffstat);
+void PhyloProcess::AddSegmentLengthSuffStat(int node, int site, PoissonSuffStat &suffstat,
+                                            double factor, const SubMatrix &mat) const {
+    const PathSegment *end = PathEnd(node, site);
+    for (const PathSegment *seg = PathBegin(node, site); seg != end; seg++) {
+        suffstat.AddBeta(-seg->reltime * factor * mat(seg->state, seg->state));
+        if (seg + 1 != end) {
+            suffstat.IncrementCount();
+        }
     }
 }
 
-void PhyloProcess::LocalAddPathSuffStat(const Link *from, PathSuffStat &suffstat) const {
-    int nodeindex = from->GetNode()->GetIndex();
+void PhyloProcess::AddPathSuffStat(PathSuffStat &suffstat) const {
+    for (int node : tree->GetPreorder()) {
+        LocalAddPathSuffStat(node, suffstat);
+    }
+}
+
+void PhyloProcess::LocalAddPathSuffStat(int node, PathSuffStat &suffstat) const {
     for (int i = 0; i < GetNsite(); i++) {
-        if (missingmap[nodeindex][i] == 2) {
-            suffstat.IncrementRootCount(GetState(from->GetNode(), i));
-        } else if (missingmap[nodeindex][i] == 1) {
-            if (from->isRoot()) {
+        if (missingmap[node][i] == 2) {
+            suffstat.IncrementRootCount(GetState(node, i));
+        } else if (missingmap[node][i] == 1) {
+            if (node == tree->GetRootNode()) {
                 cerr << "error in missing map\n";
                 exit(1);
             }
-            pathmap[from->GetNode()][i]->AddPathSuffStat(
-                suffstat, GetBranchLength(from->GetBranch()->GetIndex()) * GetSiteRate(i));
+            AddSegmentPathSuffStat(node, i, suffstat,
+                                   GetBranchLength(tree->GetNodeBranch(node)) * GetSiteRate(i));
         }
     }
 }
 
 void PhyloProcess::AddPathSuffStat(BidimArray<PathSuffStat> &suffstatarray,
                                    const BranchAllocationSystem &branchalloc) const {
-    RecursiveAddPathSuffStat(GetRoot(), suffstatarray, branchalloc);
-}
-
-void PhyloProcess::RecursiveAddPathSuffStat(const Link *from,
-                                            BidimArray<PathSuffStat> &suffstatarray,
-                                            const BranchAllocationSystem &branchalloc) const {
-    if (from->isRoot()) {
-        LocalAddPathSuffStat(from, suffstatarray, 0);
-    } else {
-        LocalAddPathSuffStat(from, suffstatarray,
-                             branchalloc.GetBranchAlloc(from->GetBranch()->GetIndex()));
-    }
-    for (const Link *link = from->Next(); link != from; link = link->Next()) {
-        RecursiveAddPathSuffStat(link->Out(), suffstatarray, branchalloc);
+    for (int node : tree->GetPreorder()) {
+        if (node == tree->GetRootNode()) {
+            LocalAddPathSuffStat(node, suffstatarray, 0);
+        } else {
+            LocalAddPathSuffStat(node, suffstatarray,
+                                 branchalloc.GetBranchAlloc(tree->GetNodeBranch(node)));
+        }
     }
 }
 
-void PhyloProcess::LocalAddPathSuffStat(const Link *from, BidimArray<PathSuffStat> &suffstatarray,
+void PhyloProcess::LocalAddPathSuffStat(int node, BidimArray<PathSuffStat> &suffstatarray,
                                         int cond) const {
-    int nodeindex = from->GetNode()->GetIndex();
     for (int i = 0; i < GetNsite(); i++) {
-        if (missingmap[nodeindex][i] == 2) {
-            suffstatarray(cond, i).IncrementRootCount(GetState(from->GetNode(), i));
-        } else if (missingmap[nodeindex][i] == 1) {
-            if (from->isRoot()) {
+        if (missingmap[node][i] == 2) {
+            suffstatarray(cond, i).IncrementRootCount(GetState(node, i));
+        } else if (missingmap[node][i] == 1) {
+            if (node == tree->GetRootNode()) {
                 cerr << "error in missing map\n";
                 exit(1);
             }
-            pathmap[from->GetNode()][i]->AddPathSuffStat(
-                suffstatarray(cond, i),
-                GetBranchLength(from->GetBranch()->GetIndex()) * GetSiteRate(i));
+            AddSegmentPathSuffStat(node, i, suffstatarray(cond, i),
+                                   GetBranchLength(tree->GetNodeBranch(node)) * GetSiteRate(i));
         }
     }
 }
 
 void PhyloProcess::AddPathSuffStat(Array<PathSuffStat> &suffstatarray) const {
-    RecursiveAddPathSuffStat(GetRoot(), suffstatarray);
-}
-
-void PhyloProcess::RecursiveAddPathSuffStat(const Link *from,
-                                            Array<PathSuffStat> &suffstatarray) const {
-    LocalAddPathSuffStat(from, suffstatarray);
-    for (const Link *link = from->Next(); link != from; link = link->Next()) {
-        RecursiveAddPathSuffStat(link->Out(), suffstatarray);
+    for (int node : tree->GetPreorder()) {
+        LocalAddPathSuffStat(node, suffstatarray);
     }
 }
 
-void PhyloProcess::LocalAddPathSuffStat(const Link *from,
-                                        Array<PathSuffStat> &suffstatarray) const {
-    int nodeindex = from->GetNode()->GetIndex();
+void PhyloProcess::LocalAddPathSuffStat(int node, Array<PathSuffStat> &suffstatarray) const {
     for (int i = 0; i < GetNsite(); i++) {
-        if (missingmap[nodeindex][i] == 2) {
-            suffstatarray[i].IncrementRootCount(GetState(from->GetNode(), i));
-        } else if (missingmap[nodeindex][i] == 1) {
-            if (from->isRoot()) {
+        if (missingmap[node][i] == 2) {
+            suffstatarray[i].IncrementRootCount(GetState(node, i));
+        } else if (missingmap[node][i] == 1) {
+            if (node == tree->GetRootNode()) {
                 cerr << "error in missing map\n";
                 exit(1);
             }
-            pathmap[from->GetNode()][i]->AddPathSuffStat(
-                suffstatarray[i], GetBranchLength(from->GetBranch()->GetIndex()) * GetSiteRate(i));
+            AddSegmentPathSuffStat(node, i, suffstatarray[i],
+                                   GetBranchLength(tree->GetNodeBranch(node)) * GetSiteRate(i));
         }
     }
 }
 
 void PhyloProcess::AddPathSuffStat(NodeArray<PathSuffStat> &suffstatarray) const {
-    RecursiveAddPathSuffStat(GetRoot(), suffstatarray);
-}
-
-void PhyloProcess::RecursiveAddPathSuffStat(const Link *from,
-                                            NodeArray<PathSuffStat> &suffstatarray) const {
-    LocalAddPathSuffStat(from, suffstatarray);
-    for (const Link *link = from->Next(); link != from; link = link->Next()) {
-        RecursiveAddPathSuffStat(link->Out(), suffstatarray);
+    for (int node : tree->GetPreorder()) {
+        LocalAddPathSuffStat(node, suffstatarray);
     }
 }
 
-void PhyloProcess::LocalAddPathSuffStat(const Link *from,
-                                        NodeArray<PathSuffStat> &suffstatarray) const {
-    int nodeindex = from->GetNode()->GetIndex();
+void PhyloProcess::LocalAddPathSuffStat(int node, NodeArray<PathSuffStat> &suffstatarray) const {
     for (int i = 0; i < GetNsite(); i++) {
-        if (missingmap[nodeindex][i] == 2) {
-            suffstatarray[nodeindex].IncrementRootCount(GetState(from->GetNode(), i));
-        } else if (missingmap[nodeindex][i] == 1) {
-            if (from->isRoot()) {
+        if (missingmap[node][i] == 2) {
+            suffstatarray[node].IncrementRootCount(GetState(node, i));
+        } else if (missingmap[node][i] == 1) {
+            if (node == tree->GetRootNode()) {
                 cerr << "error in missing map\n";
                 exit(1);
             }
-            pathmap[from->GetNode()][i]->AddPathSuffStat(
-                suffstatarray[nodeindex],
-                GetBranchLength(from->GetBranch()->GetIndex()) * GetSiteRate(i));
+            AddSegmentPathSuffStat(node, i, suffstatarray[node],
+                                   GetBranchLength(tree->GetNodeBranch(node)) * GetSiteRate(i));
         }
     }
 }
 
 void PhyloProcess::AddLengthSuffStat(
     BranchArray<PoissonSuffStat> &branchlengthpathsuffstatarray) const {
-    RecursiveAddLengthSuffStat(GetRoot(), branchlengthpathsuffstatarray);
+    for (int node : tree->GetPreorder()) {
+        if (node != tree->GetRootNode()) {
+            LocalAddLengthSuffStat(node,
+                                   branchlengthpathsuffstatarray[tree->GetNodeBranch(node)]);
+        }
+    }
 }
 
-void PhyloProcess::RecursiveAddLengthSuffStat(
-    const Link *from, BranchArray<PoissonSuffStat> &branchlengthpathsuffstatarray) const {
-    if (!from->isRoot()) {
-        LocalAddLengthSuffStat(from, branchlengthpathsuffstatarray[from->GetBranch()->GetIndex()]);
+void PhyloProcess::LocalAddLengthSuffStat(int node, PoissonSuffStat &suffstat) const {
+    int branch = tree->GetNodeBranch(node);
+    for (int i = 0; i < GetNsite(); i++) {
+        if (missingmap[node][i] == 1) {
+            AddSegmentLengthSuffStat(node, i, suffstat, GetSiteRate(i), GetSubMatrix(branch, i));
+        }
+    }
+}
+
+// relative lengths of a series of collapsed branches
+static vector<double> CollapsedFractions(const vector<int> &collapsed,
+                                         const BranchSelector<double> &length) {
+    vector<double> frac(collapsed.size());
+    double total = 0;
+    for (size_t k = 0; k < collapsed.size(); k++) {
+        frac[k] = length.GetVal(collapsed[k]);
+        total += frac[k];
     }
-    for (const Link *link = from->Next(); link != from; link = link->Next()) {
-        RecursiveAddLengthSuffStat(link->Out(), branchlengthpathsuffstatarray);
+    for (double &f : frac) {
+        f /= total;
     }
+    return frac;
 }
 
-void PhyloProcess::LocalAddLengthSuffStat(const Link *link, PoissonSuffStat &suffstat) const {
-    int nodeindex = link->GetNode()->GetIndex();
-    for (int i = 0; i < GetNsite(); i++) {
-        if (missingmap[nodeindex][i] == 1) {
-            pathmap[link->GetNode()][i]->AddLengthSuffStat(
-                suffstat, GetSiteRate(i), GetSubMatrix(link->GetBranch()->GetIndex(), i));
+// walk along the history of a branch standing for several collapsed branches
+// (of relative lengths frac), calling f(seg, k, dt, last) for each piece of
+// each segment: k is the collapsed branch along which the piece lies, dt its
+// relative duration, and last is true for the final piece of the segment (the
+// one at the end of which the next substitution, if any, occurs)
+template <class Segment, class F>
+static void SplitPath(Segment *begin, Segment *end, const vector<double> &frac, F f) {
+    int n = frac.size();
+    int k = 0;
+    double bound = frac[0];
+    double t = 0;
+    for (Segment *seg = begin; seg != end; seg++) {
+        double segend = t + seg->reltime;
+        while ((k < n - 1) && (bound < segend)) {
+            if (bound > t) {
+                f(seg, k, bound - t, false);
+                t = bound;
+            }
+            k++;
+            bound += frac[k];
         }
+        f(seg, k, (segend > t) ? segend - t : 0, true);
+        t = segend;
     }
 }
 
-void PhyloProcess::AddRateSuffStat(Array<PoissonSuffStat> &siteratepathsuffstatarray) const {
-    RecursiveAddRateSuffStat(GetRoot(), siteratepathsuffstatarray);
+void PhyloProcess::AddLengthSuffStat(BranchArray<PoissonSuffStat> &branchlengthpathsuffstatarray,
+                                     const vector<vector<int>> &collapsed,
+                                     const BranchSelector<double> &fulllength) const {
+    for (int node : tree->GetPreorder()) {
+        if (node != tree->GetRootNode()) {
+            const vector<int> &path = collapsed[tree->GetNodeBranch(node)];
+            if (path.size() == 1) {
+                LocalAddLengthSuffStat(node, branchlengthpathsuffstatarray[path[0]]);
+            } else {
+                LocalAddLengthSuffStat(node, branchlengthpathsuffstatarray, path, fulllength);
+            }
+        }
+    }
+}
+
+void PhyloProcess::LocalAddLengthSuffStat(int node,
+                                          BranchArray<PoissonSuffStat> &branchlengthsuffstatarray,
+                                          const vector<int> &collapsed,
+                                          const BranchSelector<double> &fulllength) const {
+    int branch = tree->GetNodeBranch(node);
+    vector<double> frac = CollapsedFractions(collapsed, fulllength);
+    for (int i = 0; i < GetNsite(); i++) {
+        if (missingmap[node][i] == 1) {
+            const SubMatrix &mat = GetSubMatrix(branch, i);
+            double rate = GetSiteRate(i);
+            const PathSegment *end = PathEnd(node, i);
+            SplitPath(PathBegin(node, i), end, frac,
+                      [&](const PathSegment *seg, int k, double dt, bool last) {
+                          PoissonSuffStat &suffstat = branchlengthsuffstatarray[collapsed[k]];
+                          suffstat.AddBeta(-dt * rate * mat(seg->state, seg->state) / frac[k]);
+                          if (last && (seg + 1 != end)) {
+                              suffstat.IncrementCount();
+                          }
+                      });
+        }
+    }
 }
 
-void PhyloProcess::RecursiveAddRateSuffStat(
-    const Link *from, Array<PoissonSuffStat> &siteratepathsuffstatarray) const {
-    if (!from->isRoot()) {
-        LocalAddRateSuffStat(from, siteratepathsuffstatarray);
+void PhyloProcess::RescaleCollapsedPaths(const vector<vector<int>> &collapsed,
+                                         const BranchSelector<double> &fromlength,
+                                         const BranchSelector<double> &tolength) {
+    if (sitepath.empty()) {
+        return;
     }
-    for (const Link *link = from->Next(); link != from; link = link->Next()) {
-        RecursiveAddRateSuffStat(link->Out(), siteratepathsuffstatarray);
+    int Nnode = tree->GetNnode();
+    for (int node : tree->GetPreorder()) {
+        if (node == tree->GetRootNode()) {
+            continue;
+        }
+        const vector<int> &path = collapsed[tree->GetNodeBranch(node)];
+        if (path.size() == 1) {
+            continue;
+        }
+        vector<double> from = CollapsedFractions(path, fromlength);
+        vector<double> to = CollapsedFractions(path, tolength);
+        for (int i = 0; i < GetNsite(); i++) {
+            if (missingmap[node][i] == 1) {
+                PathSegment *begin = sitepath[i].data() + pathbegin[i * Nnode + node];
+                PathSegment *end = sitepath[i].data() + pathend[i * Nnode + node];
+                // new durations accumulated in place of the old ones, which are
+                // read by SplitPath before the segment is first visited
+                double newtime = 0;
+                SplitPath(begin, end, from, [&](PathSegment *seg, int k, double dt, bool last) {
+                    newtime += dt * to[k] / from[k];
+                    if (last) {
+                        seg->reltime = newtime;
+                        newtime = 0;
+                    }
+                });
+            }
+        }
+    }
+}
+
+void PhyloProcess::AddRateSuffStat(Array<PoissonSuffStat> &siteratepathsuffstatarray) const {
+    for (int node : tree->GetPreorder()) {
+        if (node != tree->GetRootNode()) {
+            LocalAddRateSuffStat(node, siteratepathsuffstatarray);
+        }
     }
 }
 
-void PhyloProcess::LocalAddRateSuffStat(const Link *link,
+void PhyloProcess::LocalAddRateSuffStat(int node,
                                         Array<PoissonSuffStat> &siteratepathsuffstatarray) const {
-    int nodeindex = link->GetNode()->GetIndex();
-    double length = GetBranchLength(link->GetBranch()->GetIndex());
+    int branch = tree->GetNodeBranch(node);
+    double length = GetBranchLength(branch);
     for (int i = 0; i < GetNsite(); i++) {
-        if (missingmap[nodeindex][i] == 1) {
-            pathmap[link->GetNode()][i]->AddLengthSuffStat(
-                siteratepathsuffstatarray[i], length,
-                GetSubMatrix(link->GetBranch()->GetIndex(), i));
+        if (missingmap[node][i] == 1) {
+            AddSegmentLengthSuffStat(node, i, siteratepathsuffstatarray[i], length,
+                                     GetSubMatrix(branch, i));
         }
     }
 }
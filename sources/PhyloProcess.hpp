@@ -7,8 +7,8 @@
 #include "BranchAllocationSystem.hpp"
 #include "BranchSitePath.hpp"
 #include "BranchSiteSelector.hpp"
-#include "Chrono.hpp"
 #include "NodeArray.hpp"
+#include "PerfCounters.hpp"
 #include "SequenceAlignment.hpp"
 #include "SubMatrix.hpp"
 #include "Tree.hpp"
@@ -96,13 +96,33 @@ class PhyloProcess {
 
     ~PhyloProcess();
 
-    //! return log likelihood (computed using the pruning algorithm, Felsenstein
-    //! 1981)
+    //! \brief return log likelihood (computed using the pruning algorithm,
+    //! Felsenstein 1981)
+    //!
+    //! the value is cached: it is recomputed only if matrices (or their
+    //! allocation to branches and sites), branch lengths or site rates have
+    //! changed since the last call, or since the last stochastic mapping of all
+    //! sites (ResampleSub), which computes the likelihood as a by-product (see
+    //! isLikelihoodUpToDate).
     double GetLogLikelihood() const;
 
-    //! return log likelihood for given site
+    //! \brief return log likelihood for given site
+    //!
+    //! taken from the last pass over all sites if the process has not changed
+    //! since then (see isLikelihoodUpToDate); otherwise, only this site is
+    //! pruned.
     double SiteLogLikelihood(int site) const;
 
+    //! \brief log likelihoods of a site under each component of a mixture
+    //!
+    //! components are branch-homogeneous matrices (also giving the equilibrium
+    //! frequencies at the root), such as the omega classes of the M2a model.
+    //! All component likelihoods are computed in one single traversal of the
+    //! tree, and returned in logp (resized to the number of components). Does
+    //! not change the current allocation of the site.
+    void MixtureSiteLogLikelihood(int site, const Selector<SubMatrix> &components,
+                                  vector<double> &logp) const;
+
     //! stochastic sampling of substitution history under current parameter
     //! configuration
     void ResampleSub();
@@ -111,32 +131,77 @@ class PhyloProcess {
     //! sites
     double Move(double fraction);
 
+    //! \brief also store detailed substitution histories (BranchSitePath
+    //! objects) for each branch and site
+    //!
+    //! By default, substitution histories are kept only in compact form (one
+    //! contiguous buffer of (state, relative waiting time) segments per site),
+    //! which is all what is needed for computing path sufficient statistics.
+    //! Should be called before Unfold.
+    void StorePaths(bool in = true) { storepaths = in; }
+
     //! create all data structures necessary for computation
+    //! (or only register the process for UnfoldDeferred, see DeferUnfold)
     void Unfold();
 
+    //! \brief defer subsequent calls to Unfold until UnfoldDeferred
+    //!
+    //! Used by multi-gene slaves, which allocate all their gene models in
+    //! sequence and then unfold all their phylogenetic processes at once, over
+    //! several threads.
+    static void DeferUnfold(bool in) { deferunfold = in; }
+
+    //! unfold all processes whose Unfold was deferred (over several threads,
+    //! see ThreadedFor)
+    static void UnfoldDeferred();
+
     //! delete data structures
     void Cleanup();
 
     //! posterior predictive resampling under current parameter configuration
     void PostPredSample(string name, bool rootprior = true);  // unclamped Nielsen
 
+    //! posterior predictive resampling under current parameter configuration,
+    //! into an existing alignment (of same dimensions as the data, e.g. a copy)
+    void PostPredSample(SequenceAlignment *simdata, bool rootprior = true);
+
+    //! \brief adapt substitution histories to new lengths of collapsed branches
+    //!
+    //! to be called, for a process running over a restriction of a larger tree
+    //! (see AddLengthSuffStat), when the lengths of the branches of the larger
+    //! tree change from fromlength to tolength: the piece of history along each
+    //! collapsed branch keeps its own relative timing, so that the histories
+    //! remain those for which the length suff stats were collected.
+    void RescaleCollapsedPaths(const vector<vector<int>> &collapsed,
+                               const BranchSelector<double> &fromlength,
+                               const BranchSelector<double> &tolength);
+
     //! get data from tips (after simulation) and put in into sequence alignment
     void GetLeafData(SequenceAlignment *data);
 
+    //! number of branch paths sampled by rejection (over all processes)
+    static unsigned long GetRejectionPathCount() { return nrejectionpath; }
+    //! total number of forward simulations done by rejection sampling
+    static unsigned long GetRejectionTrialCount() { return nrejectiontrial; }
+    //! number of branch paths sampled by uniformization (including fallbacks)
+    static unsigned long GetUniformizedPathCount() { return nuniformizedpath; }
+    //! number of times rejection sampling gave up after maxtrial trials
+    static unsigned long GetRejectionFailCount() { return nrejectionfail; }
+
   private:
     //! \brief const access to substitution history (BranchSitePath) for given
     //! node and given site
     //!
     //! Substitution histories are indexed by node (not by branch);
-    //! root node also has a substitution history (starting state).
-    const BranchSitePath *GetPath(const Node *node, int site) const {
-        map<const Node *, BranchSitePath **>::const_iterator it = pathmap.find(node);
-        if (it == pathmap.end()) {
-            std::cerr << "error in phyloprocess::did not find entry for node in "
-                         "branch site path\n";
+    //! root node also has a substitution history (starting state). Branches
+    //! outside of the subtree spanned by the observed leaves of the site have
+    //! none (see ResamplePaths).
+    const BranchSitePath *GetPath(int node, int site) const {
+        if (!storepaths) {
+            std::cerr << "error in phyloprocess::getpath: paths are not stored (see StorePaths)\n";
             exit(1);
         }
-        const BranchSitePath *path = it->second[site];
+        const BranchSitePath *path = pathmap[node][site];
         if (path == nullptr) {
             std::cerr << "error in phyloprocess::getpath: null path\n";
             exit(1);
@@ -147,6 +212,26 @@ class PhyloProcess {
     double GetFastLogProb() const;
     double FastSiteLogLikelihood(int site) const;
 
+    //! \brief record the current state of the process along with the log
+    //! likelihood just computed (see isLikelihoodUpToDate)
+    void StoreLikelihood(double lnL) const;
+
+    //! \brief true if the cached log likelihood is still valid
+    //!
+    //! i.e. if branch lengths and site rates are exactly the same, and the
+    //! matrices used along the tree and at the root (see ForEachMatrix) are the
+    //! same instances, at the same version (SubMatrix::GetVersion).
+    bool isLikelihoodUpToDate() const;
+
+    //! \brief apply f to each matrix used by the process
+    //!
+    //! i.e. the single matrix if homogeneous, then the matrices of all sites,
+    //! branches, or branch-site pairs (according to matrixmode), followed by the
+    //! root matrices, if not already covered. The order of the calls is always
+    //! the same, for a given allocation of matrices.
+    template <class F>
+    void ForEachMatrix(F f) const;
+
     //! return branch length for given branch
     double GetBranchLength(int branch) const { return branchlength->GetVal(branch); }
 
@@ -164,6 +249,23 @@ class PhyloProcess {
         return submatrixarray->GetVal(branch, site);
     }
 
+    //! \brief load branch lengths into lookup table, as well as matrices, if
+    //! site-homogeneous (see matrixmode)
+    //!
+    //! should be called at the beginning of any pass over sites (followed by
+    //! LoadSite for each site), so that the pruning and mapping recursions do
+    //! not need to go through the virtual selectors at each branch.
+    void LoadBranches() const;
+
+    //! load site rate and, if site-heterogeneous, matrices for given site
+    void LoadSite(int site) const;
+
+    //! return matrix for given branch at current site (see LoadSite)
+    const SubMatrix &GetBranchMatrix(int branch) const { return *branchmatrix[branch]; }
+
+    //! return branch length times site rate for given branch at current site
+    double GetBranchTime(int branch) const { return branchlengthtable[branch] * currentrate; }
+
     const EVector &GetRootFreq(int site) const {
         return rootsubmatrixarray->GetVal(site).GetStationary();
     }
@@ -190,10 +292,8 @@ class PhyloProcess {
     void UnclampData() { clampdata = false; }
 
     // const int& GetFixedState(...)
-    int &GetState(const Node *node, int site) { return statemap[node][site]; }
-    const int &GetState(const Node *node, int site) const { return statemap[node][site]; }
-
-    void RecursiveGetLeafData(const Link *from, SequenceAlignment *data);
+    int &GetState(int node, int site) { return statemap[node][site]; }
+    const int &GetState(int node, int site) const { return statemap[node][site]; }
 
     bool isDataCompatible(int taxon, int site, int state) const {
         return GetStateSpace()->isCompatible(GetData(taxon, site), state);
@@ -222,32 +322,35 @@ class PhyloProcess {
     //! to branchlengthpathsuffstatarray
     void AddLengthSuffStat(BranchArray<PoissonSuffStat> &branchlengthpathsuffstatarray) const;
 
+    //! \brief path sufficient statistics for the branch lengths of a larger
+    //! tree, of which the tree of this process is a restriction
+    //!
+    //! each branch of the tree of this process stands for a series of branches
+    //! of the larger tree (collapsed, see Tree::GetCollapsedBranches), of
+    //! lengths given by fulllength. The substitution history along the branch
+    //! is cut into pieces in proportion to those lengths, and each piece
+    //! contributes to the suff stat of its own branch in
+    //! branchlengthpathsuffstatarray (indexed over the larger tree).
+    void AddLengthSuffStat(BranchArray<PoissonSuffStat> &branchlengthpathsuffstatarray,
+                           const vector<vector<int>> &collapsed,
+                           const BranchSelector<double> &fulllength) const;
+
     //! compute path sufficient statistics for resampling branch lengths add them
     //! to branchlengthpathsuffstatarray
     void AddRateSuffStat(Array<PoissonSuffStat> &siteratepathsuffstatarray) const;
 
-    void RecursiveAddPathSuffStat(const Link *from, PathSuffStat &suffstat) const;
-    void LocalAddPathSuffStat(const Link *from, PathSuffStat &suffstat) const;
-
-    void RecursiveAddPathSuffStat(const Link *from, NodeArray<PathSuffStat> &suffstatarray) const;
-    void LocalAddPathSuffStat(const Link *from, NodeArray<PathSuffStat> &suffstatarray) const;
-
-    void RecursiveAddPathSuffStat(const Link *from, Array<PathSuffStat> &suffstatarray) const;
-    void LocalAddPathSuffStat(const Link *from, Array<PathSuffStat> &suffstatarray) const;
-
-    void RecursiveAddPathSuffStat(const Link *from, BidimArray<PathSuffStat> &suffstatarray,
-                                  const BranchAllocationSystem &branchalloc) const;
-    void LocalAddPathSuffStat(const Link *from, BidimArray<PathSuffStat> &suffstatarray,
-                              int cond) const;
-
-    void RecursiveAddLengthSuffStat(
-        const Link *from, BranchArray<PoissonSuffStat> &branchlengthpathsuffstatarray) const;
-    void LocalAddLengthSuffStat(const Link *from, PoissonSuffStat &branchlengthsuffstat) const;
-
-    void RecursiveAddRateSuffStat(const Link *from,
-                                  Array<PoissonSuffStat> &siteratepathsuffstatarray) const;
-    void LocalAddRateSuffStat(const Link *from,
-                              Array<PoissonSuffStat> &siteratepathsuffstatarray) const;
+    // contributions of the substitution histories of one node (i.e. of the
+    // branch above it), across sites; called over the preorder schedule of the
+    // tree (see Tree::GetPreorder)
+    void LocalAddPathSuffStat(int node, PathSuffStat &suffstat) const;
+    void LocalAddPathSuffStat(int node, NodeArray<PathSuffStat> &suffstatarray) const;
+    void LocalAddPathSuffStat(int node, Array<PathSuffStat> &suffstatarray) const;
+    void LocalAddPathSuffStat(int node, BidimArray<PathSuffStat> &suffstatarray, int cond) const;
+    void LocalAddLengthSuffStat(int node, PoissonSuffStat &branchlengthsuffstat) const;
+    void LocalAddLengthSuffStat(int node, BranchArray<PoissonSuffStat> &branchlengthsuffstatarray,
+                                const vector<int> &collapsed,
+                                const BranchSelector<double> &fulllength) const;
+    void LocalAddRateSuffStat(int node, Array<PoissonSuffStat> &siteratepathsuffstatarray) const;
 
     void PostPredSample(int site, bool rootprior = false);
     // rootprior == true : root state drawn from stationary probability of the
@@ -256,57 +359,138 @@ class PhyloProcess {
 
     // various accessors
 
-    bool isMissing(const Node *node, int site) const { return false; }
+    //! true if no leaf of the subtree below node is observed at site: the node
+    //! and the branch above it are then ignored by pruning and substitution
+    //! mapping (conditional likelihoods would be uniform)
+    bool isMissing(int node, int site) const { return missingmap[node][site] == -1; }
 
-    bool isMissing(const Link *link, int site) const {
-        return false;
-        // return (missingmap[link->GetNode()][site] ||
-        // missingmap[link->Out()->GetNode()][site]);
-    }
+    // actual work of Unfold
+    void DoUnfold();
 
     void CreateMissingMap();
     void DeleteMissingMap();
-    void RecursiveCreateMissingMap(const Link *from);
     void FillMissingMap();
-    void BackwardFillMissingMap(const Link *from);
-    void ForwardFillMissingMap(const Link *from, const Link *up);
+    void BackwardFillMissingMap();
+    void ForwardFillMissingMap();
 
-    double *GetCondLikelihood(const Link *from) const {
-        map<const Link *, double *>::const_iterator i = condlmap.find(from);
-        if (i == condlmap.end()) {
-            cerr << "error in PhyloProcess::GetCondLikelihood\n";
-            exit(1);
-        }
-        return i->second;
-    }
+    //! conditional likelihood vector at given node (for the subtree below it)
+    double *GetCondLikelihood(int node) const { return condl.data() + node * (GetNstate() + 1); }
 
-    double GetPruningTime() const { return pruningchrono.GetTime(); }
-    double GetResampleTime() const { return resamplechrono.GetTime(); }
+    //! conditional likelihood vector at the upper end of the branch above
+    //! given node
+    double *GetBranchCondLikelihood(int node) const {
+        return branchcondl.data() + node * (GetNstate() + 1);
+    }
 
-    void RecursiveCreate(const Link *from);
-    void RecursiveDelete(const Link *from);
+    //! same as GetCondLikelihood, for all components of a mixture (one vector
+    //! per component, stored contiguously, see MixtureSiteLogLikelihood)
+    double *GetMixtureCondLikelihood(int node) const {
+        return mixcondl.data() + node * mixncomp * (GetNstate() + 1);
+    }
 
-    void RecursiveCreateTBL(const Link *from);
-    void RecursiveDeleteTBL(const Link *from);
+    //! same as GetBranchCondLikelihood, for all components of a mixture
+    double *GetMixtureBranchCondLikelihood(int node) const {
+        return mixbranchcondl.data() + node * mixncomp * (GetNstate() + 1);
+    }
 
-    void Pruning(const Link *from, int site) const;
-    void ResampleSub(const Link *from, int site);
+    void CreateStatesAndPaths();
+    void DeleteStatesAndPaths();
+
+    void CreateTBL();
+    void DeleteTBL();
+
+    // the following functions iterate over the flat traversal schedule of the
+    // tree (postorder for pruning, preorder for sampling states and paths)
+    void Pruning(int site) const;
+    void MixturePruning(int site, const Selector<SubMatrix> &components) const;
+    //! rescale a conditional likelihood vector (of largest entry max) by a
+    //! power of two, if max < minscale; log of scaling factor added to
+    //! t[Nstate]
+    void RescaleCondLikelihood(double *t, double max) const;
+    //! multiply conditional likelihood vector t by the vector tbl propagated
+    //! from a child (or copy it, if first), rescaling both as needed
+    void MultiplyCondLikelihood(double *t, double *tbl, bool first) const;
+    void CreateMixtureCondLikelihoods(int ncomp) const;
+    void DeleteMixtureCondLikelihoods() const;
+    void ResamplePaths(int site);
     void ResampleState();
     void ResampleState(int site);
-    void PruningAncestral(const Link *from, int site);
-    void PriorSample(const Link *from, int site, bool rootprior);
+    void PruningAncestral(int site);
+    void PriorSample(int site, bool rootprior);
     void PriorSample();
     void RootPosteriorDraw(int site);
 
+    //! \brief posterior predictive simulation of a run of sites sharing the same
+    //! matrices and rate (see PostPredSample(SequenceAlignment*, bool))
+    //!
+    //! root states are drawn site by site, then states are drawn branch by
+    //! branch over all sites of the run, either by simulating the jump chain
+    //! (SubMatrix::DrawFiniteTime), or, when this is expected to be cheaper,
+    //! from the finite time transition probabilities of the branch
+    //! (DrawFromTransitionTable)
+    void PostPredSample(const int *sites, int nsite, bool rootprior);
+
+    //! draw state at the end of a branch of given matrix and time, given state
+    //! at its beginning, from the current transition table (whose rows are
+    //! computed on first use, and should be reset by calling
+    //! ResetTransitionTable before moving to another branch)
+    int DrawFromTransitionTable(const SubMatrix &mat, double time, int stateup) const;
+    void ResetTransitionTable() const;
+
+    //! \brief one segment of a compact substitution history: current state and
+    //! relative waiting time (relative to total branch time) until the next
+    //! event or the end of the branch
+    //!
+    //! A history with n substitutions is encoded as n+1 consecutive segments,
+    //! exactly as the n+1 Plink objects of a BranchSitePath.
+    struct PathSegment {
+        int state;
+        double reltime;
+    };
+
     // borrowed from phylobayes
     // where should that be?
-    BranchSitePath *SamplePath(int stateup, int statedown, double time, double rate,
-                               const SubMatrix &matrix);
-    BranchSitePath *SampleRootPath(int rootstate);
-    BranchSitePath *ResampleAcceptReject(int maxtrial, int stateup, int statedown, double rate,
-                                         double totaltime, const SubMatrix &matrix);
-    BranchSitePath *ResampleUniformized(int stateup, int statedown, double rate, double totaltime,
-                                        const SubMatrix &matrix);
+    // the samplers append the history to path (a site buffer)
+
+    //! \brief sample an endpoint-conditioned path
+    //!
+    //! chooses between rejection sampling (forward simulation, with first
+    //! substitution forced if stateup != statedown, Nielsen 2002) and
+    //! uniformization, based on the predicted acceptance probability of the
+    //! rejection method: a cheap lower bound is tried first (probability of no
+    //! substitution, or of exactly one substitution stateup->statedown); the
+    //! exact acceptance probability (which requires the finite time transition
+    //! probability) is computed only if the bound is below minacceptance.
+    void SamplePath(int stateup, int statedown, double time, double rate,
+                    const SubMatrix &matrix, vector<PathSegment> &path);
+    bool ResampleAcceptReject(int maxtrial, int stateup, int statedown, double rate,
+                              double totaltime, const SubMatrix &matrix,
+                              vector<PathSegment> &path);
+    //! Z: transition probability between stateup and statedown, if already
+    //! computed by caller (otherwise, computed here)
+    void ResampleUniformized(int stateup, int statedown, double rate, double totaltime,
+                             const SubMatrix &matrix, vector<PathSegment> &path, double Z = -1);
+
+    //! make a BranchSitePath out of a compact history (see StorePaths)
+    BranchSitePath *MakePath(const PathSegment *begin, const PathSegment *end) const;
+
+    //! first segment of the history of given node and site
+    const PathSegment *PathBegin(int node, int site) const {
+        return sitepath[site].data() + pathbegin[site * tree->GetNnode() + node];
+    }
+
+    //! one past the last segment of the history of given node and site
+    const PathSegment *PathEnd(int node, int site) const {
+        return sitepath[site].data() + pathend[site * tree->GetNnode() + node];
+    }
+
+    //! add path suff stat of the history of given node and site (waiting times
+    //! are multiplied by factor)
+    void AddSegmentPathSuffStat(int node, int site, PathSuffStat &suffstat, double factor) const;
+
+    //! add length (poisson) suff stat of the history of given node and site
+    void AddSegmentLengthSuffStat(int node, int site, PoissonSuffStat &suffstat, double factor,
+                                  const SubMatrix &mat) const;
 
     const Tree *tree;
     const SequenceAlignment *data;
@@ -318,26 +502,68 @@ class PhyloProcess {
     bool allocsubmatrixarray;
     bool allocrootsubmatrixarray;
 
+    // which constructor was used: determines how the matrix lookup table is
+    // filled (once per pass if site-homogeneous, once per site otherwise)
+    enum MatrixMode { homogeneous, siteheterogeneous, branchheterogeneous, generic };
+    MatrixMode matrixmode;
+    const SubMatrix *homogeneousmatrix;
+    const Selector<SubMatrix> *sitematrixarray;
+    const BranchSelector<SubMatrix> *branchmatrixarray;
+
+    // lookup tables (see LoadBranches and LoadSite)
+    mutable vector<const SubMatrix *> branchmatrix;
+    mutable vector<double> branchlengthtable;
+    mutable double currentrate;
+
     int *sitearray;
     mutable double *sitelnL;
 
+    // cached log likelihood (see GetLogLikelihood), and state of the process
+    // for which it was computed (see isLikelihoodUpToDate)
+    mutable bool lnLcached;
+    mutable double lnLtotal;
+    mutable vector<double> lnLbranchlength;
+    mutable vector<double> lnLsiterate;
+    mutable vector<std::pair<const SubMatrix *, unsigned long>> lnLmatrix;
+
     int Nstate;
 
     bool clampdata;
 
-    BranchSitePath *GetPath(const Node *node, int site) {
-        if (pathmap[node][site] == nullptr) {
-            std::cerr << "error in phyloprocess::getpath: null path\n";
-            exit(1);
-        }
-        return pathmap[node][site];
-    }
-
-    mutable std::map<const Link *, double *> condlmap;
-    mutable std::map<const Node *, BranchSitePath **> pathmap;
-    mutable std::map<const Node *, int *> statemap;
+    // conditional likelihoods, indexed by node (see GetCondLikelihood and
+    // GetBranchCondLikelihood)
+    mutable vector<double> condl;
+    mutable vector<double> branchcondl;
+    // conditional likelihoods for all components of a mixture (see
+    // MixtureSiteLogLikelihood), allocated on first use
+    mutable vector<double> mixcondl;
+    mutable vector<double> mixbranchcondl;
+    mutable int mixncomp;
+    // states, indexed by node
+    vector<int *> statemap;
+    // compact substitution histories: for each site, the histories of all
+    // nodes (in preorder), with, for each site and node, the range of
+    // segments of the history of that node
+    vector<vector<PathSegment>> sitepath;
+    vector<int> pathbegin;
+    vector<int> pathend;
+    // transition table (see DrawFromTransitionTable): for each initial state a,
+    // alias table (Random::MakeAliasTable) of the finite time transition
+    // probabilities along the current branch, at offset a*Nstate, and valid if
+    // transrowflag[a]
+    mutable vector<double> transprob;
+    mutable vector<int> transalias;
+    mutable vector<char> transrowflag;
+    // detailed substitution histories, indexed by node (only if storepaths)
+    bool storepaths;
+    vector<BranchSitePath **> pathmap;
     // std::map<const Node *, int> totmissingmap;
 
+    // for each node and site (see FillMissingMap):
+    // -1: no observed leaf below node (see isMissing)
+    //  0: node above the subtree spanned by the observed leaves
+    //  1: branch above node is in that subtree (suff stats are collected)
+    //  2: node is the root of that subtree (root count)
     int **missingmap;
 
     int maxtrial;
@@ -345,8 +571,37 @@ class PhyloProcess {
 
     static const int DEFAULTMAXTRIAL = 100;
 
-    mutable Chrono pruningchrono;
-    mutable Chrono resamplechrono;
+    // below this predicted acceptance probability, paths are sampled by
+    // uniformization rather than by rejection (see SamplePath)
+    static constexpr double minacceptance = 0.1;
+    // maximum number of trials of the rejection method, before falling back to
+    // uniformization
+    static const int MAXREJECTIONTRIAL = 1000;
+
+    // conditional likelihood vectors are left unnormalized during pruning,
+    // until their largest entry falls below this threshold (far enough from
+    // the underflow limit for the product of two vectors; products over the
+    // children of a node are rescaled child after child)
+    static constexpr double minscale = 1e-75;
+
+    // cost of computing one entry of a transition table, of one draw from it,
+    // and of diagonalizing a matrix (per Nstate^3), relative to the cost of
+    // one step of the jump chain (as measured for codon matrices), used by
+    // PostPredSample to decide, for each branch, whether to draw states from a
+    // transition table or by simulating the jump chain
+    static constexpr double TABLECOST = 0.03;
+    static constexpr double DRAWCOST = 0.6;
+    static constexpr double DIAGCOST = 0.4;
+
+    // processes waiting to be unfolded (see DeferUnfold)
+    static bool deferunfold;
+    static vector<PhyloProcess *> deferred;
+
+    // usage counters of path sampling methods
+    static unsigned long nrejectionpath;
+    static unsigned long nrejectiontrial;
+    static unsigned long nrejectionfail;
+    static unsigned long nuniformizedpath;
 };
 
 #endif  // PHYLOPROCESS_H
@@ -258,6 +258,13 @@ class PoissonSuffStatBranchArray : public SimpleBranchArray<PoissonSuffStat> {
     //! PhyloProcess
     void AddLengthPathSuffStat(const PhyloProcess &process) { process.AddLengthSuffStat(*this); }
 
+    //! same thing, from a PhyloProcess running over a restriction of the tree
+    //! of this array (see PhyloProcess::AddLengthSuffStat)
+    void AddLengthPathSuffStat(const PhyloProcess &process, const vector<vector<int>> &collapsed,
+                               const BranchSelector<double> &branchlength) {
+        process.AddLengthSuffStat(*this, collapsed, branchlength);
+    }
+
     //! return array size when put into an MPI buffer
     unsigned int GetMPISize() const { return 2 * GetNbranch(); }
 
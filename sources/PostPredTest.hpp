@@ -0,0 +1,235 @@
+#ifndef POSTPREDTEST_H
+#define POSTPREDTEST_H
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "CodonSequenceAlignment.hpp"
+#include "MPIBuffer.hpp"
+
+/**
+ * \brief A summary statistic of a codon alignment, used for posterior
+ * predictive checks
+ *
+ * The posterior predictive p-value is the fraction of replicates that are more
+ * extreme than the observed alignment: larger than observed if IsUpperTail()
+ * (the default), smaller otherwise. Statistics are stateless, so that the same
+ * instance can be shared among all PostPredTest objects.
+ */
+
+class PostPredStat {
+  public:
+    virtual ~PostPredStat() {}
+
+    //! short name (used as a column prefix in tables)
+    virtual string GetName() const = 0;
+    //! one-line description
+    virtual string GetDescription() const = 0;
+    //! value of the statistic for the given alignment
+    virtual double GetValue(const CodonSequenceAlignment &ali) const = 0;
+    //! whether large values are the extreme ones
+    virtual bool IsUpperTail() const { return true; }
+};
+
+//! mean number of distinct amino-acids per site
+class MeanAADiversityStat : public PostPredStat {
+  public:
+    string GetName() const override { return "aadiv"; }
+    string GetDescription() const override { return "mean site-specific amino-acid diversity"; }
+    double GetValue(const CodonSequenceAlignment &ali) const override {
+        return ali.GetMeanAADiversity();
+    }
+    bool IsUpperTail() const override { return false; }
+};
+
+//! mean pairwise fraction of differing codons
+class MeanDiffStat : public PostPredStat {
+  public:
+    string GetName() const override { return "diff"; }
+    string GetDescription() const override { return "mean pairwise divergence"; }
+    double GetValue(const CodonSequenceAlignment &ali) const override { return ali.GetMeanDiff(); }
+};
+
+//! mean pairwise ratio of non-synonymous over total differences
+class MeanEmpiricaldNdSStat : public PostPredStat {
+  public:
+    string GetName() const override { return "dnds"; }
+    string GetDescription() const override { return "mean empirical dNdS"; }
+    double GetValue(const CodonSequenceAlignment &ali) const override {
+        return ali.GetMeanEmpiricaldNdS();
+    }
+};
+
+/**
+ * \brief Streaming posterior predictive test over a set of statistics
+ *
+ * The observed values are given once (SetObserved); each simulated replicate
+ * is then passed to AddReplicate, which updates, for each statistic, the
+ * running mean and sum of squared deviations (Welford's algorithm) and the
+ * count of replicates more extreme than observed. Replicates therefore need
+ * not be kept in memory (or on disk).
+ *
+ * By default, the test uses aa diversity, pairwise divergence and empirical
+ * dN/dS (as the ppredtest program); other statistics can be added with AddStat
+ * (before calling SetObserved).
+ *
+ * Partial tests computed on disjoint sets of replicates (e.g. by different MPI
+ * processes) can be merged with Add. For MPI communication, the observed values
+ * are included in the buffer, so that a PostPredTest received on a process
+ * that does not have the data is complete.
+ */
+
+class PostPredTest {
+  public:
+    //! constructor, with the default set of statistics
+    PostPredTest() : stat(GetDefaultStats()), n(0) { Reset(); }
+
+    //! constructor, with the default set of statistics and observed alignment
+    PostPredTest(const CodonSequenceAlignment &obsdata) : PostPredTest() {
+        SetObserved(obsdata);
+    }
+
+    //! add a statistic to the test (not owned by the test, should outlive it)
+    void AddStat(const PostPredStat *instat) {
+        stat.push_back(instat);
+        Reset();
+    }
+
+    //! return number of statistics
+    int GetNstat() const { return stat.size(); }
+
+    //! compute observed values and reset replicate accumulators
+    void SetObserved(const CodonSequenceAlignment &obsdata) {
+        Reset();
+        for (int i = 0; i < GetNstat(); i++) {
+            obs[i] = stat[i]->GetValue(obsdata);
+        }
+    }
+
+    //! account for one simulated replicate
+    void AddReplicate(const CodonSequenceAlignment &repdata) {
+        n++;
+        for (int i = 0; i < GetNstat(); i++) {
+            double x = stat[i]->GetValue(repdata);
+            double delta = x - mean[i];
+            mean[i] += delta / n;
+            m2[i] += delta * (x - mean[i]);
+            if (stat[i]->IsUpperTail() ? (x > obs[i]) : (x < obs[i])) {
+                pp[i]++;
+            }
+        }
+    }
+
+    //! merge with a test computed over another set of replicates
+    void Add(const PostPredTest &from) {
+        if (!from.n) {
+            return;
+        }
+        double tot = n + from.n;
+        for (int i = 0; i < GetNstat(); i++) {
+            double delta = from.mean[i] - mean[i];
+            mean[i] += delta * from.n / tot;
+            m2[i] += from.m2[i] + delta * delta * n * from.n / tot;
+            pp[i] += from.pp[i];
+            if (!n) {
+                obs[i] = from.obs[i];
+            }
+        }
+        n = tot;
+    }
+
+    //! return number of replicates
+    int GetNrep() const { return n; }
+    //! return observed value of statistic i
+    double GetObs(int i) const { return obs[i]; }
+    //! return mean predicted value of statistic i
+    double GetMean(int i) const { return mean[i]; }
+    //! return variance of predicted values of statistic i
+    double GetVar(int i) const { return n ? m2[i] / n : 0; }
+    //! return z-score of observed value of statistic i
+    double GetZ(int i) const { return (mean[i] - obs[i]) / sqrt(GetVar(i)); }
+    //! return posterior predictive p-value of statistic i
+    double GetPP(int i) const { return n ? pp[i] / n : 0; }
+
+    //! formatted output (one block per statistic, as in ppredtest)
+    void ToStream(ostream &os) const {
+        for (int i = 0; i < GetNstat(); i++) {
+            os << '\n';
+            os << stat[i]->GetDescription() << '\n';
+            os << "obs  : " << GetObs(i) << '\n';
+            os << "pred : " << GetMean(i) << '\n';
+            os << "z    : " << GetZ(i) << '\n';
+            os << "pp   : " << GetPP(i) << '\n';
+        }
+        os << '\n';
+    }
+
+    //! header of tabulated output (see TableRow)
+    void TableHeader(ostream &os) const {
+        for (int i = 0; i < GetNstat(); i++) {
+            string s = stat[i]->GetName();
+            os << '\t' << s << "_obs\t" << s << "_pred\t" << s << "_z\t" << s << "_pp";
+        }
+    }
+
+    //! tabulated output (on one line, tab-separated, no end-of-line)
+    void TableRow(ostream &os) const {
+        for (int i = 0; i < GetNstat(); i++) {
+            os << '\t' << GetObs(i) << '\t' << GetMean(i) << '\t' << GetZ(i) << '\t'
+               << GetPP(i);
+        }
+    }
+
+    //! return size of object, when put into an MPI buffer
+    unsigned int GetMPISize() const { return 1 + 4 * GetNstat(); }
+
+    //! put object into MPI buffer
+    void MPIPut(MPIBuffer &buffer) const {
+        buffer << n;
+        for (int i = 0; i < GetNstat(); i++) {
+            buffer << obs[i] << mean[i] << m2[i] << pp[i];
+        }
+    }
+
+    //! read object from MPI buffer
+    void MPIGet(const MPIBuffer &buffer) {
+        buffer >> n;
+        for (int i = 0; i < GetNstat(); i++) {
+            buffer >> obs[i] >> mean[i] >> m2[i] >> pp[i];
+        }
+    }
+
+    //! read a test from MPI buffer and merge it with this one
+    void Add(const MPIBuffer &buffer) {
+        PostPredTest tmp(*this);
+        tmp.MPIGet(buffer);
+        Add(tmp);
+    }
+
+  private:
+    void Reset() {
+        n = 0;
+        obs.assign(GetNstat(), 0);
+        mean.assign(GetNstat(), 0);
+        m2.assign(GetNstat(), 0);
+        pp.assign(GetNstat(), 0);
+    }
+
+    static const vector<const PostPredStat *> &GetDefaultStats() {
+        static const MeanAADiversityStat aadiv;
+        static const MeanDiffStat diff;
+        static const MeanEmpiricaldNdSStat dnds;
+        static const vector<const PostPredStat *> v = {&aadiv, &diff, &dnds};
+        return v;
+    }
+
+    vector<const PostPredStat *> stat;
+    int n;
+    vector<double> obs;
+    vector<double> mean;
+    vector<double> m2;
+    vector<double> pp;
+};
+
+#endif
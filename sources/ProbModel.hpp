@@ -3,9 +3,13 @@
 
 #include <iostream>
 #include <set>
+#include "PerfCounters.hpp"
 #include "Random.hpp"
 using namespace std;
 
+class SequenceAlignment;
+class CodonSequenceAlignment;
+
 /**
  * \brief A generic interface for MCMC probabilistic models
  *
@@ -45,6 +49,16 @@ class ProbModel {
         exit(1);
     }
 
+    //! posterior predictive simulation into an existing alignment (typically, a
+    //! copy of the data returned by GetCodonData)
+    virtual void PostPredSimu(SequenceAlignment &simu) {
+        cerr << "error: in ProbModel::PostPredSimu\n";
+        exit(1);
+    }
+
+    //! return the codon alignment on which the model is conditioned (if any)
+    virtual const CodonSequenceAlignment *GetCodonData() const { return nullptr; }
+
     //! return lof prob of the current model configuration
     virtual double GetLogProb() const { return 0; }
 
@@ -84,6 +98,7 @@ class ProbModel {
     double SlidingMove(double &x, double tuning, int nrep, double min, double max,
                        LogProbF<C> logprobf, UpdateF<C> updatef, C *This) {
         // C* This = dynamic_cast<C*>(this);
+        PERF_TIMER(SlidingMove);
 
         double nacc = 0;
         double ntot = 0;
@@ -113,6 +128,7 @@ class ProbModel {
             }
             ntot++;
         }
+        PERF_COUNT(SlidingMove, ntot, nacc);
         return nacc / ntot;
     }
 
@@ -126,6 +142,7 @@ class ProbModel {
     template <class C>
     double ScalingMove(double &x, double tuning, int nrep, LogProbF<C> logprobf, UpdateF<C> updatef,
                        C *This) {
+        PERF_TIMER(ScalingMove);
         double nacc = 0;
         double ntot = 0;
         for (int rep = 0; rep < nrep; rep++) {
@@ -145,6 +162,7 @@ class ProbModel {
             }
             ntot++;
         }
+        PERF_COUNT(ScalingMove, ntot, nacc);
         return nacc / ntot;
     }
 
@@ -159,6 +177,7 @@ class ProbModel {
     template <class C>
     double ProfileMove(vector<double> &x, double tuning, int n, int nrep, LogProbF<C> logprobf,
                        UpdateF<C> updatef, C *This) {
+        PERF_TIMER(ProfileMove);
         double nacc = 0;
         double ntot = 0;
         vector<double> bk(x.size(), 0);
@@ -178,6 +197,7 @@ class ProbModel {
             }
             ntot++;
         }
+        PERF_COUNT(ProfileMove, ntot, nacc);
         return nacc / ntot;
     }
 };
@@ -0,0 +1,135 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "BranchArray.hpp"
+#include "GTRSubMatrix.hpp"
+#include "PhyloProcess.hpp"
+
+/**
+ * \brief Check of the rescaling of conditional likelihoods in pruning
+ *
+ * The tree has a multifurcating root, with nchild subtrees of 16 leaves each
+ * (under a star), for a nucleotide GTR matrix close to Jukes-Cantor. At each site, each
+ * subtree has 4 leaves in each state, and leaf branches are so short that the
+ * conditional likelihood vector of each subtree has its largest entry just
+ * above PhyloProcess::minscale (about 2e-75), hence is left unnormalized. The
+ * product over the children of the root (about 1e-75^nchild) is far below
+ * the smallest double, and is only representable if it is rescaled along the
+ * way. The log likelihood given by PhyloProcess::GetLogLikelihood is compared
+ * to the one obtained by a plain pruning in long double (whose exponent range
+ * is large enough here). Exits with a non-zero status if they differ.
+ *
+ * usage: pruningtest [nchild]
+ */
+
+static const int nleaf = 16;
+
+// plain pruning in long double, over the subtree below node
+static void LongPruning(const Tree &tree, const SequenceAlignment &data,
+                        const BranchSelector<double> &bl, const SubMatrix &m, int node, int site,
+                        vector<long double> &t) {
+    int N = m.GetNstate();
+    if (tree.isLeafNode(node)) {
+        t.assign(N, 0);
+        t[data.GetState(node, site)] = 1;
+        return;
+    }
+    t.assign(N, 1);
+    for (int c = tree.GetChildBegin(node); c < tree.GetChildEnd(node); c++) {
+        int child = tree.GetChild(c);
+        vector<long double> up;
+        LongPruning(tree, data, bl, m, child, site, up);
+        double length = bl.GetVal(tree.GetNodeBranch(child));
+        for (int k = 0; k < N; k++) {
+            long double tot = 0;
+            for (int l = 0; l < N; l++) {
+                tot += m.GetFiniteTimeTransitionProb(k, l, length) * up[l];
+            }
+            t[k] *= tot;
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int nchild = 6;
+    if (argc > 1) {
+        nchild = atoi(argv[1]);
+    }
+    if (nchild < 2) {
+        cerr << "usage: pruningtest [nchild]\n";
+        exit(1);
+    }
+    int nsite = 3;
+
+    // tree and alignment, written to (temporary) files
+    string treefile = "pruningtest.tree";
+    string datafile = "pruningtest.ali";
+    {
+        ofstream tos(treefile.c_str());
+        ofstream dos(datafile.c_str());
+        dos << nchild * nleaf << '\t' << nsite << '\n';
+        tos << '(';
+        for (int i = 0; i < nchild; i++) {
+            tos << (i ? ",(" : "(");
+            for (int j = 0; j < nleaf; j++) {
+                ostringstream name;
+                name << 'T' << i << '_' << j;
+                tos << (j ? "," : "") << name.str();
+                dos << name.str() << '\t';
+                for (int site = 0; site < nsite; site++) {
+                    dos << "ACGT"[(j + site * i) % Nnuc];
+                }
+                dos << '\n';
+            }
+            tos << ')';
+        }
+        tos << ");\n";
+    }
+    FileSequenceAlignment data(datafile);
+    Tree tree(treefile);
+    remove(treefile.c_str());
+    remove(datafile.c_str());
+    tree.RegisterWith(data.GetTaxonSet());
+    tree.SetIndices();
+
+    // normalized GTR, close to Jukes-Cantor (but with distinct eigenvalues):
+    // the probability of a change into a given state over a short branch of
+    // length l is about l/3; with l = 1.8e-6, each subtree has a likelihood of
+    // about (l/3)^12 = 2e-75 in each state
+    vector<double> rr = {1.0, 1.1, 0.9, 1.2, 0.8, 1.05};
+    vector<double> stat = {0.24, 0.26, 0.25, 0.25};
+    GTRSubMatrix matrix(Nnuc, rr, stat, true);
+    SimpleBranchArray<double> branchlength(tree, 0.01);
+    for (int node = 0; node < tree.GetNnode(); node++) {
+        if (tree.isLeafNode(node)) {
+            branchlength[tree.GetNodeBranch(node)] = 1.8e-6;
+        }
+    }
+
+    PhyloProcess process(&tree, &data, &branchlength, 0, &matrix);
+    process.Unfold();
+    double lnL = process.GetLogLikelihood();
+
+    double reflnL = 0;
+    for (int site = 0; site < nsite; site++) {
+        vector<long double> t;
+        LongPruning(tree, data, branchlength, matrix, tree.GetRootNode(), site, t);
+        long double tot = 0;
+        for (int k = 0; k < Nnuc; k++) {
+            tot += stat[k] * t[k];
+        }
+        reflnL += log(tot);
+    }
+
+    cout << "children at root: " << nchild << '\n';
+    cout << "log likelihood (pruning):     " << lnL << '\n';
+    cout << "log likelihood (long double): " << reflnL << '\n';
+    if (!(fabs(lnL - reflnL) < 1e-6 * fabs(reflnL))) {
+        cout << "FAILED\n";
+        exit(1);
+    }
+    cout << "ok\n";
+}
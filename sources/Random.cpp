@@ -40,6 +40,17 @@ int Random::Seed = 0;
 int Random::mt_index = 0;
 unsigned long long Random::mt_buffer[MT_LEN];
 
+uint64_t Random::xo_state[4][XO_LANES];
+uint64_t Random::block[XO_BLOCK];
+int Random::block_index = XO_BLOCK;
+
+uint32_t Random::ke[256];
+double Random::we[256];
+double Random::fe[256];
+uint32_t Random::kn[128];
+double Random::wn[128];
+double Random::fn[128];
+
 const double Random::INFPROB = -250;
 
 // ---------------------------------------------------------------------------------
@@ -65,6 +76,21 @@ void Random::InitRandom(int seed) {
         }
     }
     mt_index = 0;
+
+    // seeding each xoshiro256+ lane with splitmix64 (Vigna 2014)
+    uint64_t x = (uint64_t)(unsigned int)seed;
+    for (int l = 0; l < XO_LANES; l++) {
+        for (int k = 0; k < 4; k++) {
+            x += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            xo_state[k][l] = z ^ (z >> 31);
+        }
+    }
+    block_index = XO_BLOCK;
+
+    MakeZiggurat();
 }
 
 Random::Random(int seed) { InitRandom(seed); }
@@ -72,9 +98,9 @@ Random::Random(int seed) { InitRandom(seed); }
 int Random::GetSeed() { return Seed; }
 
 // ---------------------------------------------------------------------------------
-//		 Uniform()
+//		 MTUniform()
 // ---------------------------------------------------------------------------------
-double Random::Uniform() {
+double Random::MTUniform() {
     // Mersenne twister
     // Matsumora and Nishimora 1996
     // 32-bit generator
@@ -187,6 +213,48 @@ int Random::DrawFromDiscreteDistribution(const std::vector<double> &prob) {
     }
 }
 
+void Random::MakeAliasTable(const double *p, int n, double *prob, int *alias) {
+    double total = 0;
+    for (int k = 0; k < n; k++) {
+        total += p[k];
+    }
+    if (total <= 0) {
+        std::cerr << "error in Random::MakeAliasTable: null total weight\n";
+        exit(1);
+    }
+    std::vector<int> small;
+    std::vector<int> large;
+    small.reserve(n);
+    large.reserve(n);
+    for (int k = 0; k < n; k++) {
+        prob[k] = p[k] * n / total;
+        alias[k] = k;
+        if (prob[k] < 1) {
+            small.push_back(k);
+        } else {
+            large.push_back(k);
+        }
+    }
+    while (!small.empty() && !large.empty()) {
+        int s = small.back();
+        small.pop_back();
+        int l = large.back();
+        alias[s] = l;
+        prob[l] -= 1 - prob[s];
+        if (prob[l] < 1) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // left over because of rounding errors
+    for (int k : large) {
+        prob[k] = 1;
+    }
+    for (int k : small) {
+        prob[k] = 1;
+    }
+}
+
 // ---------------------------------------------------------------------------------
 //		 DrawFromDiscreteDistribution()
 // ---------------------------------------------------------------------------------
@@ -306,175 +374,170 @@ int Random::FiniteDiscrete(int n, const double *probarray) {
     delete[] cumul;
     return k;
 }
-
 // ---------------------------------------------------------------------------------
-//		 sNormal()
+//		 FillBlock()
 // ---------------------------------------------------------------------------------
-double Random::sNormal() {
-    double u = Random::Uniform();
-    if (u <= 0.8638) {
-        double v = 2 * Random::Uniform() - 1;
-        double w = 2 * Random::Uniform() - 1;
-        return 2.3153508 * u - 1 + v + w;
-    }
-    if ((0.8638 < u) && (u <= 0.9745)) {
-        double v = Random::Uniform();
-        return 1.5 * (v - 1 + 9.0334237 * (u - 0.8638));
-    } else if ((0.9973002 < u) && (u <= 1)) {
-        double x, v;
-        do {
-            v = Random::Uniform();
-            double w = Random::Uniform();
-            x = 4.5 - log(w);
-        } while (x * v * v > 4.5);
-        // double ret = (u - 0.9986501) > 0 ? sqrt(2 * x) : - sqrt(2 * x);
-        double ret = sqrt(2 * x);
-        if (u - 0.9986501 > 0) {
-            ret = -ret;
-        }
-        return ret;
-    }
-    double x, v, w, tot;
-    do {
-        x = 6 * Random::Uniform() - 3;
-        u = Random::Uniform();
-        v = (x > 0) ? x : -x;
-        w = 6.6313339 * (3 - v) * (3 - v);
-        tot = 0;
-        if (v < 1.5) {
-            tot += 6.0432809 * (1.5 - v);
-        }
-        if (v < 1) {
-            tot += 13.2626678 * (3 - v * v) - w;
-        }
-    } while (u > 49.0024445 * SAFE_EXP(-0.5 * v * v) - tot - w);
-    return x;
+void Random::FillBlock() {
+    // xoshiro256+ (Blackman and Vigna 2018), XO_LANES independent streams
+    // advanced in lockstep; state is kept in local arrays during the loop
+    uint64_t s0[XO_LANES], s1[XO_LANES], s2[XO_LANES], s3[XO_LANES];
+    for (int l = 0; l < XO_LANES; l++) {
+        s0[l] = xo_state[0][l];
+        s1[l] = xo_state[1][l];
+        s2[l] = xo_state[2][l];
+        s3[l] = xo_state[3][l];
+    }
+    for (int b = 0; b < XO_BLOCK; b += XO_LANES) {
+        for (int l = 0; l < XO_LANES; l++) {
+            block[b + l] = s0[l] + s3[l];
+            uint64_t t = s1[l] << 17;
+            s2[l] ^= s0[l];
+            s3[l] ^= s1[l];
+            s1[l] ^= s2[l];
+            s0[l] ^= s3[l];
+            s2[l] ^= t;
+            s3[l] = (s3[l] << 45) | (s3[l] >> 19);
+        }
+    }
+    for (int l = 0; l < XO_LANES; l++) {
+        xo_state[0][l] = s0[l];
+        xo_state[1][l] = s1[l];
+        xo_state[2][l] = s2[l];
+        xo_state[3][l] = s3[l];
+    }
+    block_index = 0;
 }
 
 // ---------------------------------------------------------------------------------
-//		 sExpo()
+//		 MakeZiggurat()
 // ---------------------------------------------------------------------------------
-double Random::sExpo() { return -log(Random::Uniform()); }
-
-double fsign(double num, double sign)
-/* Transfers sign of argument sign to argument num */
-{
-    if ((sign > 0.0f && num < 0.0f) || (sign < 0.0f && num > 0.0f)) {
-        return -num;
-    } else {
-        return num;
+void Random::MakeZiggurat() {
+    // tables of Marsaglia and Tsang (2000)
+    const double m1 = 2147483648.0;
+    const double m2 = 4294967296.0;
+
+    // normal: 128 layers
+    double dn = 3.442619855899;
+    double tn = dn;
+    double vn = 9.91256303526217e-3;
+    double q = vn / exp(-0.5 * dn * dn);
+    kn[0] = (uint32_t)((dn / q) * m1);
+    kn[1] = 0;
+    wn[0] = q / m1;
+    wn[127] = dn / m1;
+    fn[0] = 1.0;
+    fn[127] = exp(-0.5 * dn * dn);
+    for (int i = 126; i >= 1; i--) {
+        dn = sqrt(-2 * log(vn / dn + exp(-0.5 * dn * dn)));
+        kn[i + 1] = (uint32_t)((dn / tn) * m1);
+        tn = dn;
+        fn[i] = exp(-0.5 * dn * dn);
+        wn[i] = dn / m1;
+    }
+
+    // exponential: 256 layers
+    double de = 7.697117470131487;
+    double te = de;
+    double ve = 3.949659822581572e-3;
+    q = ve / exp(-de);
+    ke[0] = (uint32_t)((de / q) * m2);
+    ke[1] = 0;
+    we[0] = q / m2;
+    we[255] = de / m2;
+    fe[0] = 1.0;
+    fe[255] = exp(-de);
+    for (int i = 254; i >= 1; i--) {
+        de = -log(ve / de + exp(-de));
+        ke[i + 1] = (uint32_t)((de / te) * m2);
+        te = de;
+        fe[i] = exp(-de);
+        we[i] = de / m2;
     }
 }
 
 // ---------------------------------------------------------------------------------
-//		 sGamma()
+//		 sNormal()
 // ---------------------------------------------------------------------------------
-double Random::sGamma(double a) {
-    if (a > 1) {
-        static double a1 = 0;
-        static double a2 = 0;
-
-        static double s2, s, d, t, x, u, q0, b, sigma, c, v, q, e;
-
-        // step 1
-        if (a != a1) {
-            a1 = a;
-            s2 = a - 0.5;
-            s = sqrt(s2);
-            d = 4 * sqrt(2.0) - 12 * s;
-        }
-
-        // step 2
-        t = sNormal();
-        x = s + 0.5 * t;
-        if (t > 0) {
-            if (x == 0.0) {
-                std::cerr << "1\n";
-            }
-            return x * x;
+double Random::NormalFix(int32_t h, int i) {
+    // right boundary of the base layer
+    const double r = 3.442619855899;
+    while (true) {
+        double x = h * wn[i];
+        if (i == 0) {
+            // tail (Marsaglia 1964)
+            double y;
+            do {
+                x = -log(Uniform()) / r;
+                y = -log(Uniform());
+            } while (y + y < x * x);
+            return (h > 0) ? r + x : -r - x;
         }
-
-        // step 3
-        u = Uniform();
-        if (d * u < t * t * t) {
-            if (x == 0.0) {
-                std::cerr << "2\n";
-            }
-            return x * x;
-        }
-
-        // step 4
-        if (a != a2) {
-            a2 = a;
-            q0 = log(sqrt(2 * Pi)) - logGamma(a) - s2 + s2 * log(s2);
-            if (a < 3.686) {
-                b = 0.463 + s + 0.178 * s2;
-                sigma = 1.235;
-                c = 0.195 / s - 0.079 + 0.16 * s;
-            } else if (a < 13.022) {
-                b = 1.654 + 0.0076 * s2;
-                sigma = 1.68 / s + 0.275;
-                c = 0.062 / s + 0.024;
-            } else {
-                b = 1.77;
-                sigma = 0.75;
-                c = 0.1515 / s;
-            }
+        if (fn[i] + Uniform() * (fn[i - 1] - fn[i]) < exp(-0.5 * x * x)) {
+            return x;
         }
+        uint64_t b = RawBits();
+        h = (int32_t)(uint32_t)(b >> 32);
+        i = (int)((b >> 11) & 127);
+        uint32_t a = (h < 0) ? 0u - (uint32_t)h : (uint32_t)h;
+        if (a < kn[i]) {
+            return h * wn[i];
+        }
+    }
+}
 
-        // step 5-7
-        if (x > 0) {
-            v = 0.5 * t / s;
-            q = q0 - s * t + 0.25 * t * t + 2 * s2 * log(1.0 + v);
-            if (log(1 - u) < q) {
-                if (x == 0.0) {
-                    std::cerr << "3\n";
-                }
-                return x * x;
-            }
+// ---------------------------------------------------------------------------------
+//		 sExpo()
+// ---------------------------------------------------------------------------------
+double Random::ExpoFix(uint32_t j, int i) {
+    // right boundary of the base layer
+    const double r = 7.697117470131487;
+    while (true) {
+        if (i == 0) {
+            // tail: memoryless
+            return r - log(Uniform());
+        }
+        double x = j * we[i];
+        if (fe[i] + Uniform() * (fe[i - 1] - fe[i]) < exp(-x)) {
+            return x;
+        }
+        uint64_t b = RawBits();
+        j = (uint32_t)(b >> 32);
+        i = (int)((b >> 11) & 255);
+        if (j < ke[i]) {
+            return j * we[i];
         }
+    }
+}
 
+// ---------------------------------------------------------------------------------
+//		 sGamma()
+// ---------------------------------------------------------------------------------
+double Random::sGamma(double a) {
+    // Marsaglia and Tsang (2000)
+    if (a < 1) {
+        // if y ~ Gamma(a+1) and u ~ Uniform(0,1), then y u^(1/a) ~ Gamma(a)
+        double u = Uniform();
+        return sGamma(a + 1) * SAFE_EXP(log(u) / a);
+    }
+    double d = a - 1.0 / 3;
+    double c = 1.0 / sqrt(9 * d);
+    while (true) {
+        double x, v;
         do {
-            do {
-                e = sExpo();
-                u = Uniform();
-                u = u + u - 1;
-                t = fabs(e * sigma);
-                if (u < 0) {
-                    t = -t;
-                }
-                t += b;
-            } while (t <= -0.71874483771719);
-
-            v = 0.5 * t / s;
-            q = q0 - s * t + 0.25 * t * t + 2 * s2 * log(1.0 + v);
+            x = sNormal();
+            v = 1 + c * x;
+        } while (v <= 0);
+        v = v * v * v;
+        double u = Uniform();
+        double x2 = x * x;
+        // squeeze
+        if (u < 1 - 0.0331 * x2 * x2) {
+            return d * v;
+        }
+        if (log(u) < 0.5 * x2 + d * (1 - v + log(v))) {
+            return d * v;
         }
-
-        while ((q < 0) || (c * fabs(u) > (exp(q) - 1) * exp(e - 0.5 * t * t)));
-
-        x = s + 0.5 * t;
-        /*
-          if (!x)	{
-          std::cerr << "4\n";
-          std::cerr << s << '\t' << t << '\n';
-          std::cerr << e << '\t' << sigma << '\t' << u << '\n';
-          std::cerr << b << '\n';
-          }
-        */
-        return x * x;
     }
-
-    double x, y;
-    do {
-        double u = Random::Uniform();
-        double v = Random::Uniform();
-        x = SAFE_EXP(log(u) / a);
-        y = SAFE_EXP(log(v) / (1 - a));
-    } while (x + y > 1);
-
-    double e = -log(Random::Uniform());
-
-    return e * x / (x + y);
 }
 
 // ---------------------------------------------------------------------------------
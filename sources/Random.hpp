@@ -12,6 +12,9 @@ typedef Eigen::VectorXd EVector;
 using namespace std;
 
 #define MT_LEN 624  // (VL) required for magic
+#define XO_LANES 4      // number of interleaved xoshiro256+ streams
+#define XO_BLOCK 256    // number of 64-bit words generated per block
+#include <cstdint>
 #include <vector>
 
 // c++11
@@ -22,11 +25,22 @@ const double Pi = 3.1415926535897932384626;
 /**
  * \brief A random number generator and probability library
  *
- * Implements Mersenne twister
- * (Matsumora and Nishimora 1996, 32-bit generator; implementation adapted from
- * Michael Brundage, copyright 1995-2005, creative commons), plus many basic
- * routines related to probabilities: in particular, sampling from standard
- * distributions and returning their densities).
+ * Random bits are produced by XO_LANES interleaved xoshiro256+ generators
+ * (Blackman and Vigna 2018), each seeded by splitmix64 from the global seed,
+ * and advanced in lockstep so as to fill blocks of XO_BLOCK 64-bit words at
+ * once (this inner loop has no dependency across lanes and is vectorized by
+ * the compiler). Uniform(), sExpo() and sNormal() consume this block and are
+ * inline; exponential and normal variates use the ziggurat method (Marsaglia
+ * and Tsang 2000), and gamma variates the squeeze method of Marsaglia and
+ * Tsang (2000), which keeps no state across calls.
+ *
+ * The Mersenne twister (Matsumora and Nishimora 1996, 32-bit generator;
+ * implementation adapted from Michael Brundage, copyright 1995-2005, creative
+ * commons) previously used for all draws is still available as MTUniform(),
+ * for reference (see randombench).
+ *
+ * Also implements many basic routines related to probabilities: in particular,
+ * sampling from standard distributions and returning their densities).
  */
 
 class Random {
@@ -39,7 +53,10 @@ class Random {
 
     static int GetSeed();
 
+    //! uniform draw over (0,1), boundaries excluded
     static double Uniform();
+    //! uniform draw using the Mersenne twister (former generator)
+    static double MTUniform();
     static int ApproxBinomial(int N, double p);
     static int Poisson(double mu);
     static double Gamma(double alpha, double beta);
@@ -55,6 +72,13 @@ class Random {
     static int DrawFromDiscreteDistribution(const double *prob, int nstate);
     static int DrawFromDiscreteDistribution(const std::vector<double> &prob);
 
+    //! build alias table (Walker 1977, Vose 1991) for drawing in constant time
+    //! from the discrete distribution of (unnormalized) weights p over n states
+    //! (p and prob can be the same array)
+    static void MakeAliasTable(const double *p, int n, double *prob, int *alias);
+    //! draw from alias table built by MakeAliasTable
+    static int DrawFromAliasTable(const double *prob, const int *alias, int n);
+
     static double logGamma(double alpha);
 
     static double logMultivariateGamma(double a, int p);
@@ -83,6 +107,74 @@ class Random {
     static int Seed;
     static int mt_index;
     static unsigned long long mt_buffer[MT_LEN];
+
+    //! next 64 random bits from current block
+    static uint64_t RawBits();
+    //! advance all xoshiro256+ lanes and refill block
+    static void FillBlock();
+    //! build ziggurat tables
+    static void MakeZiggurat();
+    //! slow path of sExpo (wedges and tail)
+    static double ExpoFix(uint32_t j, int i);
+    //! slow path of sNormal (wedges and tails)
+    static double NormalFix(int32_t h, int i);
+
+    static uint64_t xo_state[4][XO_LANES];
+    static uint64_t block[XO_BLOCK];
+    static int block_index;
+
+    // ziggurat tables: 256 layers for the exponential, 128 for the normal
+    static uint32_t ke[256];
+    static double we[256];
+    static double fe[256];
+    static uint32_t kn[128];
+    static double wn[128];
+    static double fn[128];
 };
 
+inline uint64_t Random::RawBits() {
+    if (block_index == XO_BLOCK) {
+        FillBlock();
+    }
+    return block[block_index++];
+}
+
+inline double Random::Uniform() {
+    // upper 53 bits (the lowest bits of xoshiro256+ are weaker), shifted by half
+    // a step so that 0 and 1 are excluded
+    return ((double)(RawBits() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+inline int Random::DrawFromAliasTable(const double *prob, const int *alias, int n) {
+    double u = Uniform() * n;
+    int k = (int)u;
+    if (k == n) {
+        k--;
+    }
+    return (u - k < prob[k]) ? k : alias[k];
+}
+
+// in sExpo and sNormal, the layer is chosen using bits 11 to 18, and the
+// position within the layer using the upper 32 bits: the two are independent
+inline double Random::sExpo() {
+    uint64_t r = RawBits();
+    uint32_t j = (uint32_t)(r >> 32);
+    int i = (int)((r >> 11) & 255);
+    if (j < ke[i]) {
+        return j * we[i];
+    }
+    return ExpoFix(j, i);
+}
+
+inline double Random::sNormal() {
+    uint64_t r = RawBits();
+    int32_t h = (int32_t)(uint32_t)(r >> 32);
+    int i = (int)((r >> 11) & 127);
+    uint32_t a = (h < 0) ? 0u - (uint32_t)h : (uint32_t)h;
+    if (a < kn[i]) {
+        return h * wn[i];
+    }
+    return NormalFix(h, i);
+}
+
 #endif  // RANDOM_H
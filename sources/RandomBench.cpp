@@ -0,0 +1,232 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include "Chrono.hpp"
+#include "Random.hpp"
+
+/**
+ * \brief Throughput benchmark of the random number generators
+ *
+ * Compares the samplers of Random (block-filled xoshiro256+, ziggurat
+ * exponential and normal, Marsaglia-Tsang gamma) with those used previously,
+ * reproduced below (Mersenne twister, inversion for the exponential, rejection
+ * methods for the normal and the gamma). For each distribution, reports the
+ * number of draws per microsecond and the empirical mean and variance (which
+ * should match the expected values given in the last two columns).
+ *
+ * usage: randombench [ndraw]
+ */
+
+// former samplers, based on Random::MTUniform()
+
+static double LegacyNormal() {
+    double u = Random::MTUniform();
+    if (u <= 0.8638) {
+        double v = 2 * Random::MTUniform() - 1;
+        double w = 2 * Random::MTUniform() - 1;
+        return 2.3153508 * u - 1 + v + w;
+    }
+    if ((0.8638 < u) && (u <= 0.9745)) {
+        double v = Random::MTUniform();
+        return 1.5 * (v - 1 + 9.0334237 * (u - 0.8638));
+    } else if ((0.9973002 < u) && (u <= 1)) {
+        double x, v;
+        do {
+            v = Random::MTUniform();
+            double w = Random::MTUniform();
+            x = 4.5 - log(w);
+        } while (x * v * v > 4.5);
+        // double ret = (u - 0.9986501) > 0 ? sqrt(2 * x) : - sqrt(2 * x);
+        double ret = sqrt(2 * x);
+        if (u - 0.9986501 > 0) {
+            ret = -ret;
+        }
+        return ret;
+    }
+    double x, v, w, tot;
+    do {
+        x = 6 * Random::MTUniform() - 3;
+        u = Random::MTUniform();
+        v = (x > 0) ? x : -x;
+        w = 6.6313339 * (3 - v) * (3 - v);
+        tot = 0;
+        if (v < 1.5) {
+            tot += 6.0432809 * (1.5 - v);
+        }
+        if (v < 1) {
+            tot += 13.2626678 * (3 - v * v) - w;
+        }
+    } while (u > 49.0024445 * exp(-0.5 * v * v) - tot - w);
+    return x;
+}
+
+static double LegacyExpo() { return -log(Random::MTUniform()); }
+
+static double LegacyGamma(double a) {
+    if (a > 1) {
+        static double a1 = 0;
+        static double a2 = 0;
+
+        static double s2, s, d, t, x, u, q0, b, sigma, c, v, q, e;
+
+        // step 1
+        if (a != a1) {
+            a1 = a;
+            s2 = a - 0.5;
+            s = sqrt(s2);
+            d = 4 * sqrt(2.0) - 12 * s;
+        }
+
+        // step 2
+        t = LegacyNormal();
+        x = s + 0.5 * t;
+        if (t > 0) {
+            if (x == 0.0) {
+                std::cerr << "1\n";
+            }
+            return x * x;
+        }
+
+        // step 3
+        u = Random::MTUniform();
+        if (d * u < t * t * t) {
+            if (x == 0.0) {
+                std::cerr << "2\n";
+            }
+            return x * x;
+        }
+
+        // step 4
+        if (a != a2) {
+            a2 = a;
+            q0 = log(sqrt(2 * Pi)) - Random::logGamma(a) - s2 + s2 * log(s2);
+            if (a < 3.686) {
+                b = 0.463 + s + 0.178 * s2;
+                sigma = 1.235;
+                c = 0.195 / s - 0.079 + 0.16 * s;
+            } else if (a < 13.022) {
+                b = 1.654 + 0.0076 * s2;
+                sigma = 1.68 / s + 0.275;
+                c = 0.062 / s + 0.024;
+            } else {
+                b = 1.77;
+                sigma = 0.75;
+                c = 0.1515 / s;
+            }
+        }
+
+        // step 5-7
+        if (x > 0) {
+            v = 0.5 * t / s;
+            q = q0 - s * t + 0.25 * t * t + 2 * s2 * log(1.0 + v);
+            if (log(1 - u) < q) {
+                if (x == 0.0) {
+                    std::cerr << "3\n";
+                }
+                return x * x;
+            }
+        }
+
+        do {
+            do {
+                e = LegacyExpo();
+                u = Random::MTUniform();
+                u = u + u - 1;
+                t = fabs(e * sigma);
+                if (u < 0) {
+                    t = -t;
+                }
+                t += b;
+            } while (t <= -0.71874483771719);
+
+            v = 0.5 * t / s;
+            q = q0 - s * t + 0.25 * t * t + 2 * s2 * log(1.0 + v);
+        }
+
+        while ((q < 0) || (c * fabs(u) > (exp(q) - 1) * exp(e - 0.5 * t * t)));
+
+        x = s + 0.5 * t;
+        /*
+          if (!x)	{
+          std::cerr << "4\n";
+          std::cerr << s << '\t' << t << '\n';
+          std::cerr << e << '\t' << sigma << '\t' << u << '\n';
+          std::cerr << b << '\n';
+          }
+        */
+        return x * x;
+    }
+
+    double x, y;
+    do {
+        double u = Random::MTUniform();
+        double v = Random::MTUniform();
+        x = exp(log(u) / a);
+        y = exp(log(v) / (1 - a));
+    } while (x + y > 1);
+
+    double e = -log(Random::MTUniform());
+
+    return e * x / (x + y);
+}
+
+template <class F>
+static void Bench(string name, int n, F draw, double expmean, double expvar) {
+    Chrono chrono;
+    double sum = 0;
+    double sum2 = 0;
+    chrono.Start();
+    for (int i = 0; i < n; i++) {
+        double x = draw();
+        sum += x;
+        sum2 += x * x;
+    }
+    chrono.Stop();
+    double mean = sum / n;
+    double var = sum2 / n - mean * mean;
+    cout << name << '\t' << n / chrono.GetTime() / 1000 << '\t' << mean << '\t' << var << '\t'
+         << expmean << '\t' << expvar << '\n';
+}
+
+int main(int argc, char *argv[]) {
+    int n = 10000000;
+    if (argc > 1) {
+        n = atoi(argv[1]);
+    }
+    if (n <= 0) {
+        cerr << "usage: randombench [ndraw]\n";
+        exit(1);
+    }
+
+    cout << "sampler\t\tdraws/us\tmean\tvar\texp. mean\texp. var\n";
+    Bench("uniform (MT)", n, [] { return Random::MTUniform(); }, 0.5, 1.0 / 12);
+    Bench("uniform     ", n, [] { return Random::Uniform(); }, 0.5, 1.0 / 12);
+    Bench("expo (MT)   ", n, [] { return LegacyExpo(); }, 1, 1);
+    Bench("expo        ", n, [] { return Random::sExpo(); }, 1, 1);
+    Bench("normal (MT) ", n, [] { return LegacyNormal(); }, 0, 1);
+    Bench("normal      ", n, [] { return Random::sNormal(); }, 0, 1);
+    double shape[] = {0.1, 0.5, 2.0, 20.0};
+    for (double a : shape) {
+        ostringstream s1, s2;
+        s1 << "gamma " << a << " (MT)";
+        s2 << "gamma " << a << "    ";
+        Bench(s1.str(), n / 4, [a] { return LegacyGamma(a); }, a, a);
+        Bench(s2.str(), n / 4, [a] { return Random::sGamma(a); }, a, a);
+    }
+    // alternating shape parameters (as in Dirichlet draws) defeats the
+    // coefficient caching of the former gamma sampler
+    Bench("gamma alt (MT)", n / 4,
+          [] {
+              static int k = 0;
+              k ^= 1;
+              return LegacyGamma(k ? 2.0 : 3.0);
+          },
+          2.5, 2.75);
+    Bench("gamma alt     ", n / 4,
+          [] {
+              static int k = 0;
+              k ^= 1;
+              return Random::sGamma(k ? 2.0 : 3.0);
+          },
+          2.5, 2.75);
+}
@@ -27,8 +27,9 @@ class AAMutSelDSBDPOmegaSample : public Sample {
 
     //! \brief Constructor (file name, burn-in, thinning and upper limit, see
     //! Sample)
-    AAMutSelDSBDPOmegaSample(string filename, int inburnin, int inevery, int inuntil)
-        : Sample(filename, inburnin, inevery, inuntil) {
+    AAMutSelDSBDPOmegaSample(string filename, int inburnin, int inevery, int inuntil,
+                             int inmyid = 0, int innprocs = 1)
+        : Sample(filename, inburnin, inevery, inuntil, inmyid, innprocs) {
         Open();
     }
 
@@ -82,11 +83,19 @@ class AAMutSelDSBDPOmegaSample : public Sample {
 };
 
 int main(int argc, char *argv[]) {
+    int myid = 0;
+    int nprocs = 0;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
     int burnin = 0;
     int every = 1;
     int until = -1;
     string name;
     int ppred = 0;
+    int ppredtest = 0;
 
     try {
         if (argc == 1) {
@@ -96,7 +105,11 @@ int main(int argc, char *argv[]) {
         int i = 1;
         while (i < argc) {
             string s = argv[i];
-            if (s == "-ppred") {
+            if (s == "-ppredtest") {
+                ppredtest = 1;
+            } else if (s == "-ppredtestw") {
+                ppredtest = 2;
+            } else if (s == "-ppred") {
                 ppred = 1;
             } else if ((s == "-x") || (s == "-extract")) {
                 i++;
@@ -139,11 +152,15 @@ int main(int argc, char *argv[]) {
         exit(1);
     }
 
-    AAMutSelDSBDPOmegaSample *sample = new AAMutSelDSBDPOmegaSample(name, burnin, every, until);
-    if (ppred) {
+    AAMutSelDSBDPOmegaSample *sample = new AAMutSelDSBDPOmegaSample(name, burnin, every, until, myid, nprocs);
+    if (ppredtest) {
+        sample->PostPredCheck(ppredtest == 2);
+    } else if (ppred) {
         sample->PostPred();
     } else  {
         cerr << "read not yet implemented\n";
         exit(1);
     }
+
+    MPI_Finalize();
 }
@@ -29,8 +29,9 @@ class CodonM2aSample : public Sample {
 
     //! \brief Constructor (file name, burn-in, thinning and upper limit, see
     //! Sample)
-    CodonM2aSample(string innewpath, string filename, int inburnin, int inevery, int inuntil)
-        : Sample(filename, inburnin, inevery, inuntil) {
+    CodonM2aSample(string innewpath, string filename, int inburnin, int inevery, int inuntil,
+                   int inmyid = 0, int innprocs = 1)
+        : Sample(filename, inburnin, inevery, inuntil, inmyid, innprocs) {
         newpath = innewpath;
         Open();
     }
@@ -43,7 +44,7 @@ class CodonM2aSample : public Sample {
             GetModel()->ShrinkMixtureParameters(shrinkposw, shrinkdposom);
            //  GetModel()->GetPurOm(), 0, GetModel()->GetPurW(), 0);
             ostringstream s;
-            s << "ppred" << name << "_" << i;
+            s << "ppred" << name << "_" << partid + i * npart;
             // s << "ppred" << name << "_" << i << ".ali";
             model->PostPred(s.str());
         }
@@ -115,11 +116,19 @@ class CodonM2aSample : public Sample {
 };
 
 int main(int argc, char *argv[]) {
+    int myid = 0;
+    int nprocs = 0;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
     string newpath = "None";
     int burnin = 0;
     int every = 1;
     int until = -1;
     int ppred = 0;
+    int ppredtest = 0;
     double shrinkposw = 1.0;
     double shrinkdposom = 1.0;
 
@@ -149,6 +158,10 @@ int main(int argc, char *argv[]) {
             } else if (s == "-p") {
                 i++;
                 newpath = argv[i];
+            } else if (s == "-ppredtest") {
+                ppredtest = 1;
+            } else if (s == "-ppredtestw") {
+                ppredtest = 2;
             } else if (s == "-ppred") {
                 ppred = 1;
             } else if (s == "-null")  {
@@ -176,10 +189,14 @@ int main(int argc, char *argv[]) {
         exit(1);
     }
 
-    CodonM2aSample *sample = new CodonM2aSample(newpath, name, burnin, every, until);
-    if (ppred) {
+    CodonM2aSample *sample = new CodonM2aSample(newpath, name, burnin, every, until, myid, nprocs);
+    if (ppredtest) {
+        sample->PostPredCheck(ppredtest == 2);
+    } else if (ppred) {
         sample->PostPredSimu(shrinkposw,shrinkdposom);
     } else {
         sample->Read();
     }
+
+    MPI_Finalize();
 }
@@ -25,8 +25,9 @@ class DiffSelSample : public Sample {
 
     //! \brief Constructor (file name, burn-in, thinning and upper limit, see
     //! Sample)
-    DiffSelSample(string filename, int inburnin, int inevery, int inuntil)
-        : Sample(filename, inburnin, inevery, inuntil) {
+    DiffSelSample(string filename, int inburnin, int inevery, int inuntil,
+                  int inmyid = 0, int innprocs = 1)
+        : Sample(filename, inburnin, inevery, inuntil, inmyid, innprocs) {
         Open();
     }
 
@@ -104,11 +105,17 @@ class DiffSelSample : public Sample {
         }
         cerr << '\n';
 
+        // merge across processes
+        ReduceSample(pp);
+        if (partid) {
+            return;
+        }
+
         // normalization
         for (int k = 1; k < Ncond; k++) {
             for (int j = 0; j < Nsite; j++) {
                 for (int a = 0; a < Naa; a++) {
-                    pp[k - 1][j][a] /= size;
+                    pp[k - 1][j][a] /= totsize;
                 }
             }
         }
@@ -135,6 +142,13 @@ class DiffSelSample : public Sample {
 };
 
 int main(int argc, char *argv[]) {
+    int myid = 0;
+    int nprocs = 0;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
     int burnin = 0;
     int every = 1;
     int until = -1;
@@ -202,10 +216,12 @@ int main(int argc, char *argv[]) {
         exit(1);
     }
 
-    DiffSelSample *sample = new DiffSelSample(name, burnin, every, until);
+    DiffSelSample *sample = new DiffSelSample(name, burnin, every, until, myid, nprocs);
     if (ppred) {
         sample->PostPred();
     } else  {
         sample->ReadPP(cutoff, siteoffset);
     }
+
+    MPI_Finalize();
 }
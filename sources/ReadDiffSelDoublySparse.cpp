@@ -32,8 +32,9 @@ class DiffSelDoublySparseSample : public Sample {
 
     //! \brief Constructor (file name, burn-in, thinning and upper limit, see
     //! Sample)
-    DiffSelDoublySparseSample(string filename, int inburnin, int inevery, int inuntil)
-        : Sample(filename, inburnin, inevery, inuntil) {
+    DiffSelDoublySparseSample(string filename, int inburnin, int inevery, int inuntil,
+                              int inmyid = 0, int innprocs = 1)
+        : Sample(filename, inburnin, inevery, inuntil, inmyid, innprocs) {
         Open();
     }
 
@@ -125,13 +126,20 @@ class DiffSelDoublySparseSample : public Sample {
         }
         cerr << '\n';
 
+        // merge across processes
+        ReduceSample(pp);
+        ReduceSample(sitepp);
+        if (partid) {
+            return;
+        }
+
         // normalization
         for (int k = 1; k < Ncond; k++) {
             for (int j = 0; j < Nsite; j++) {
                 for (int a = 0; a < Naa; a++) {
-                    pp[k - 1][j][a] /= size;
+                    pp[k - 1][j][a] /= totsize;
                 }
-                sitepp[k - 1][j] /= size;
+                sitepp[k - 1][j] /= totsize;
             }
         }
 
@@ -178,11 +186,19 @@ class DiffSelDoublySparseSample : public Sample {
 };
 
 int main(int argc, char *argv[]) {
+    int myid = 0;
+    int nprocs = 0;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
     int burnin = 0;
     int every = 1;
     int until = -1;
     string name;
     int ppred = 0;
+    int ppredtest = 0;
 
     int siteoffset = 0;
     double cutoff = 0.90;
@@ -195,7 +211,11 @@ int main(int argc, char *argv[]) {
         int i = 1;
         while (i < argc) {
             string s = argv[i];
-            if (s == "-ppred") {
+            if (s == "-ppredtest") {
+                ppredtest = 1;
+            } else if (s == "-ppredtestw") {
+                ppredtest = 2;
+            } else if (s == "-ppred") {
                 ppred = 1;
             } else if ((s == "-x") || (s == "-extract")) {
                 i++;
@@ -244,10 +264,14 @@ int main(int argc, char *argv[]) {
         exit(1);
     }
 
-    DiffSelDoublySparseSample *sample = new DiffSelDoublySparseSample(name, burnin, every, until);
-    if (ppred) {
+    DiffSelDoublySparseSample *sample = new DiffSelDoublySparseSample(name, burnin, every, until, myid, nprocs);
+    if (ppredtest) {
+        sample->PostPredCheck(ppredtest == 2);
+    } else if (ppred) {
         sample->PostPred();
     } else  {
         sample->ReadPP(cutoff, siteoffset);
     }
+
+    MPI_Finalize();
 }
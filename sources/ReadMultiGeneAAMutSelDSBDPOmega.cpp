@@ -43,12 +43,7 @@ class MultiGeneAAMutSelDSBDPOmegaSample : public MultiGeneSample {
         is >> Ncat >> baseNcat;
         is >> blmode >> nucmode >> basemode >> omegamode >> omegaprior >> modalprior;
         is >> pihypermean >> pihyperinvconc;
-        int tmp;
-        is >> tmp;
-        if (tmp) {
-            cerr << "-- Error when reading model\n";
-            exit(1);
-        }
+        int geneformat = MultiGeneMPIModule::ReadParamTrailer(is, {});
         is >> chainevery >> chainuntil >> chainsize;
 
         if (modeltype == "MULTIGENEAAMUTSELDSBDPOMEGA") {
@@ -61,7 +56,9 @@ class MultiGeneAAMutSelDSBDPOmegaSample : public MultiGeneSample {
             exit(1);
         }
 
+        GetModel()->SetGeneFormat(geneformat);
         GetModel()->Allocate();
+        GetModel()->SetGeneShardFile(name + ".param", false);
         GetModel()->FromStream(is);
 
         // open <name>.chain, and prepare stream and stream iterator
@@ -104,6 +101,7 @@ int main(int argc, char *argv[]) {
     int until = -1;
     string name;
     int ppred = 0;
+    int ppredtest = 0;
 
     try {
         if (argc == 1) {
@@ -113,7 +111,11 @@ int main(int argc, char *argv[]) {
         int i = 1;
         while (i < argc) {
             string s = argv[i];
-            if (s == "-ppred") {
+            if (s == "-ppredtest") {
+                ppredtest = 1;
+            } else if (s == "-ppredtestw") {
+                ppredtest = 2;
+            } else if (s == "-ppred") {
                 ppred = 1;
             } else if ((s == "-x") || (s == "-extract")) {
                 i++;
@@ -159,7 +161,9 @@ int main(int argc, char *argv[]) {
     MultiGeneAAMutSelDSBDPOmegaSample *sample =
         new MultiGeneAAMutSelDSBDPOmegaSample(name, burnin, every, until, myid, nprocs);
 
-    if (ppred) {
+    if (ppredtest) {
+        sample->PostPredCheck(ppredtest == 2);
+    } else if (ppred) {
         if (!myid) {
             sample->MasterPostPred();
         } else {
@@ -56,12 +56,10 @@ class MultiGeneCodonM2aSample : public MultiGeneSample {
         is >> poswhypermean >> poswhyperinvconc;
         is >> modalprior;
 
-        int check;
-        is >> check;
-        if (check)  {
-            cerr << "Error when reading model\n";
-            exit(1);
-        }
+        purommode = 1;
+        // shardgenedata: only relevant for running the chain
+        int shardgenedata = 0;
+        int geneformat = MultiGeneMPIModule::ReadParamTrailer(is, {&purommode, &shardgenedata});
         is >> chainevery >> chainuntil >> chainsize;
 
         if (modeltype == "MULTIGENECODONM2A") {
@@ -80,6 +78,7 @@ class MultiGeneCodonM2aSample : public MultiGeneSample {
             exit(1);
         }
 
+        GetModel()->SetGeneFormat(geneformat);
         GetModel()->Allocate();
         GetModel()->FromStream(is);
 
@@ -109,6 +108,7 @@ int main(int argc, char *argv[]) {
     int until = -1;
     string name;
     int ppred = 0;
+    int ppredtest = 0;
 
     try {
         if (argc == 1) {
@@ -118,7 +118,11 @@ int main(int argc, char *argv[]) {
         int i = 1;
         while (i < argc) {
             string s = argv[i];
-            if (s == "-ppred") {
+            if (s == "-ppredtest") {
+                ppredtest = 1;
+            } else if (s == "-ppredtestw") {
+                ppredtest = 2;
+            } else if (s == "-ppred") {
                 ppred = 1;
             } else if ((s == "-x") || (s == "-extract")) {
                 i++;
@@ -167,7 +171,9 @@ int main(int argc, char *argv[]) {
     MultiGeneCodonM2aSample *sample =
         new MultiGeneCodonM2aSample(newpath, name, burnin, every, until, myid, nprocs);
 
-    if (ppred) {
+    if (ppredtest) {
+        sample->PostPredCheck(ppredtest == 2);
+    } else if (ppred) {
         if (!myid) {
             sample->MasterPostPred();
         } else {
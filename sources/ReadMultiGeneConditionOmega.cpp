@@ -39,12 +39,7 @@ class MultiGeneConditionOmegaSample : public MultiGeneSample {
         is >> datafile >> treefile;
         is >> ncond >> nlevel;
         is >> blmode >> nucmode >> devmode;
-        int check;
-        is >> check;
-        if (check) {
-            cerr << "-- Error when reading model\n";
-            exit(1);
-        }
+        int geneformat = MultiGeneMPIModule::ReadParamTrailer(is, {});
         is >> chainevery >> chainuntil >> chainsize;
 
         // make a new model depending on the type obtained from the file
@@ -58,6 +53,7 @@ class MultiGeneConditionOmegaSample : public MultiGeneSample {
             exit(1);
         }
 
+        GetModel()->SetGeneFormat(geneformat);
         GetModel()->Allocate();
         model->FromStream(is);
         OpenChainFile();
@@ -135,6 +131,7 @@ int main(int argc, char *argv[]) {
     int until = -1;
     string name;
     int ppred = 0;
+    int ppredtest = 0;
 
     double cutoff = 0.7;
 
@@ -146,7 +143,11 @@ int main(int argc, char *argv[]) {
         int i = 1;
         while (i < argc) {
             string s = argv[i];
-            if (s == "-ppred") {
+            if (s == "-ppredtest") {
+                ppredtest = 1;
+            } else if (s == "-ppredtestw") {
+                ppredtest = 2;
+            } else if (s == "-ppred") {
                 ppred = 1;
             } else if (s == "-ppred0")    {
                 ppred = 2;
@@ -196,7 +197,9 @@ int main(int argc, char *argv[]) {
     MultiGeneConditionOmegaSample *sample =
         new MultiGeneConditionOmegaSample(name, burnin, every, until, myid, nprocs);
 
-    if (ppred) {
+    if (ppredtest) {
+        sample->PostPredCheck(ppredtest == 2);
+    } else if (ppred) {
         if (ppred == 2) {
             sample->GetModel()->SetPostPredMode(0);
         }
@@ -51,12 +51,7 @@ class MultiGeneDiffSelDoublySparseSample : public MultiGeneSample {
         is >> pihypermean >> pihyperinvconc;
         is >> shiftprobmean >> shiftprobinvconc;
 
-        int tmp;
-        is >> tmp;
-        if (tmp) {
-            cerr << "-- Error when reading model\n";
-            exit(1);
-        }
+        int geneformat = MultiGeneMPIModule::ReadParamTrailer(is, {});
         is >> burnin;
         is >> chainevery >> chainuntil >> chainsaveall >> writegenedata >> chainsize;
 
@@ -77,7 +72,9 @@ class MultiGeneDiffSelDoublySparseSample : public MultiGeneSample {
         }
         GetModel()->SetFitnessCenterMode(fitnesscentermode);
 
+        GetModel()->SetGeneFormat(geneformat);
         GetModel()->Allocate();
+        GetModel()->SetGeneShardFile(name + ".param", false);
         GetModel()->FromStream(is);
 
         // open <name>.chain, and prepare stream and stream iterator
@@ -120,6 +117,7 @@ int main(int argc, char *argv[]) {
     int until = -1;
     string name;
     int ppred = 0;
+    int ppredtest = 0;
 
     try {
         if (argc == 1) {
@@ -129,7 +127,11 @@ int main(int argc, char *argv[]) {
         int i = 1;
         while (i < argc) {
             string s = argv[i];
-            if (s == "-ppred") {
+            if (s == "-ppredtest") {
+                ppredtest = 1;
+            } else if (s == "-ppredtestw") {
+                ppredtest = 2;
+            } else if (s == "-ppred") {
                 ppred = 1;
             } else if ((s == "-x") || (s == "-extract")) {
                 i++;
@@ -175,7 +177,9 @@ int main(int argc, char *argv[]) {
     MultiGeneDiffSelDoublySparseSample *sample =
         new MultiGeneDiffSelDoublySparseSample(name, burnin, every, until, myid, nprocs);
 
-    if (ppred) {
+    if (ppredtest) {
+        sample->PostPredCheck(ppredtest == 2);
+    } else if (ppred) {
         if (!myid) {
             sample->MasterPostPred();
         } else {
@@ -13,6 +13,7 @@ class MultiGeneSingleOmegaSample : public MultiGeneSample {
     string treefile;
     int blmode, nucmode, omegamode;
     double omegahypermean, omegahyperinvshape;
+    int subsettaxa;
 
   public:
     string GetModelType() { return modeltype; }
@@ -41,12 +42,8 @@ class MultiGeneSingleOmegaSample : public MultiGeneSample {
         is >> datafile >> treefile;
         is >> blmode >> nucmode >> omegamode;
         is >> omegahypermean >> omegahyperinvshape;
-        int check;
-        is >> check;
-        if (check) {
-            cerr << "-- Error when reading model\n";
-            exit(1);
-        }
+        subsettaxa = 0;
+        int geneformat = MultiGeneMPIModule::ReadParamTrailer(is, {&subsettaxa});
         is >> chainevery >> chainuntil >> chainsize;
 
         // make a new model depending on the type obtained from the file
@@ -54,12 +51,14 @@ class MultiGeneSingleOmegaSample : public MultiGeneSample {
             model = new MultiGeneSingleOmegaModel(datafile, treefile, myid, nprocs);
             GetModel()->SetAcrossGenesModes(blmode,nucmode,omegamode);
             GetModel()->SetOmegaHyperParameters(omegahypermean,omegahyperinvshape);
+            GetModel()->SetTaxonSubsetting(subsettaxa);
         } else {
             cerr << "error when opening file " << name << '\n';
             cerr << modeltype << '\n';
             exit(1);
         }
 
+        GetModel()->SetGeneFormat(geneformat);
         GetModel()->Allocate();
         // read model (i.e. chain's last point) from <name>.param
         model->FromStream(is);
@@ -119,6 +118,7 @@ int main(int argc, char *argv[]) {
     int until = -1;
     string name;
     int ppred = 0;
+    int ppredtest = 0;
 
     try {
         if (argc == 1) {
@@ -128,7 +128,11 @@ int main(int argc, char *argv[]) {
         int i = 1;
         while (i < argc) {
             string s = argv[i];
-            if (s == "-ppred") {
+            if (s == "-ppredtest") {
+                ppredtest = 1;
+            } else if (s == "-ppredtestw") {
+                ppredtest = 2;
+            } else if (s == "-ppred") {
                 ppred = 1;
             } else if ((s == "-x") || (s == "-extract")) {
                 i++;
@@ -174,7 +178,9 @@ int main(int argc, char *argv[]) {
     MultiGeneSingleOmegaSample *sample =
         new MultiGeneSingleOmegaSample(name, burnin, every, until, myid, nprocs);
 
-    if (ppred) {
+    if (ppredtest) {
+        sample->PostPredCheck(ppredtest == 2);
+    } else if (ppred) {
         if (!myid) {
             sample->MasterPostPred();
         } else {
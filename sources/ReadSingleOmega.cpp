@@ -24,8 +24,9 @@ class SingleOmegaSample : public Sample {
 
     //! \brief Constructor (file name, burn-in, thinning and upper limit, see
     //! Sample)
-    SingleOmegaSample(string filename, int inburnin, int inevery, int inuntil)
-        : Sample(filename, inburnin, inevery, inuntil) {
+    SingleOmegaSample(string filename, int inburnin, int inevery, int inuntil,
+                      int inmyid = 0, int innprocs = 1)
+        : Sample(filename, inburnin, inevery, inuntil, inmyid, innprocs) {
         Open();
     }
 
@@ -86,8 +87,16 @@ class SingleOmegaSample : public Sample {
             varomega += om * om;
         }
         cerr << '\n';
-        meanomega /= size;
-        varomega /= size;
+
+        // merge across processes
+        ReduceSample(meanomega);
+        ReduceSample(varomega);
+        if (partid) {
+            return;
+        }
+
+        meanomega /= totsize;
+        varomega /= totsize;
         varomega -= meanomega * meanomega;
 
         cout << "posterior mean omega : " << meanomega << '\t' << sqrt(varomega) << '\n';
@@ -95,10 +104,18 @@ class SingleOmegaSample : public Sample {
 };
 
 int main(int argc, char *argv[]) {
+    int myid = 0;
+    int nprocs = 0;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
     int burnin = 0;
     int every = 1;
     int until = -1;
     int ppred = 0;
+    int ppredtest = 0;
 
     string name;
 
@@ -123,6 +140,10 @@ int main(int argc, char *argv[]) {
                 if (i == argc) throw(0);
                 s = argv[i];
                 until = atoi(argv[i]);
+            } else if (s == "-ppredtest") {
+                ppredtest = 1;
+            } else if (s == "-ppredtestw") {
+                ppredtest = 2;
             } else if (s == "-ppred") {
                 ppred = 1;
             } else {
@@ -142,10 +163,14 @@ int main(int argc, char *argv[]) {
         exit(1);
     }
 
-    SingleOmegaSample *sample = new SingleOmegaSample(name, burnin, every, until);
-    if (ppred) {
+    SingleOmegaSample *sample = new SingleOmegaSample(name, burnin, every, until, myid, nprocs);
+    if (ppredtest) {
+        sample->PostPredCheck(ppredtest == 2);
+    } else if (ppred) {
         sample->PostPred();
     } else {
         sample->Read();
     }
+
+    MPI_Finalize();
 }
@@ -1,13 +1,18 @@
 
 #include "Sample.hpp"
+#include "PostPredTest.hpp"
 
-Sample::Sample(string filename, int in_burnin, int in_every, int in_until) {
+Sample::Sample(string filename, int in_burnin, int in_every, int in_until, int inpartid,
+               int innpart) {
+    partid = inpartid;
+    npart = innpart;
     burnin = in_burnin;
     every = in_every;
     until = in_until;
     name = filename;
     chain_is = 0;
     chainsaveall = 1;
+    chainindexed = 0;
 }
 
 Sample::~Sample() { delete chain_is; }
@@ -27,12 +32,13 @@ void Sample::OpenChainFile() {
     if (burnin == -1) {
         burnin = chainsize / 10;
     }
-    size = (until - burnin) / every;
-    if (size <= 0) {
+    totsize = (until - burnin) / every;
+    if (totsize <= 0) {
         cerr << "error : chain not long enough\n";
         cerr << burnin << '\t' << every << '\t' << until << '\n';
         exit(1);
     }
+    size = (totsize > partid) ? (totsize - partid + npart - 1) / npart : 0;
     currentpoint = 0;
 
     chain_is = new ifstream((name + ".chain").c_str());
@@ -40,11 +46,40 @@ void Sample::OpenChainFile() {
         cerr << "error: cannot find file " << name << ".chain\n";
         exit(1);
     }
-    string line;
-    getline(*chain_is,line);
-    for (int i = 0; i < burnin; i++) {
-        model->FromStream(*chain_is);
+    chainindexed = ReadChainIndex();
+    if (!chainindexed) {
+        // the chain file starts with a header line only if the model writes one
+        ostringstream header;
+        model->ToStreamHeader(header);
+        if (!header.str().empty()) {
+            string line;
+            getline(*chain_is, line);
+        }
+    }
+    chainpos = 0;
+}
+
+bool Sample::ReadChainIndex() {
+    chainindex.clear();
+    ifstream index_is((name + ".chainindex").c_str());
+    if (!index_is) {
+        return false;
+    }
+    streamoff offset;
+    while (index_is >> offset) {
+        chainindex.push_back(offset);
     }
+    if (int(chainindex.size()) != chainsize) {
+        cerr << "-- chain index does not match chain size: reading points sequentially\n";
+        chainindex.clear();
+        return false;
+    }
+    return true;
+}
+
+void Sample::SeekChainPoint(int point) {
+    chain_is->clear();
+    chain_is->seekg(chainindex[point]);
 }
 
 void Sample::GetNextPoint() {
@@ -52,12 +87,17 @@ void Sample::GetNextPoint() {
         cerr << "error in Sample::GetNextPoint: going past last points\n";
         exit(1);
     }
-    if (currentpoint) {
-        for (int i = 0; i < every - 1; i++) {
+    if (chainindexed) {
+        SeekChainPoint(GetChainPoint());
+    } else {
+        // no index: parse (and discard) all points up to the requested one
+        while (chainpos < GetChainPoint()) {
             model->FromStream(*chain_is);
+            chainpos++;
         }
     }
     model->FromStream(*chain_is);
+    chainpos = GetChainPoint() + 1;
     currentpoint++;
 }
 
@@ -67,9 +107,39 @@ void Sample::PostPred() {
         cerr << '.';
         GetNextPoint();
         ostringstream s;
-        s << "ppred" << name << "_" << i;
+        s << "ppred" << name << "_" << partid + i * npart;
         // s << "ppred" << name << "_" << i << ".ali";
         model->PostPred(s.str());
     }
     cerr << '\n';
 }
+
+void Sample::PostPredCheck(bool writefiles) {
+    const CodonSequenceAlignment *obsdata = model->GetCodonData();
+    if (!obsdata) {
+        cerr << "error in Sample::PostPredCheck: model has no codon data\n";
+        exit(1);
+    }
+    CodonSequenceAlignment simu(*obsdata);
+    PostPredTest test(*obsdata);
+    cerr << size << " points to read\n";
+    for (int i = 0; i < size; i++) {
+        cerr << '.';
+        GetNextPoint();
+        model->PostPredSimu(simu);
+        test.AddReplicate(simu);
+        if (writefiles) {
+            ostringstream s;
+            s << "ppred" << name << "_" << partid + i * npart << ".ali";
+            ofstream os(s.str().c_str());
+            simu.SequenceAlignment::ToStream(os);
+        }
+    }
+    cerr << '\n';
+    MergeSample(test);
+    if (!partid) {
+        ofstream os((name + ".ppredtest").c_str());
+        test.ToStream(os);
+        cerr << "posterior predictive tests in " << name << ".ppredtest\n";
+    }
+}
@@ -3,8 +3,11 @@
 
 #include <cstdlib>
 #include <fstream>
+#include <vector>
 using namespace std;
 
+#include "MPIBuffer.hpp"
+#include "Parallel.hpp"
 #include "ProbModel.hpp"
 
 /**
@@ -15,13 +18,21 @@ using namespace std;
  * and computing posterior quantities (averages, credible intervals,
  * distributions, posterior predictive samples. etc). As a simple example, see
  * SingleOmegaSample.
+ *
+ * The points of a sample can be split among several MPI processes (partid
+ * among npart): process partid then reads points partid, partid + npart,
+ * partid + 2*npart, etc., each with its own model instance. size is the number
+ * of points read by this process, totsize the total number of points of the
+ * sample; accumulators are merged across processes with ReduceSample.
  */
 
 class Sample {
   public:
     //! \brief Constructor, opening chain from file, with specified burn-in,
-    //! thinning factor and upper limit.
-    Sample(string filename, int in_burnin = 0, int in_every = 1, int in_until = -1);
+    //! thinning factor and upper limit, and (optionally) splitting points among
+    //! npart processes, of which this one is partid.
+    Sample(string filename, int in_burnin = 0, int in_every = 1, int in_until = -1,
+           int inpartid = 0, int innpart = 1);
 
     virtual ~Sample();
 
@@ -35,8 +46,17 @@ class Sample {
     //! accessible through GetModel()
     virtual void GetNextPoint();
 
+    //! \brief posterior predictive simulation for all points, each written
+    //! into a file (ppred<name>_<point>)
     virtual void PostPred();
 
+    //! \brief posterior predictive tests (see PostPredTest), results in
+    //! <name>.ppredtest
+    //!
+    //! replicates are simulated in memory, and accumulated on the fly; simulated
+    //! alignments are written into files only if writefiles is set.
+    virtual void PostPredCheck(bool writefiles = false);
+
     //! \brief return a pointer to model configuration specified by current point
     //! (i.e. last point that was read from file)
     //!
@@ -53,9 +73,68 @@ class Sample {
     //! \brief opens files, prepare data structures and sets the stream iterator
     virtual void OpenChainFile();
 
-    int size;  // sample size (calculated from parameters above)
+    //! \brief sum t across all processes sharing this sample (the total is
+    //! returned on process 0)
+    template <class T>
+    void ReduceSample(T &t) const {
+        if (npart == 1) {
+            return;
+        }
+        MPIBuffer buffer(MPISize(t));
+        buffer << t;
+        MPIBuffer total(MPISize(t));
+        MPI_Reduce(buffer.GetBuffer(), total.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, MPI_SUM, 0,
+                   ChainComm);
+        if (!partid) {
+            total >> t;
+        }
+    }
+
+    //! \brief merge t across all processes sharing this sample, for objects
+    //! that are not simply additive (the merged object, as computed by t +=
+    //! buffer, is returned on process 0)
+    template <class T>
+    void MergeSample(T &t) const {
+        if (npart == 1) {
+            return;
+        }
+        if (partid) {
+            MPIBuffer buffer(MPISize(t));
+            buffer << t;
+            MPI_Send(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, 0, TAG1, ChainComm);
+        } else {
+            for (int part = 1; part < npart; part++) {
+                MPIBuffer buffer(MPISize(t));
+                MPI_Status stat;
+                MPI_Recv(buffer.GetBuffer(), buffer.GetSize(), MPI_DOUBLE, part, TAG1,
+                         ChainComm, &stat);
+                t += buffer;
+            }
+        }
+    }
+
+    int size;     // number of points read by this process
+    int totsize;  // total sample size (calculated from parameters above)
 
   protected:
+    //! \brief read byte offsets of all saved points from <name>.chainindex
+    //!
+    //! returns false (and leaves chainindex empty) if the index file is absent
+    //! or does not match chainsize (e.g. chain started with an older version),
+    //! in which case points are read sequentially.
+    bool ReadChainIndex();
+
+    //! \brief index (within the whole sample) of the point to be read at the
+    //! current stage
+    int GetSamplePoint() const { return partid + currentpoint * npart; }
+
+    //! \brief index (in the .chain file) of the point to be read at the
+    //! current stage
+    int GetChainPoint() const { return burnin + GetSamplePoint() * every; }
+
+    //! \brief position chain stream at the beginning of the given point
+    void SeekChainPoint(int point);
+
     ifstream *chain_is;
     int chainevery;  // chain's saving frequency
     int chainuntil;  // chain's intended size of the run (number of saved points)
@@ -66,6 +145,13 @@ class Sample {
     int every;   // subsampling frequency
     int until;   // reading chain until this point
     int currentpoint;
+    int chainpos;  // index (in the .chain file) of the next point in chain_is
+    int partid;    // rank of this process among those sharing the sample
+    int npart;     // number of processes sharing the sample
+    //! flag: if 1, points are accessed directly through chainindex
+    int chainindexed;
+    //! byte offset of each saved point in the .chain file
+    std::vector<std::streamoff> chainindex;
     ProbModel *model;  // the model
     string name;       // the name of the chain in the filesystem
 };
@@ -11,10 +11,51 @@ using namespace std;
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
+const unsigned char SequenceAlignment::missingcode;
+
 int Int(string s) { return atoi(s.c_str()); }
 
 double Double(string s) { return atof(s.c_str()); }
 
+SequenceAlignment::SequenceAlignment(const SequenceAlignment &from, const vector<int> &taxa)
+    : Ntaxa(taxa.size()),
+      Nsite(from.Nsite),
+      statespace(from.statespace),
+      owntaxset(true),
+      ownstatespace(false) {
+    vector<string> names(Ntaxa);
+    for (int i = 0; i < Ntaxa; i++) {
+        names[i] = from.taxset->GetTaxon(taxa[i]);
+    }
+    taxset = new TaxonSet(names);
+    Allocate();
+    for (int j = 0; j < Nsite; j++) {
+        const unsigned char *col = from.GetSiteStates(j);
+        for (int i = 0; i < Ntaxa; i++) {
+            Data[j * Ntaxa + i] = col[taxa[i]];
+        }
+    }
+}
+
+vector<int> SequenceAlignment::GetPresentTaxa() const {
+    vector<bool> present(Ntaxa, false);
+    for (int j = 0; j < Nsite; j++) {
+        const unsigned char *col = GetSiteStates(j);
+        for (int i = 0; i < Ntaxa; i++) {
+            if (col[i] != missingcode) {
+                present[i] = true;
+            }
+        }
+    }
+    vector<int> taxa;
+    for (int i = 0; i < Ntaxa; i++) {
+        if (present[i]) {
+            taxa.push_back(i);
+        }
+    }
+    return taxa;
+}
+
 vector<double> SequenceAlignment::GetEmpiricalFreq() const {
     vector<double> in(GetNstate(), 0);
     int n = 0;
@@ -179,7 +220,7 @@ int FileSequenceAlignment::ReadNexus(string filespec) {
             exit(1);
         }
 
-        Data.assign(Ntaxa, std::vector<int>(Nsite, 0));
+        Allocate();
         std::vector<std::string> SpeciesNames(Ntaxa, "");
 
         GoPastNextWord(theStream, "Matrix");
@@ -221,19 +262,19 @@ int FileSequenceAlignment::ReadNexus(string filespec) {
                     }
                     if ((c != ' ') && (c != '\t') && (c != '\n') && (c != 13)) {
                         if (c == '(') {
-                            Data[i][k] = unknown;
+                            SetState(i, k, unknown);
                             while (c != ')') {
                                 theStream >> c;
                             }
                         } else if (c == '{') {
-                            Data[i][k] = unknown;
+                            SetState(i, k, unknown);
                             while (c != '}') {
                                 theStream >> c;
                             }
                         } else {
                             ostringstream s;
                             s << c;
-                            Data[i][k] = statespace->GetState(s.str());
+                            SetState(i, k, statespace->GetState(s.str()));
                         }
                         k++;
                     }
@@ -253,7 +294,7 @@ int FileSequenceAlignment::ReadNexus(string filespec) {
                         cerr << "taxa : " << i << '\t' << SpeciesNames[i] << '\n';
                         if (m > k) {
                             while (k != m) {
-                                Data[i][k] = unknown;
+                                SetState(i, k, unknown);
                                 k++;
                             }
                         }
@@ -309,7 +350,7 @@ int FileSequenceAlignment::ReadSpecial(string filename) {
         delete[] Alphabet;
         delete[] AlphabetSet;
 
-        Data.assign(Ntaxa, std::vector<int>(Nsite, 0));
+        Allocate();
         std::vector<std::string> SpeciesNames(Ntaxa, "");
 
         int ntaxa = 0;
@@ -324,12 +365,12 @@ int FileSequenceAlignment::ReadSpecial(string filename) {
                 c = theStream.get();
                 if ((!theStream.eof()) && (c != ' ') && (c != '\n') && (c != '\t') && (c != 13)) {
                     if (c == '(') {
-                        Data[ntaxa][nsite] = unknown;
+                        SetState(ntaxa, nsite, unknown);
                         while (c != ')') {
                             theStream >> c;
                         }
                     } else if (c == '{') {
-                        Data[ntaxa][nsite] = unknown;
+                        SetState(ntaxa, nsite, unknown);
                         while (c != '}') {
                             theStream >> c;
                         }
@@ -344,11 +385,11 @@ int FileSequenceAlignment::ReadSpecial(string filename) {
                             exit(1);
                         }
                         if (p >= Nstate) {
-                            Data[ntaxa][nsite] = unknown;
+                            SetState(ntaxa, nsite, unknown);
                         } else {
                             for (int l = 0; l < Nstate; l++) {
                                 if (c == Alphabet[l]) {
-                                    Data[ntaxa][nsite] = l;
+                                    SetState(ntaxa, nsite, l);
                                 }
                             }
                         }
@@ -515,7 +556,7 @@ void FileSequenceAlignment::ReadPhylipSequentialFromStream(istream& theStream) {
         }
         Nsite = Int(temp);
 
-        Data.assign(Ntaxa, std::vector<int>(Nsite, 0));
+        Allocate();
         std::vector<std::string> SpeciesNames(Ntaxa, "");
 
         int ntaxa = 0;
@@ -529,19 +570,19 @@ void FileSequenceAlignment::ReadPhylipSequentialFromStream(istream& theStream) {
                 c = theStream.get();
                 if ((!theStream.eof()) && (c != ' ') && (c != '\n') && (c != '\t') && (c != 13)) {
                     if (c == '(') {
-                        Data[ntaxa][nsite] = unknown;
+                        SetState(ntaxa, nsite, unknown);
                         while (c != ')') {
                             theStream >> c;
                         }
                     } else if (c == '{') {
-                        Data[ntaxa][nsite] = unknown;
+                        SetState(ntaxa, nsite, unknown);
                         while (c != '}') {
                             theStream >> c;
                         }
                     } else {
                         ostringstream s;
                         s << c;
-                        Data[ntaxa][nsite] = statespace->GetState(s.str());
+                        SetState(ntaxa, nsite, statespace->GetState(s.str()));
                     }
                     nsite++;
                 }
@@ -743,7 +784,7 @@ void FileSequenceAlignment::ReadPhylip(string filespec, int repeattaxa) {
         Nsite = Int(temp);
         // cerr << Ntaxa << '\t' << Nsite << '\n';
 
-        Data.assign(Ntaxa, std::vector<int>(Nsite, 0));
+        Allocate();
         std::vector<std::string> SpeciesNames(Ntaxa, "");
 
         int l = 0;
@@ -773,19 +814,19 @@ void FileSequenceAlignment::ReadPhylip(string filespec, int repeattaxa) {
                     if ((!theStream.eof()) && (c != ' ') && (c != '\n') && (c != '\t') &&
                         (c != 13)) {
                         if (c == '(') {
-                            Data[i][k] = unknown;
+                            SetState(i, k, unknown);
                             while (c != ')') {
                                 theStream >> c;
                             }
                         } else if (c == '{') {
-                            Data[i][k] = unknown;
+                            SetState(i, k, unknown);
                             while (c != '}') {
                                 theStream >> c;
                             }
                         } else {
                             ostringstream s;
                             s << c;
-                            Data[i][k] = statespace->GetState(s.str());
+                            SetState(i, k, statespace->GetState(s.str()));
                         }
                         k++;
                     }
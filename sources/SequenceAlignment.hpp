@@ -7,6 +7,12 @@
 
 /**
  * \brief Generic interface for a multiple sequence alignment
+ *
+ * States are stored compactly, one byte per entry (missing entries coded as
+ * 255), in site-major order: all taxa for site 0, then all taxa for site 1,
+ * etc. Each column is thus a contiguous block of Ntaxa bytes (see
+ * GetSiteStates), while GetState(taxon, site) gives the usual taxon-indexed
+ * view.
  */
 
 class SequenceAlignment {
@@ -30,6 +36,13 @@ class SequenceAlignment {
           ownstatespace(false),
           Data(from.Data) {}
 
+    //! \brief restriction to a subset of taxa
+    //!
+    //! keeps the given taxa of from (indices, in that order), under a taxon set
+    //! of its own. The state space is shared with from, which should therefore
+    //! outlive this alignment.
+    SequenceAlignment(const SequenceAlignment &from, const std::vector<int> &taxa);
+
     virtual ~SequenceAlignment() {
         if (owntaxset) {
             delete taxset;
@@ -61,27 +74,45 @@ class SequenceAlignment {
     int GetNtaxa() const { return taxset->GetNtaxa(); }
 
     // return state for this taxon at that site (return -1 if missing entry)
-    int GetState(int taxon, int site) const { return Data[taxon][site]; }
+    int GetState(int taxon, int site) const {
+        unsigned char s = Data[site * Ntaxa + taxon];
+        return (s == missingcode) ? unknown : s;
+    }
+
+    //! return the column of states at that site (one byte per taxon, missing
+    //! entries coded as 255)
+    const unsigned char *GetSiteStates(int site) const { return &Data[site * Ntaxa]; }
 
     //! whether or not entry is missing for this taxon at that site
-    bool isMissing(int taxon, int site) const { return Data[taxon][site] == -1; }
+    bool isMissing(int taxon, int site) const {
+        return Data[site * Ntaxa + taxon] == missingcode;
+    }
+
+    //! return indices of the taxa having at least one non-missing entry
+    std::vector<int> GetPresentTaxa() const;
 
     //! Phylip-like formatted output to stream
     void ToStream(std::ostream &os) const;
 
     //! set the state to a new value (note: should really re-consider this option,
     //! currently used by PhyloProcess to simulate new data)
-    void SetState(int taxon, int site, int state) { Data[taxon][site] = state; }
+    void SetState(int taxon, int site, int state) {
+        Data[site * Ntaxa + taxon] =
+            (state == unknown) ? missingcode : static_cast<unsigned char>(state);
+    }
 
     //! return empirical frequencies into a vector
     std::vector<double> GetEmpiricalFreq() const;
 
   protected:
+    //! allocate (Ntaxa x Nsite) entries, all set to missing
+    void Allocate() { Data.assign(Ntaxa * Nsite, missingcode); }
+
     bool AllMissingColumn(int site) const {
         bool ret = true;
         int tax = 0;
         while ((tax < GetNtaxa()) && ret) {
-            ret &= static_cast<int>(Data[tax][site] == unknown);
+            ret &= static_cast<int>(isMissing(tax, site));
             tax++;
         }
         return ret;
@@ -89,19 +120,13 @@ class SequenceAlignment {
 
   private:
     // replace all entries by missing entries
-    void Unclamp() {
-        for (int i = 0; i < Ntaxa; i++) {
-            for (int j = 0; j < Nsite; j++) {
-                Data[i][j] = unknown;
-            }
-        }
-    }
+    void Unclamp() { Data.assign(Ntaxa * Nsite, missingcode); }
 
     bool AllMissingTaxon(int tax) const {
         bool ret = true;
         int site = 0;
         while ((site < GetNsite()) && ret) {
-            ret &= static_cast<int>(Data[tax][site] == unknown);
+            ret &= static_cast<int>(isMissing(tax, site));
             site++;
         }
         return ret;
@@ -120,7 +145,7 @@ class SequenceAlignment {
         bool ret = true;
         int tax = 0;
         while ((tax < GetNtaxa()) && ret) {
-            ret &= static_cast<int>(Data[tax][site] != unknown);
+            ret &= static_cast<int>(!isMissing(tax, site));
             tax++;
         }
         return ret;
@@ -129,16 +154,16 @@ class SequenceAlignment {
     bool ConstantColumn(int site) const {
         bool ret = true;
         int tax = 0;
-        while ((tax < GetNtaxa()) && (Data[tax][site] == unknown)) {
+        while ((tax < GetNtaxa()) && isMissing(tax, site)) {
             tax++;
         }
 
         if (tax < GetNtaxa()) {
-            int refstate = Data[tax][site];
+            int refstate = GetState(tax, site);
 
             while ((tax < GetNtaxa()) && ret) {
-                if (Data[tax][site] != -1) {
-                    ret &= static_cast<int>(Data[tax][site] == refstate);
+                if (!isMissing(tax, site)) {
+                    ret &= static_cast<int>(GetState(tax, site) == refstate);
                 }
                 tax++;
             }
@@ -159,7 +184,9 @@ class SequenceAlignment {
     const StateSpace *statespace;
     bool owntaxset;
     bool ownstatespace;
-    std::vector<std::vector<int>> Data;
+    // site-major, one byte per entry
+    std::vector<unsigned char> Data;
+    static const unsigned char missingcode = 255;
 };
 
 /**
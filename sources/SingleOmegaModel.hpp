@@ -28,7 +28,6 @@
 class SingleOmegaModel : public ProbModel {
     // tree and data
     Tree *tree;
-    FileSequenceAlignment *data;
     const TaxonSet *taxonset;
     CodonSequenceAlignment *codondata;
 
@@ -39,6 +38,18 @@ class SingleOmegaModel : public ProbModel {
     int blmode;
     int nucmode;
 
+    // restriction of the tree and of the data to the taxa present in the
+    // alignment (only if taxa are subsetted, see constructor); the phyloprocess
+    // then runs over subtree, each branch of which stands for a series of
+    // collapsed branches of tree, with a length equal to the sum of their
+    // lengths (subbranchlength)
+    Tree *subtree;
+    SequenceAlignment *subdata;
+    // index in codondata of each taxon of subdata
+    vector<int> subtaxa;
+    vector<vector<int>> collapsedbranches;
+    SimpleBranchArray<double> *subbranchlength;
+
     // Branch lengths
 
     double lambda;
@@ -100,13 +111,15 @@ class SingleOmegaModel : public ProbModel {
     //!
     //! Note: in itself, the constructor does not allocate the model;
     //! It only reads the data and tree file and register them together.
-    SingleOmegaModel(string datafile, string treefile) {
+    //! If subsettaxa is true, and some taxa are entirely missing from the
+    //! alignment, substitution histories are sampled over the tree restricted to
+    //! the present taxa (branch lengths are still defined over the whole tree).
+    SingleOmegaModel(string datafile, string treefile, bool subsettaxa = false) {
 
         blmode = 0;
         nucmode = 0;
 
-        data = new FileSequenceAlignment(datafile);
-        codondata = new CodonSequenceAlignment(data, true);
+        codondata = new CodonSequenceAlignment(datafile, true);
 
         Nsite = codondata->GetNsite();  // # columns
         Ntaxa = codondata->GetNtaxa();
@@ -121,6 +134,21 @@ class SingleOmegaModel : public ProbModel {
 
         tree->SetIndices();
         Nbranch = tree->GetNbranch();
+
+        subtree = nullptr;
+        subdata = nullptr;
+        subbranchlength = nullptr;
+        if (subsettaxa) {
+            vector<int> present = codondata->GetPresentTaxa();
+            if ((present.size() >= 2) && ((int)present.size() < Ntaxa)) {
+                subtaxa = present;
+                subdata = new SequenceAlignment(*codondata, present);
+                subtree = new Tree(tree);
+                subtree->RegisterWithSubset(subdata->GetTaxonSet());
+                subtree->SetIndices();
+                collapsedbranches = tree->GetCollapsedBranches(*subtree);
+            }
+        }
     }
 
     //! model allocation
@@ -158,7 +186,13 @@ class SingleOmegaModel : public ProbModel {
         omega = 1.0;
         codonmatrix = new MGOmegaCodonSubMatrix(GetCodonStateSpace(), nucmatrix, omega);
 
-        phyloprocess = new PhyloProcess(tree, codondata, branchlength, 0, codonmatrix);
+        if (subtree) {
+            subbranchlength = new SimpleBranchArray<double>(*subtree);
+            UpdateSubBranchLengths();
+            phyloprocess = new PhyloProcess(subtree, subdata, subbranchlength, 0, codonmatrix);
+        } else {
+            phyloprocess = new PhyloProcess(tree, codondata, branchlength, 0, codonmatrix);
+        }
         phyloprocess->Unfold();
     }
 
@@ -197,7 +231,25 @@ class SingleOmegaModel : public ProbModel {
 
     //! set branch lengths to a new value (multi-gene analyses)
     void SetBranchLengths(const BranchSelector<double> &inbranchlength) {
+        if (subtree) {
+            phyloprocess->RescaleCollapsedPaths(collapsedbranches, *branchlength, inbranchlength);
+        }
         branchlength->Copy(inbranchlength);
+        UpdateSubBranchLengths();
+    }
+
+    //! \brief when taxa are subsetted: set the length of each branch of the
+    //! restricted tree to the sum of the lengths of its collapsed branches
+    void UpdateSubBranchLengths() {
+        if (subtree) {
+            for (int j = 0; j < subtree->GetNbranch(); j++) {
+                double length = 0;
+                for (int k : collapsedbranches[j]) {
+                    length += branchlength->GetVal(k);
+                }
+                (*subbranchlength)[j] = length;
+            }
+        }
     }
 
     //! get a copy of branch lengths into array given as argument
@@ -309,6 +361,7 @@ class SingleOmegaModel : public ProbModel {
         if (blmode == 0) {
             blhypermean->SetAllBranches(1.0 / lambda);
         }
+        UpdateSubBranchLengths();
         TouchMatrices();
         ResampleSub(1.0);
     }
@@ -319,14 +372,43 @@ class SingleOmegaModel : public ProbModel {
 
     //! \brief post pred function (does the update of all fields before doing the
     //! simulation)
-    void PostPred(string name) override {
+    //!
+    //! simu is over the whole taxon set (as codondata); if taxa are subsetted,
+    //! taxa absent from the data are left missing
+    void PostPredSimu(SequenceAlignment &simu) override {
         if (blmode == 0) {
             blhypermean->SetAllBranches(1.0 / lambda);
         }
+        UpdateSubBranchLengths();
         TouchMatrices();
-        phyloprocess->PostPredSample(name);
+        if (subtree) {
+            // leaves of subtree are indexed by the taxa of subdata
+            SequenceAlignment subsimu(*subdata);
+            phyloprocess->PostPredSample(&subsimu);
+            for (int site = 0; site < Nsite; site++) {
+                for (int taxon = 0; taxon < Ntaxa; taxon++) {
+                    simu.SetState(taxon, site, unknown);
+                }
+                for (size_t i = 0; i < subtaxa.size(); i++) {
+                    simu.SetState(subtaxa[i], site, subsimu.GetState(i, site));
+                }
+            }
+        } else {
+            phyloprocess->PostPredSample(&simu);
+        }
     }
 
+    //! \brief post pred function (simulates and writes alignment into file)
+    void PostPred(string name) override {
+        SequenceAlignment simu(*codondata);
+        PostPredSimu(simu);
+        ofstream os(name.c_str());
+        simu.ToStream(os);
+    }
+
+    //! return the codon alignment
+    const CodonSequenceAlignment *GetCodonData() const override { return codondata; }
+
     //-------------------
     // Priors and likelihood
     //-------------------
@@ -410,7 +492,12 @@ class SingleOmegaModel : public ProbModel {
     //! substitution mappings)
     void CollectLengthSuffStat() {
         lengthpathsuffstatarray->Clear();
-        lengthpathsuffstatarray->AddLengthPathSuffStat(*phyloprocess);
+        if (subtree) {
+            lengthpathsuffstatarray->AddLengthPathSuffStat(*phyloprocess, collapsedbranches,
+                                                           *branchlength);
+        } else {
+            lengthpathsuffstatarray->AddLengthPathSuffStat(*phyloprocess);
+        }
     }
 
     //! \brief return log prob of current substitution mapping, as a function of
@@ -506,6 +593,7 @@ class SingleOmegaModel : public ProbModel {
 
     //! complete series of MCMC moves on all parameters (repeated nrep times)
     void MoveParameters(int nrep) {
+        PERF_TIMER(ParameterMove);
         for (int rep = 0; rep < nrep; rep++) {
             if (!FixedBranchLengths()) {
                 MoveBranchLengths();
@@ -534,13 +622,23 @@ class SingleOmegaModel : public ProbModel {
     //! Gibbs resample branch lengths (based on sufficient statistics and current
     //! value of lambda)
     void ResampleBranchLengths() {
+        PERF_TIMER(BranchLengthMove);
         CollectLengthSuffStat();
-        branchlength->GibbsResample(*lengthpathsuffstatarray);
+        if (subtree) {
+            SimpleBranchArray<double> oldlength(*tree);
+            oldlength.Copy(*branchlength);
+            branchlength->GibbsResample(*lengthpathsuffstatarray);
+            phyloprocess->RescaleCollapsedPaths(collapsedbranches, oldlength, *branchlength);
+            UpdateSubBranchLengths();
+        } else {
+            branchlength->GibbsResample(*lengthpathsuffstatarray);
+        }
     }
 
     //! MH move on branch lengths hyperparameters (here, scaling move on lambda,
     //! based on suffstats for branch lengths)
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &SingleOmegaModel::LambdaHyperLogProb, &SingleOmegaModel::NoUpdate,
@@ -555,6 +653,7 @@ class SingleOmegaModel : public ProbModel {
     //! MH moves on nucleotide rate parameters (nucrelrate and nucstat: using
     //! ProfileMove)
     void MoveNucRates() {
+        PERF_TIMER(NucRatesMove);
         CollectNucPathSuffStat();
 
         ProfileMove(nucrelrate, 0.1, 1, 3, &SingleOmegaModel::NucRatesLogProb,
@@ -577,6 +676,7 @@ class SingleOmegaModel : public ProbModel {
     //! Gibbs resample omega (based on sufficient statistics of current
     //! substitution mapping)
     void MoveOmega() {
+        PERF_TIMER(OmegaMove);
         omegapathsuffstat.Clear();
         omegapathsuffstat.AddSuffStat(*codonmatrix, pathsuffstat);
         double alpha = 1.0 / omegahyperinvshape;
@@ -622,5 +722,6 @@ class SingleOmegaModel : public ProbModel {
         is >> nucrelrate;
         is >> lambda;
         is >> *branchlength;
+        UpdateSubBranchLengths();
     }
 };
@@ -17,7 +17,6 @@ class SiteOmegaModel : public ProbModel {
 
     // tree and data
     const Tree *tree;
-    FileSequenceAlignment *data;
     const TaxonSet *taxonset;
     const CodonSequenceAlignment *codondata;
 
@@ -105,8 +104,7 @@ class SiteOmegaModel : public ProbModel {
         blmode = 0;
         nucmode = 0;
 
-        data = new FileSequenceAlignment(datafile);
-        codondata = new CodonSequenceAlignment(data, true);
+        codondata = new CodonSequenceAlignment(datafile, true);
 
         Nsite = codondata->GetNsite();  // # columns
         Ntaxa = codondata->GetNtaxa();
@@ -340,15 +338,26 @@ class SiteOmegaModel : public ProbModel {
 
     //! \brief post pred function (does the update of all fields before doing the
     //! simulation)
-    void PostPred(string name) override {
+    void PostPredSimu(SequenceAlignment &simu) override {
         if (blmode == 0) {
             blhypermean->SetAllBranches(1.0 / lambda);
         }
         SetOmegaParameters(omegamean,omegainvshape);
         TouchMatrices();
-        phyloprocess->PostPredSample(name);
+        phyloprocess->PostPredSample(&simu);
     }
 
+    //! \brief post pred function (simulates and writes alignment into file)
+    void PostPred(string name) override {
+        SequenceAlignment simu(*codondata);
+        PostPredSimu(simu);
+        ofstream os(name.c_str());
+        simu.ToStream(os);
+    }
+
+    //! return the codon alignment
+    const CodonSequenceAlignment *GetCodonData() const override { return codondata; }
+
     //-------------------
     // Priors and likelihood
     //-------------------
@@ -549,6 +558,7 @@ class SiteOmegaModel : public ProbModel {
 
     //! complete series of MCMC moves on all parameters (repeated nrep times)
     void MoveParameters(int nrep) {
+        PERF_TIMER(ParameterMove);
         for (int rep = 0; rep < nrep; rep++) {
             if (!FixedBranchLengths()) {
                 MoveBranchLengths();
@@ -579,6 +589,7 @@ class SiteOmegaModel : public ProbModel {
     //! Gibbs resample branch lengths (based on sufficient statistics and current
     //! value of lambda)
     void ResampleBranchLengths() {
+        PERF_TIMER(BranchLengthMove);
         CollectLengthSuffStat();
         branchlength->GibbsResample(*lengthpathsuffstatarray);
     }
@@ -586,6 +597,7 @@ class SiteOmegaModel : public ProbModel {
     //! MH move on branch lengths hyperparameters (here, scaling move on lambda,
     //! based on suffstats for branch lengths)
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &SiteOmegaModel::LambdaHyperLogProb, &SiteOmegaModel::NoUpdate,
@@ -600,6 +612,7 @@ class SiteOmegaModel : public ProbModel {
     //! MH moves on nucleotide rate parameters (nucrelrate and nucstat: using
     //! ProfileMove)
     void MoveNucRates() {
+        PERF_TIMER(NucRatesMove);
         CollectNucPathSuffStat();
 
         ProfileMove(nucrelrate, 0.1, 1, 3, &SiteOmegaModel::NucRatesLogProb,
@@ -620,6 +633,7 @@ class SiteOmegaModel : public ProbModel {
     // Omega
 
     void MoveOmega() {
+        PERF_TIMER(OmegaMove);
         omegapathsuffstatarray->Clear();
         omegapathsuffstatarray->AddSuffStat(*codonmatrixarray, *pathsuffstatarray);
         omegaarray->GibbsResample(*omegapathsuffstatarray);
@@ -627,6 +641,7 @@ class SiteOmegaModel : public ProbModel {
     }
 
     void MoveOmegaHyperParameters() {
+        PERF_TIMER(HyperMove);
         omegahypersuffstat.Clear();
         omegahypersuffstat.AddSuffStat(*omegaarray);
         ScalingMove(omegamean, 1.0, 10, &SiteOmegaModel::OmegaHyperLogProb,
@@ -62,7 +62,6 @@ class BranchMixtureSelector : public BranchSelector<T> {
 class SparseConditionOmegaModel : public ProbModel {
     // tree and data
     Tree *tree;
-    FileSequenceAlignment *data;
     const TaxonSet *taxonset;
     CodonSequenceAlignment *codondata;
 
@@ -163,8 +162,7 @@ class SparseConditionOmegaModel : public ProbModel {
         blmode = 0;
         nucmode = 0;
 
-        data = new FileSequenceAlignment(datafile);
-        codondata = new CodonSequenceAlignment(data, true);
+        codondata = new CodonSequenceAlignment(datafile, true);
 
         Nsite = codondata->GetNsite();  // # columns
         Ntaxa = codondata->GetNtaxa();
@@ -396,7 +394,7 @@ class SparseConditionOmegaModel : public ProbModel {
 
     //! \brief post pred function (does the update of all fields before doing the
     //! simulation)
-    void PostPred(string name) override {
+    void PostPredSimu(SequenceAlignment &simu) override {
         if (blmode == 0) {
             blhypermean->SetAllBranches(1.0 / lambda);
         }
@@ -407,9 +405,20 @@ class SparseConditionOmegaModel : public ProbModel {
         meanomegaarray->SetMulVal(genew);
         condomegaarray->Update();
         TouchMatrices();
-        phyloprocess->PostPredSample(name);
+        phyloprocess->PostPredSample(&simu);
     }
 
+    //! \brief post pred function (simulates and writes alignment into file)
+    void PostPred(string name) override {
+        SequenceAlignment simu(*codondata);
+        PostPredSimu(simu);
+        ofstream os(name.c_str());
+        simu.ToStream(os);
+    }
+
+    //! return the codon alignment
+    const CodonSequenceAlignment *GetCodonData() const override { return codondata; }
+
     //! \brief dummy function that does not do anything.
     //!
     //! Used for the templates of ScalingMove, SlidingMove and ProfileMove
@@ -572,6 +581,7 @@ class SparseConditionOmegaModel : public ProbModel {
 
     //! complete series of MCMC moves on all parameters (repeated nrep times)
     void MoveParameters(int nrep) {
+        PERF_TIMER(ParameterMove);
         for (int rep = 0; rep < nrep; rep++) {
             if (!FixedBranchLengths()) {
                 MoveBranchLengths();
@@ -600,6 +610,7 @@ class SparseConditionOmegaModel : public ProbModel {
     //! Gibbs resample branch lengths (based on sufficient statistics and current
     //! value of lambda)
     void ResampleBranchLengths() {
+        PERF_TIMER(BranchLengthMove);
         CollectLengthSuffStat();
         branchlength->GibbsResample(*lengthpathsuffstatarray);
     }
@@ -607,6 +618,7 @@ class SparseConditionOmegaModel : public ProbModel {
     //! MH move on branch lengths hyperparameters (here, scaling move on lambda,
     //! based on suffstats for branch lengths)
     void MoveLambda() {
+        PERF_TIMER(HyperMove);
         hyperlengthsuffstat.Clear();
         hyperlengthsuffstat.AddSuffStat(*branchlength);
         ScalingMove(lambda, 1.0, 10, &SparseConditionOmegaModel::LambdaHyperLogProb, &SparseConditionOmegaModel::NoUpdate,
@@ -621,6 +633,7 @@ class SparseConditionOmegaModel : public ProbModel {
     //! MH moves on nucleotide rate parameters (nucrelrate and nucstat: using
     //! ProfileMove)
     void MoveNucRates() {
+        PERF_TIMER(NucRatesMove);
         CollectNucPathSuffStat();
 
         ProfileMove(nucrelrate, 0.1, 1, 3, &SparseConditionOmegaModel::NucRatesLogProb,
@@ -0,0 +1,145 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include "Chrono.hpp"
+#include "CodonStateSpace.hpp"
+#include "CodonSubMatrix.hpp"
+#include "GTRSubMatrix.hpp"
+#include "Random.hpp"
+
+/**
+ * \brief Benchmark of the inner loop of substitution mapping
+ *
+ * Times the jump chain of an MG codon matrix (61 states), as used for drawing
+ * substitution histories (PhyloProcess::ResampleAcceptReject) and for
+ * forward simulation (SubMatrix::DrawFiniteTime). Each operation is timed
+ * as implemented in SubMatrix (alias table of the jump probabilities) and as
+ * it was before (copy of the row of the generator and linear scan, reproduced
+ * below). The table reports millions of calls per second, then the largest
+ * gap between the observed frequencies of the next state and the true jump
+ * probabilities. That gap should be of the order of 1/sqrt(ncall) for both
+ * methods.
+ *
+ * usage: submapbench [ncall]
+ */
+
+// former implementations, copying the row and scanning it
+
+static double LegacyWaitingTime(const SubMatrix &m, int state) {
+    EVector row = m.GetRow(state);
+    return Random::sExpo() / (-row[state]);
+}
+
+static int LegacyOneStep(const SubMatrix &m, int state) {
+    EVector row = m.GetRow(state);
+    double p = -row[state] * Random::Uniform();
+    int k = -1;
+    double tot = 0;
+    do {
+        k++;
+        if (k != state) {
+            tot += row[k];
+        }
+    } while ((k < m.GetNstate()) && (tot < p));
+    return k;
+}
+
+static int LegacyFiniteTime(const SubMatrix &m, int state, double time) {
+    double t = 0;
+    while (t < time) {
+        t += LegacyWaitingTime(m, state);
+        if (t < time) {
+            state = LegacyOneStep(m, state);
+        }
+    }
+    return state;
+}
+
+// jump chain started from each state in turn; returns the largest deviation
+// between observed and expected frequencies of the next state
+template <class F>
+static void BenchStep(string name, const SubMatrix &m, int n, F step) {
+    int N = m.GetNstate();
+    vector<double> count(N * N, 0);
+    Chrono chrono;
+    chrono.Start();
+    for (int i = 0; i < n; i++) {
+        int state = i % N;
+        count[state * N + step(state)]++;
+    }
+    chrono.Stop();
+    double maxdiff = 0;
+    for (int a = 0; a < N; a++) {
+        double tot = 0;
+        for (int b = 0; b < N; b++) {
+            tot += count[a * N + b];
+        }
+        for (int b = 0; b < N; b++) {
+            double expected = (a == b) ? 0 : -m(a, b) / m(a, a);
+            double diff = fabs(count[a * N + b] / tot - expected);
+            if (maxdiff < diff) {
+                maxdiff = diff;
+            }
+        }
+    }
+    cout << name << '\t' << n / chrono.GetTime() / 1000 << '\t' << maxdiff << '\n';
+}
+
+template <class F>
+static void BenchTime(string name, const SubMatrix &m, int n, F draw) {
+    int N = m.GetNstate();
+    Chrono chrono;
+    double sum = 0;
+    chrono.Start();
+    for (int i = 0; i < n; i++) {
+        sum += draw(i % N);
+    }
+    chrono.Stop();
+    cout << name << '\t' << n / chrono.GetTime() / 1000 << "\t(mean " << sum / n << ")\n";
+}
+
+int main(int argc, char *argv[]) {
+    int n = 2000000;
+    if (argc > 1) {
+        n = atoi(argv[1]);
+    }
+    if (n <= 0) {
+        cerr << "usage: submapbench [ncall]\n";
+        exit(1);
+    }
+
+    CodonStateSpace statespace(Universal);
+    vector<double> rr(Nrr);
+    for (int k = 0; k < Nrr; k++) {
+        rr[k] = Random::sGamma(1.0);
+    }
+    vector<double> stat(Nnuc);
+    for (int k = 0; k < Nnuc; k++) {
+        stat[k] = Random::sGamma(5.0);
+    }
+    GTRSubMatrix nucmatrix(Nnuc, rr, stat, true);
+    MGOmegaCodonSubMatrix m(&statespace, &nucmatrix, 0.3);
+    int N = m.GetNstate();
+
+    cout << "operation\t\tMcalls/s\tmax freq. error\n";
+    BenchStep("one step (scan) ", m, n, [&m](int s) { return LegacyOneStep(m, s); });
+    BenchStep("one step (alias)", m, n, [&m](int s) { return m.DrawOneStep(s); });
+    BenchTime("waiting time (copy)", m, n, [&m](int s) { return LegacyWaitingTime(m, s); });
+    BenchTime("waiting time       ", m, n, [&m](int s) { return m.DrawWaitingTime(s); });
+
+    // total rate of the matrix, so that branch lengths are in expected numbers
+    // of substitutions
+    double rate = 0;
+    for (int a = 0; a < N; a++) {
+        rate -= m.Stationary(a) * m(a, a);
+    }
+    double length[] = {0.1, 1.0, 10.0};
+    for (double l : length) {
+        ostringstream s1, s2;
+        s1 << "finite time " << l << " (scan) ";
+        s2 << "finite time " << l << " (alias)";
+        double t = l / rate;
+        BenchTime(s1.str(), m, n / 10, [&m, t](int s) { return LegacyFiniteTime(m, s, t); });
+        BenchTime(s2.str(), m, n / 10, [&m, t](int s) { return m.DrawFiniteTime(s, t); });
+    }
+}
@@ -23,6 +23,7 @@ const int witheigen = 1;
 // ---------------------------------------------------------------------------
 SubMatrix::SubMatrix(int inNstate, bool innormalise) : Nstate(inNstate), normalise(innormalise) {
     ndiagfailed = 0;
+    version = 0;
     Create();
 }
 
@@ -61,10 +62,7 @@ void SubMatrix::Create() {
     }
 
     UniMu = 1;
-    mPow = new double **[UniSubNmax];
-    for (int n = 0; n < UniSubNmax; n++) {
-        mPow[n] = nullptr;
-    }
+    npow = 0;
 
     flagarray = new bool[Nstate];
     diagflag = false;
@@ -73,6 +71,14 @@ void SubMatrix::Create() {
         flagarray[i] = false;
     }
     powflag = false;
+
+    // logQ is sized by LogRate, if ever needed
+    logStationary.assign(Nstate, 0);
+    logflagarray.assign(Nstate, 0);
+    logstatflag = false;
+
+    // jumpprob and jumpalias are allocated by UpdateJumpTable, if ever needed
+    jumpflagarray.assign(Nstate, 0);
 }
 
 // ---------------------------------------------------------------------------
@@ -92,18 +98,6 @@ SubMatrix::~SubMatrix() {
         delete[] ptrv;
         delete[] ptrStationary;
     }
-
-    if (mPow != nullptr) {
-        for (int n = 0; n < UniSubNmax; n++) {
-            if (mPow[n] != nullptr) {
-                for (int i = 0; i < Nstate; i++) {
-                    delete[] mPow[n][i];
-                }
-                delete[] mPow[n];
-            }
-        }
-        delete[] mPow;
-    }
     delete[] flagarray;
 }
 
@@ -284,6 +278,7 @@ double SubMatrix::GetRate() const {
 // ---------------------------------------------------------------------------
 
 void SubMatrix::UpdateMatrix() const {
+    version++;
     UpdateStationary();
     for (int k = 0; k < Nstate; k++) {
         ComputeArray(k);
@@ -309,6 +304,46 @@ void SubMatrix::Normalise() const {
     }
 }
 
+// ---------------------------------------------------------------------------
+//     UpdateJumpTable()
+// ---------------------------------------------------------------------------
+
+void SubMatrix::UpdateJumpTable(int state) const {
+    if (jumpprob.empty()) {
+        jumpprob.assign(Nstate * Nstate, 0);
+        jumpalias.assign(Nstate * Nstate, 0);
+    }
+    double *prob = jumpprob.data() + state * Nstate;
+    for (int k = 0; k < Nstate; k++) {
+        prob[k] = (k == state) ? 0 : (*this)(state, k);
+    }
+    if (-(*this)(state, state) <= 0) {
+        std::cerr << "error in DrawOneStep: null rate away from state " << state << '\n';
+        exit(1);
+    }
+    Random::MakeAliasTable(prob, Nstate, prob, jumpalias.data() + state * Nstate);
+    jumpflagarray[state] = true;
+}
+
+// ---------------------------------------------------------------------------
+//     GetFiniteTimeTransitionRow()
+// ---------------------------------------------------------------------------
+
+void SubMatrix::GetFiniteTimeTransitionRow(int state, double *p, double efflength) const {
+    if (!diagflag) {
+        Diagonalise();
+    }
+    // row state of exp(efflength Q) = u diag(exp(efflength v)) invu
+    EVector w = u.row(state).transpose().cwiseProduct((efflength * v).array().exp().matrix());
+    Eigen::Map<EVector> row(p, Nstate);
+    row.noalias() = invu.transpose() * w;
+    for (int k = 0; k < Nstate; k++) {
+        if (p[k] < 0) {
+            p[k] = 0;
+        }
+    }
+}
+
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 //     Powers
@@ -328,21 +363,15 @@ void SubMatrix::ActivatePowers() const {
             }
         }
 
-        CreatePowers(0);
+        // R = I + Q/UniMu
+        mPow.resize(Nstate * Nstate);
+        Eigen::Map<EMatrix> R(mPow.data(), Nstate, Nstate);
         for (int i = 0; i < Nstate; i++) {
             for (int j = 0; j < Nstate; j++) {
-                mPow[0][i][j] = 0;
-            }
-        }
-        for (int i = 0; i < Nstate; i++) {
-            mPow[0][i][i] = 1;
-        }
-        for (int i = 0; i < Nstate; i++) {
-            for (int j = 0; j < Nstate; j++) {
-                mPow[0][i][j] += Q(i, j) / UniMu;
-                if (mPow[0][i][j] < 0) {
+                R(i, j) = static_cast<double>(i == j) + Q(i, j) / UniMu;
+                if (R(i, j) < 0) {
                     cerr << "error in SubMatrix::ComputePowers: negative prob : ";
-                    cerr << i << '\t' << j << '\t' << mPow[0][i][j] << '\n';
+                    cerr << i << '\t' << j << '\t' << R(i, j) << '\n';
                     cerr << "Nstate : " << Nstate << '\n';
                     exit(1);
                 }
@@ -355,14 +384,12 @@ void SubMatrix::ActivatePowers() const {
 
 void SubMatrix::InactivatePowers() const {
     if (powflag) {
-        for (int n = 0; n < UniSubNmax; n++) {
-            if (mPow[n] != nullptr) {
-                for (int i = 0; i < Nstate; i++) {
-                    delete[] mPow[n][i];
-                }
-                delete[] mPow[n];
-                mPow[n] = nullptr;
-            }
+        // keep the buffer allocated if small (it will be refilled at next
+        // activation), but release the memory taken by a long series of powers
+        if (mPow.capacity() > static_cast<size_t>(PowNkeep * Nstate * Nstate)) {
+            std::vector<double>().swap(mPow);
+        } else {
+            mPow.clear();
         }
         nunimax += npow;
         nuni++;
@@ -372,15 +399,6 @@ void SubMatrix::InactivatePowers() const {
     }
 }
 
-void SubMatrix::CreatePowers(int n) const {
-    if (mPow[n] == nullptr) {
-        mPow[n] = new double *[Nstate];
-        for (int i = 0; i < Nstate; i++) {
-            mPow[n][i] = new double[Nstate];
-        }
-    }
-}
-
 double SubMatrix::GetUniformizationMu() const {
     if (!powflag) {
         ActivatePowers();
@@ -401,7 +419,7 @@ double SubMatrix::Power(int n, int i, int j) const {
     if (n > npow) {
         ComputePowers(n);
     }
-    return mPow[n - 1][i][j];
+    return mPow[(n - 1) * Nstate * Nstate + j * Nstate + i];
 }
 
 void SubMatrix::ComputePowers(int N) const {
@@ -409,17 +427,15 @@ void SubMatrix::ComputePowers(int N) const {
         ActivatePowers();
     }
     if (N > npow) {
+        // all powers in one contiguous buffer; R^(n+1) = R^n * R (blocked
+        // matrix product, done by Eigen)
+        int size = Nstate * Nstate;
+        mPow.resize(N * size);
+        Eigen::Map<const EMatrix> R(mPow.data(), Nstate, Nstate);
         for (int n = npow; n < N; n++) {
-            CreatePowers(n);
-            for (int i = 0; i < Nstate; i++) {
-                for (int j = 0; j < Nstate; j++) {
-                    double &t = mPow[n][i][j];
-                    t = 0;
-                    for (int k = 0; k < Nstate; k++) {
-                        t += mPow[n - 1][i][k] * mPow[0][k][j];
-                    }
-                }
-            }
+            Eigen::Map<const EMatrix> prev(mPow.data() + (n - 1) * size, Nstate, Nstate);
+            Eigen::Map<EMatrix> next(mPow.data() + n * size, Nstate, Nstate);
+            next.noalias() = prev * R;
         }
         npow = N;
     }
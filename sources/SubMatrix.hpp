@@ -2,9 +2,12 @@
 #define SUBMATRIX_H
 
 // #include "Eigen/Dense"
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <vector>
 #include "Random.hpp"
 
 // using EMatrix = Eigen::MatrixXd;
@@ -36,8 +39,9 @@ class SubMatrix {
     //! const access to entry at ith row and jth column (checked for current
     //! update status, see UpdateMatrix)
     double operator()(int /*i*/, int /*j*/) const;
-    //! const access to a row of the matrix (checked for current update status)
-    EVector GetRow(int i) const;
+    //! const access to a row of the matrix (checked for current update status);
+    //! returns a view into the matrix, not a copy
+    EMatrix::ConstRowXpr GetRow(int i) const;
 
     //! const access to equilbrium frequency of state i (checked for current
     //! update status)
@@ -47,6 +51,16 @@ class SubMatrix {
     //! status)
     const EVector &GetStationary() const;
 
+    //! \brief log of the rate from state i to state j (i != j)
+    //!
+    //! Each entry is computed on first access and cached until the next call to
+    //! CorruptMatrix, so that a matrix scored against many suff stats (see
+    //! PathSuffStat::GetLogProb) computes each logarithm at most once.
+    double LogRate(int i, int j) const;
+
+    //! log of equilibrium frequency of state i (cached as LogRate)
+    double LogStationary(int i) const;
+
     //! dimension of the statespace
     int GetNstate() const { return Nstate; }
 
@@ -75,6 +89,12 @@ class SubMatrix {
     //! all dependent variables
     virtual void CorruptMatrix();
 
+    //! \brief number of calls to CorruptMatrix and UpdateMatrix on this matrix
+    //!
+    //! used by PhyloProcess to detect that the matrix has not changed since the
+    //! log likelihood was last computed
+    unsigned long GetVersion() const { return version; }
+
     //! \brief recalculate all rates and dependent variables
     //!
     //! access to rates, equilibrium frequencies or exponentiation/diagonalisation
@@ -101,17 +121,29 @@ class SubMatrix {
     //! possible states down, along branch of efflength=length*rate
     void GetFiniteTimeTransitionProb(int state, double *down, double efflength) const;
 
+    //! same as GetFiniteTimeTransitionProb(state, p, efflength), but computed
+    //! directly in the eigen basis (one matrix-vector product), without
+    //! normalization check; negative rounding errors are set to 0
+    void GetFiniteTimeTransitionRow(int state, double *p, double efflength) const;
+
     //! return the transition probability between stateup and statedown along
     //! branch of efflength = length*rate
     double GetFiniteTimeTransitionProb(int stateup, int statedown, double efflength) const;
     //! draw the uniformized number of transitions along the branch, conditional
     //! on begin and end states
     int DrawUniformizedSubstitutionNumber(int stateup, int statedown, double efflength) const;
+    //! same as above, with transition probability Z between stateup and
+    //! statedown (see GetFiniteTimeTransitionProb) given by the caller
+    int DrawUniformizedSubstitutionNumber(int stateup, int statedown, double efflength,
+                                          double Z) const;
     //! draw the state of the next event, given current state and given that total
     //! number of events until reaching statedown is n
     int DrawUniformizedTransition(int state, int statedown, int n) const;
 
-    //! draw state of next event given current state
+    //! \brief draw state of next event given current state
+    //!
+    //! Uses an alias table of the jump probabilities away from the current
+    //! state (constant time), built on first access after CorruptMatrix.
     int DrawOneStep(int state) const;
     //! draw state after total time, given current state
     int DrawFiniteTime(int state, double time) const;
@@ -120,10 +152,17 @@ class SubMatrix {
     //! draw state from equilibrium frequencies
     int DrawFromStationary() const;
 
+    //! total number of diagonalizations (over all matrices)
+    static int GetDiagCount() { return diagcount; }
+    //! total number of uniformized substitution numbers truncated at UniSubNmax
+    static int GetUniSubCount() { return nunisubcount; }
+
   protected:
     static const int UniSubNmax = 500;
+    // number of powers whose storage is kept across CorruptMatrix calls (see
+    // InactivatePowers)
+    static const int PowNkeep = 16;
     static int nunisubcount;
-    static int GetUniSubCount() { return nunisubcount; }
 
     static int nuni;
     static int nunimax;
@@ -149,9 +188,9 @@ class SubMatrix {
 
     void UpdateRow(int state) const;
     void UpdateStationary() const;
+    void UpdateJumpTable(int state) const;
 
     void ComputePowers(int N) const;
-    void CreatePowers(int n) const;
 
     bool ArrayUpdated() const;
 
@@ -166,12 +205,33 @@ class SubMatrix {
     mutable bool diagflag;
     mutable bool statflag;
     mutable bool *flagarray;
+    // see GetVersion
+    mutable unsigned long version;
+
+    // cached logarithms of rates (row-major) and of equilibrium frequencies:
+    // NaN means not yet computed; logQ is sized on the first call to LogRate;
+    // a row of logQ (resp. logStationary) is reset on first access after
+    // CorruptMatrix, as indicated by logflagarray (resp. logstatflag)
+    mutable std::vector<double> logQ;
+    mutable std::vector<double> logStationary;
+    mutable std::vector<char> logflagarray;
+    mutable bool logstatflag;
+
+    // alias tables of the jump chain (rates away from each state, see
+    // DrawOneStep), row-major, allocated on the first call to UpdateJumpTable;
+    // a row is rebuilt on first access after CorruptMatrix, as indicated by
+    // jumpflagarray
+    mutable std::vector<double> jumpprob;
+    mutable std::vector<int> jumpalias;
+    mutable std::vector<char> jumpflagarray;
 
     int Nstate;
     mutable int npow;
     mutable double UniMu;
 
-    double ***mPow;
+    // powers of the uniformized matrix R = I + Q/UniMu: R^n is stored,
+    // column-major (as EMatrix), at offset (n-1)*Nstate*Nstate (n=1..npow)
+    mutable std::vector<double> mPow;
 
     // Q : the infinitesimal generator matrix
     mutable double **ptrQ;
@@ -213,11 +273,13 @@ inline double SubMatrix::operator()(int i, int j) const {
     // return Q[i][j];
 }
 
-inline EVector SubMatrix::GetRow(int i) const {
+inline EMatrix::ConstRowXpr SubMatrix::GetRow(int i) const {
     if (!flagarray[i]) {
         UpdateRow(i);
     }
-    return Q.row(i);
+    // Q is mutable: go through a const reference to get a read-only view
+    const EMatrix &q = Q;
+    return q.row(i);
 }
 
 /*
@@ -244,11 +306,44 @@ inline double SubMatrix::Stationary(int i) const {
     return mStationary[i];
 }
 
+inline double SubMatrix::LogRate(int i, int j) const {
+    if (logQ.empty()) {
+        logQ.resize(Nstate * Nstate);
+    }
+    double *row = logQ.data() + i * Nstate;
+    if (!logflagarray[i]) {
+        std::fill(row, row + Nstate, std::numeric_limits<double>::quiet_NaN());
+        logflagarray[i] = true;
+    }
+    if (std::isnan(row[j])) {
+        row[j] = log((*this)(i, j));
+    }
+    return row[j];
+}
+
+inline double SubMatrix::LogStationary(int i) const {
+    if (!logstatflag) {
+        std::fill(logStationary.begin(), logStationary.end(),
+                  std::numeric_limits<double>::quiet_NaN());
+        logstatflag = true;
+    }
+    if (std::isnan(logStationary[i])) {
+        logStationary[i] = log(Stationary(i));
+    }
+    return logStationary[i];
+}
+
 inline void SubMatrix::CorruptMatrix() {
+    version++;
     diagflag = false;
     statflag = false;
+    logstatflag = false;
     for (int k = 0; k < Nstate; k++) {
         flagarray[k] = false;
+        jumpflagarray[k] = false;
+    }
+    if (!logQ.empty()) {
+        std::fill(logflagarray.begin(), logflagarray.end(), 0);
     }
     InactivatePowers();
 }
@@ -285,76 +380,44 @@ inline void SubMatrix::BackwardPropagate(const double *up, double *down, double
 
     int matSize = GetNstate();
 
-    auto aux = new double[GetNstate()];
+    // work buffer, reused across calls
+    static thread_local std::vector<double> aux;
+    aux.assign(matSize, 0);
 
-    for (int i = 0; i < GetNstate(); i++) {
-        aux[i] = 0;
-    }
-    for (int i = 0; i < GetNstate(); i++) {
-        for (int j = 0; j < GetNstate(); j++) {
-            aux[i] += invu(i, j) * up[j];
-            // aux[i] += invu[i][j] * up[j];
+    // aux = exp(length * v) * invu * up, then down = u * aux (matrices are
+    // column-major, hence the order of the loops)
+    for (int j = 0; j < matSize; j++) {
+        double x = up[j];
+        for (int i = 0; i < matSize; i++) {
+            aux[i] += invu(i, j) * x;
         }
     }
-
-    for (int i = 0; i < GetNstate(); i++) {
+    for (int i = 0; i < matSize; i++) {
         aux[i] *= exp(length * v[i]);
-    }
-
-    for (int i = 0; i < GetNstate(); i++) {
         down[i] = 0;
     }
-
-    for (int i = 0; i < GetNstate(); i++) {
-        for (int j = 0; j < GetNstate(); j++) {
-            down[i] += u(i, j) * aux[j];
-            // down[i] += u[i][j] * aux[j];
+    for (int j = 0; j < matSize; j++) {
+        double x = aux[j];
+        for (int i = 0; i < matSize; i++) {
+            down[i] += u(i, j) * x;
         }
     }
 
-    for (int i = 0; i < GetNstate(); i++) {
-        if (std::isnan(down[i])) {
-            std::cerr << "error in back prop\n";
-            for (int j = 0; j < GetNstate(); j++) {
-                std::cerr << up[j] << '\t' << down[j] << '\t' << Stationary(j) << '\n';
+    // negative rounding errors are set to 0 (null vectors are detected by the
+    // caller, see PhyloProcess::Pruning)
+    for (int i = 0; i < matSize; i++) {
+        if (!(down[i] >= 0)) {
+            if (std::isnan(down[i])) {
+                std::cerr << "error in back prop\n";
+                for (int j = 0; j < matSize; j++) {
+                    std::cerr << up[j] << '\t' << down[j] << '\t' << Stationary(j) << '\n';
+                }
+                exit(1);
             }
-            exit(1);
+            down[i] = 0;
         }
     }
-    double maxup = 0;
-    for (int k = 0; k < matSize; k++) {
-        if (up[k] < 0) {
-            std::cerr << "error in backward propagate: negative prob : " << up[k] << "\n";
-            // down[k] = 0;
-        }
-        if (maxup < up[k]) {
-            maxup = up[k];
-        }
-    }
-    double max = 0;
-    for (int k = 0; k < matSize; k++) {
-        if (down[k] < 0) {
-            down[k] = 0;
-        }
-        if (max < down[k]) {
-            max = down[k];
-        }
-    }
-    if (maxup == 0) {
-        std::cerr << "error in backward propagate: null up array\n";
-        exit(1);
-    }
-    if (max == 0) {
-        std::cerr << "error in backward propagate: null array\n";
-        for (int k = 0; k < matSize; k++) {
-            std::cerr << up[k] << '\t' << down[k] << '\n';
-        }
-        std::cerr << '\n';
-        exit(1);
-    }
     down[matSize] = up[matSize];
-
-    delete[] aux;
 }
 
 inline void SubMatrix::ForwardPropagate(const double *down, double *up, double length) const {
@@ -452,11 +515,16 @@ inline int SubMatrix::DrawUniformizedTransition(int state, int statedown, int n)
 
 inline int SubMatrix::DrawUniformizedSubstitutionNumber(int stateup, int statedown,
                                                         double efflength) const {
+    return DrawUniformizedSubstitutionNumber(
+        stateup, statedown, efflength, GetFiniteTimeTransitionProb(stateup, statedown, efflength));
+}
+
+inline int SubMatrix::DrawUniformizedSubstitutionNumber(int stateup, int statedown,
+                                                        double efflength, double Z) const {
     double mu = GetUniformizationMu();
     double fact = exp(-efflength * mu);
     int m = 0;
     double total = (stateup == statedown) * fact;
-    double Z = GetFiniteTimeTransitionProb(stateup, statedown, efflength);
     double q = Random::Uniform() * Z;
 
     while ((m < UniSubNmax) && (total < q)) {
@@ -497,32 +565,15 @@ inline int SubMatrix::DrawFiniteTime(int initstate, double time) const {
 }
 
 inline double SubMatrix::DrawWaitingTime(int state) const {
-    EVector row = GetRow(state);
-    // const double* row = GetRow(state);
-    double t = Random::sExpo() / (-row[state]);
-    return t;
+    return Random::sExpo() / (-(*this)(state, state));
 }
 
 inline int SubMatrix::DrawOneStep(int state) const {
-    EVector row = GetRow(state);
-    double p = -row[state] * Random::Uniform();
-    int k = -1;
-    double tot = 0;
-    do {
-        k++;
-        if (k != state) {
-            tot += row[k];
-        }
-    } while ((k < GetNstate()) && (tot < p));
-    if (k == GetNstate()) {
-        std::cerr << "error in DrawOneStep\n";
-        std::cerr << GetNstate() << '\n';
-        for (int k = 0; k < GetNstate(); k++) {
-            std::cerr << row[k] << '\n';
-        }
-        exit(1);
+    if (!jumpflagarray[state]) {
+        UpdateJumpTable(state);
     }
-    return k;
+    return Random::DrawFromAliasTable(jumpprob.data() + state * Nstate,
+                                      jumpalias.data() + state * Nstate, Nstate);
 }
 
 inline int SubMatrix::DrawFromStationary() const {
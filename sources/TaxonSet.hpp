@@ -42,6 +42,8 @@ class TaxonSet {
     std::string GetTaxon(int index) const { return taxlist[index]; }
     //! return taxon index, given the name
     int GetTaxonIndex(std::string intaxon) const;
+    //! whether the set contains a taxon of that name
+    bool HasTaxon(std::string intaxon) const { return taxmap.count(intaxon) != 0; }
     //! return taxon index, given incomplete name (first part)
     int GetTaxonIndexWithIncompleteName(std::string taxname) const;
     //! formatted output to stream
@@ -242,6 +242,49 @@ void Tree::RootAt(Link *from) {
     root->SetNode(from->GetNode());
 }
 
+void Tree::MakeSchedule() {
+    preorder.clear();
+    postorder.clear();
+    parentnode.assign(Nnode, -1);
+    nodebranch.assign(Nnode, -1);
+    nodelink.assign(Nnode, nullptr);
+    MakeSchedule(GetRoot());
+    if ((int)preorder.size() != Nnode) {
+        cerr << "error in Tree::MakeSchedule: node indices are not contiguous\n";
+        exit(1);
+    }
+
+    // children of each node, stored contiguously in link order
+    childbegin.assign(Nnode + 1, 0);
+    children.clear();
+    for (int node = 0; node < Nnode; node++) {
+        childbegin[node] = children.size();
+        const Link *from = nodelink[node];
+        for (const Link *link = from->Next(); link != from; link = link->Next()) {
+            children.push_back(link->Out()->GetNode()->GetIndex());
+        }
+    }
+    childbegin[Nnode] = children.size();
+}
+
+void Tree::MakeSchedule(const Link *from) {
+    int node = from->GetNode()->GetIndex();
+    if ((node < 0) || (node >= Nnode) || nodelink[node]) {
+        cerr << "error in Tree::MakeSchedule: node indices are not contiguous\n";
+        exit(1);
+    }
+    preorder.push_back(node);
+    nodelink[node] = from;
+    if (!from->isRoot()) {
+        parentnode[node] = from->Out()->GetNode()->GetIndex();
+        nodebranch[node] = from->GetBranch()->GetIndex();
+    }
+    for (const Link *link = from->Next(); link != from; link = link->Next()) {
+        MakeSchedule(link->Out());
+    }
+    postorder.push_back(node);
+}
+
 void Tree::EraseInternalNodeName() { EraseInternalNodeName(GetRoot()); }
 
 void Tree::EraseInternalNodeName(Link *from) {
@@ -253,9 +296,13 @@ void Tree::EraseInternalNodeName(Link *from) {
     }
 }
 
-void Tree::RegisterWith(const TaxonSet *taxset) {
+void Tree::RegisterWith(const TaxonSet *taxset) { RegisterWith(taxset, false); }
+
+void Tree::RegisterWithSubset(const TaxonSet *taxset) { RegisterWith(taxset, true); }
+
+void Tree::RegisterWith(const TaxonSet *taxset, bool prune) {
     int tot = 0;
-    if (!RegisterWith(taxset, GetRoot(), tot)) {
+    if (!RegisterWith(taxset, GetRoot(), tot, prune)) {
         cout << "There is no match between the tree and the sequences.\n";
         exit(1);
     }
@@ -267,9 +314,10 @@ void Tree::RegisterWith(const TaxonSet *taxset) {
     }
 }
 
-bool Tree::RegisterWith(const TaxonSet *taxset, Link *from, int &tot) {
+bool Tree::RegisterWith(const TaxonSet *taxset, Link *from, int &tot, bool prune) {
     if (from->isLeaf()) {
-        int i = taxset->GetTaxonIndex(from->GetNode()->GetName());
+        string name = from->GetNode()->GetName();
+        int i = (prune && !taxset->HasTaxon(name)) ? -1 : taxset->GetTaxonIndex(name);
         if (i != -1) {
             from->GetNode()->SetIndex(i);
             tot++;
@@ -278,7 +326,7 @@ bool Tree::RegisterWith(const TaxonSet *taxset, Link *from, int &tot) {
     }
     Link *previous = from;
     while (previous->Next() != from) {
-        if (RegisterWith(taxset, previous->Next()->Out(), tot)) {
+        if (RegisterWith(taxset, previous->Next()->Out(), tot, prune)) {
             previous = previous->Next();
         } else {
             // cout << "delete !!\n";
@@ -296,6 +344,66 @@ bool Tree::RegisterWith(const TaxonSet *taxset, Link *from, int &tot) {
     return (!from->isLeaf());
 }
 
+vector<vector<int>> Tree::GetCollapsedBranches(const Tree &sub) const {
+    // leaves of sub, in preorder
+    map<string, int> leafindex;
+    for (int node : sub.GetPreorder()) {
+        if (sub.isLeafNode(node)) {
+            int k = leafindex.size();
+            leafindex[sub.GetNodeLink(node)->GetNode()->GetName()] = k;
+        }
+    }
+    int nleaf = leafindex.size();
+
+    // for each node, the set of leaves of sub below it
+    auto getclades = [&leafindex, nleaf](const Tree &t) {
+        vector<vector<bool>> clade(t.GetNnode(), vector<bool>(nleaf, false));
+        for (int node : t.GetPostorder()) {
+            if (t.isLeafNode(node)) {
+                auto i = leafindex.find(t.GetNodeLink(node)->GetNode()->GetName());
+                if (i != leafindex.end()) {
+                    clade[node][i->second] = true;
+                }
+            } else {
+                for (int k = t.GetChildBegin(node); k < t.GetChildEnd(node); k++) {
+                    int child = t.GetChild(k);
+                    for (int j = 0; j < nleaf; j++) {
+                        if (clade[child][j]) {
+                            clade[node][j] = true;
+                        }
+                    }
+                }
+            }
+        }
+        return clade;
+    };
+
+    // sub has no unary node: its nodes are identified by their clades
+    vector<vector<bool>> subclade = getclades(sub);
+    map<vector<bool>, int> subnode;
+    for (int node : sub.GetPreorder()) {
+        subnode[subclade[node]] = node;
+    }
+
+    vector<vector<bool>> clade = getclades(*this);
+    vector<vector<int>> collapsed(sub.GetNbranch());
+    for (int node : GetPreorder()) {
+        if (node != GetRootNode()) {
+            auto i = subnode.find(clade[node]);
+            if ((i != subnode.end()) && (i->second != sub.GetRootNode())) {
+                collapsed[sub.GetNodeBranch(i->second)].push_back(GetNodeBranch(node));
+            }
+        }
+    }
+    for (auto &path : collapsed) {
+        if (path.empty()) {
+            cerr << "error in Tree::GetCollapsedBranches: not a restriction of the tree\n";
+            exit(1);
+        }
+    }
+    return collapsed;
+}
+
 Tree::Tree(string filename) {
     ifstream is(filename.c_str());
     if (!is) {
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <vector>
 #include "Random.hpp"
 #include "StringStreamUtils.hpp"
 using namespace std;
@@ -207,6 +208,24 @@ class Tree {
     //! corresponding taxon in TaxonSet.
     void RegisterWith(const TaxonSet *taxset);
 
+    //! \brief register with a taxon set covering only part of the leaves
+    //!
+    //! same as RegisterWith, except that leaves not found in the taxon set are
+    //! removed from the tree (nodes left with only one child being merged with
+    //! their remaining branch)
+    void RegisterWithSubset(const TaxonSet *taxset);
+
+    //! \brief branches of this tree collapsed into each branch of a restricted
+    //! copy of it
+    //!
+    //! sub should be a copy of this tree from which some leaves were removed
+    //! (by registering it with a smaller taxon set, see RegisterWithSubset), both
+    //! trees being indexed (SetIndices). Returns, for each branch of sub, the
+    //! indices of the branches of this tree along the corresponding path, from
+    //! top to bottom. Branches of this tree leading only to removed leaves, or
+    //! lying above the root of sub, do not appear in any path.
+    vector<vector<int>> GetCollapsedBranches(const Tree &sub) const;
+
     //! defines a global indexing system over all nodes, branches and links (such
     //! that tip node indices are in correspondance with the indexing provided by
     //! the TaxonSet).
@@ -218,6 +237,7 @@ class Tree {
         nodemap.clear();
         branchmap.clear();
         SetIndices(GetRoot(), Nlink, Nnode, Nbranch);
+        MakeSchedule();
     }
 
     //! const access to the set of taxa (tips of the tree)
@@ -226,7 +246,8 @@ class Tree {
     //! const access to the root link
     Link *GetRoot() const /*override*/ { return root; }
 
-    //! reroot: after rerooting, root->next == from
+    //! reroot: after rerooting, root->next == from (SetIndices should then be
+    //! called again, so as to update indices and traversal schedule)
     void RootAt(Link *from);
 
     //! output to stream (newick format)
@@ -245,34 +266,70 @@ class Tree {
     //! return total number of tips
     unsigned int GetSize() const { return GetSize(GetRoot()); }
 
+    //! \brief flat traversal schedule: node indices in preorder
+    //!
+    //! parents come before their children, and children of a given node are
+    //! visited in the order of the chained Link structure, so that iterating
+    //! over this array is equivalent to the usual recursive traversal
+    //! (for (link=from->Next(); link!=from; link=link->Next()) ...).
+    //! Built by SetIndices, along with all other flat arrays below (all
+    //! indexed by node index).
+    const vector<int> &GetPreorder() const { return preorder; }
+
+    //! flat traversal schedule: node indices in postorder (children before
+    //! their parent)
+    const vector<int> &GetPostorder() const { return postorder; }
+
+    //! index of the root node
+    int GetRootNode() const { return preorder[0]; }
+
+    //! index of parent node (-1 for root)
+    int GetParentNode(int node) const { return parentnode[node]; }
+
+    //! index of the branch between node and its parent (-1 for root)
+    int GetNodeBranch(int node) const { return nodebranch[node]; }
+
+    //! link pointing to node, on the side of its parent (i.e. link->Out() is
+    //! on the parent node, and the link is the root link for the root node)
+    const Link *GetNodeLink(int node) const { return nodelink[node]; }
+
+    //! \brief range of children of given node
+    //!
+    //! children of node are GetChild(k), for k=GetChildBegin(node) ..
+    //! GetChildEnd(node)-1; leaves have an empty range.
+    int GetChildBegin(int node) const { return childbegin[node]; }
+    int GetChildEnd(int node) const { return childbegin[node + 1]; }
+    int GetChild(int k) const { return children[k]; }
+
+    //! true if node is a tip
+    bool isLeafNode(int node) const { return childbegin[node] == childbegin[node + 1]; }
+
   private:
     // return const pointer to node with given index
     const Node *GetNode(int index) const {
-        map<int, const Node *>::const_iterator i = nodemap.find(index);
-        if (i == nodemap.end()) {
+        if ((index < 0) || (index >= (int)nodemap.size()) || (nodemap[index] == nullptr)) {
             cerr << "error in Tree::GetNode(int): not found\n";
             exit(1);
         }
-        return i->second;
+        return nodemap[index];
     }
 
     // return const pointer to branch with given index
     const Branch *GetBranch(int index) const {
-        map<int, const Branch *>::const_iterator i = branchmap.find(index);
-        if (i == branchmap.end()) {
+        if ((index < 0) || (index >= (int)branchmap.size())) {
             cerr << "error in Tree::GetBranch(int): not found\n";
             exit(1);
         }
-        return i->second;
+        return branchmap[index];
     }
 
     // return const pointer to link with given index
     Link *GetLink(int index) const {
-        map<int, Link *>::const_iterator i = linkmap.find(index);
-        if (i == linkmap.end()) {
+        if ((index < 0) || (index >= (int)linkmap.size())) {
             cerr << "error in Tree::GetLink(int): not found\n";
+            exit(1);
         }
-        return i->second;
+        return linkmap[index];
     }
 
     // interprets the (string) name field of the branch pointed to by given link
@@ -460,36 +517,55 @@ class Tree {
     // right.
     void DeleteUnaryNode(Link *from);
 
-    // recursive function called by RegisterWith
-    bool RegisterWith(const TaxonSet *taxset, Link *from, int &tot);
+    // recursive functions called by RegisterWith and RegisterWithSubset
+    void RegisterWith(const TaxonSet *taxset, bool prune);
+    bool RegisterWith(const TaxonSet *taxset, Link *from, int &tot, bool prune);
 
-    map<int, const Node *> nodemap;
-    map<int, const Branch *> branchmap;
-    map<int, Link *> linkmap;
+    // index -> pointer tables (filled by SetIndices)
+    vector<const Node *> nodemap;
+    vector<const Branch *> branchmap;
+    vector<Link *> linkmap;
+
+    // flat traversal schedule (see GetPreorder)
+    vector<int> preorder;
+    vector<int> postorder;
+    vector<int> parentnode;
+    vector<int> nodebranch;
+    vector<const Link *> nodelink;
+    vector<int> childbegin;
+    vector<int> children;
+
+    void SetNodeMap(int index, const Node *node) {
+        if (index >= (int)nodemap.size()) {
+            nodemap.resize(index + 1, nullptr);
+        }
+        nodemap[index] = node;
+    }
 
     // recursively set the system of node, branch and link indices
+    // (branch and link indices are attributed in increasing order)
     void SetIndices(Link *from, int &linkindex, int &nodeindex, int &branchindex) {
         if (!from->isRoot()) {
             from->GetBranch()->SetIndex(branchindex);
-            branchmap[branchindex] = from->GetBranch();
+            branchmap.push_back(from->GetBranch());
             branchindex++;
         }
 
         if (!from->isLeaf()) {
             from->GetNode()->SetIndex(nodeindex);
-            nodemap[nodeindex] = from->GetNode();
+            SetNodeMap(nodeindex, from->GetNode());
             nodeindex++;
         } else {
-            nodemap[from->GetNode()->GetIndex()] = from->GetNode();
+            SetNodeMap(from->GetNode()->GetIndex(), from->GetNode());
         }
 
         if (!from->isRoot()) {
             from->Out()->SetIndex(linkindex);
-            linkmap[linkindex] = from->Out();
+            linkmap.push_back(from->Out());
             linkindex++;
         }
         from->SetIndex(linkindex);
-        linkmap[linkindex] = from;
+        linkmap.push_back(from);
         linkindex++;
 
         for (const Link *link = from->Next(); link != from; link = link->Next()) {
@@ -497,6 +573,10 @@ class Tree {
         }
     }
 
+    // build the flat traversal schedule (called by SetIndices)
+    void MakeSchedule();
+    void MakeSchedule(const Link *from);
+
     // returns 0 if not found
     // returns link if found (then found1 and found2 must
     const Link *RecursiveGetLCA(const Link *from, std::string tax1, std::string tax2, bool &found1,
@@ -341,15 +341,12 @@ class CodonM8Model	{
     double GetIntegratedLogLikelihood() {
 
         double total = 0;
-        double logp[ncat+3];
+        vector<double> logp(ncat+3,0);
         const vector<double>& w = componentomegaarray->GetWeights();
         double max = 0;
         for (int i=0; i<GetNsite(); i++) {
-            int bkalloc = sitealloc->GetVal(i);
-
+            phyloprocess->MixtureSiteLogLikelihood(i,*componentcodonmatrixarray,logp);
             for (int k=0; k<ncat+3; k++) {
-                (*sitealloc)[i] = k;
-                logp[k] = phyloprocess->SiteLogLikelihood(i);
                 if ((!k) || (max<logp[k]))  {
                     max = logp[k];
                 }
@@ -361,8 +358,6 @@ class CodonM8Model	{
             }
             double logl = log(p) + max;
             total += logl;
-
-            (*sitealloc)[i] = bkalloc;
         }
         return total;
     }